@@ -11,6 +11,8 @@ std::chrono::time_point<std::chrono::steady_clock> GameStats::m_InterimStart = {
 int GameStats::m_FrameTimingCount = 20; 
 float GameStats::m_InterimDelay = 1.f;
 std::deque<float> GameStats::m_FrameMsTimings = {};
+int GameStats::m_FrameDrawCalls = 0;
+int GameStats::m_FrameCulledDrawCalls = 0;
 PerfStats GameStats::m_Stats = {};
 
 void GameStats::BeginFrame()
@@ -31,6 +33,9 @@ void GameStats::BeginFrame()
 	m_FrameStart = std::chrono::steady_clock::now();
 	m_IsMeasuring = true;
 
+	m_FrameDrawCalls = 0;
+	m_FrameCulledDrawCalls = 0;
+
 	if(m_InterimUpdated)
 	{
 		m_InterimStart = m_FrameStart;
@@ -67,6 +72,9 @@ void GameStats::EndFrame()
 	if (elapsedMs > m_Stats.highMs) m_Stats.highMs = elapsedMs;
 	if (elapsedMs < m_Stats.lowMs) m_Stats.lowMs = elapsedMs;
 
+	m_Stats.nrDrawCalls = m_FrameDrawCalls;
+	m_Stats.nrCulledDrawCalls = m_FrameCulledDrawCalls;
+
 #pragma warning(disable:4189)
 	const auto lastUpdate = std::chrono::duration_cast<std::chrono::seconds>(frameEnd - m_InterimStart).count();
 	if(lastUpdate > m_InterimDelay)
@@ -83,3 +91,9 @@ void GameStats::Reset()
 {
 	m_ResetPending = true;
 }
+
+void GameStats::AddDrawCalls(int nrDrawCalls, int nrCulledDrawCalls)
+{
+	m_FrameDrawCalls += nrDrawCalls;
+	m_FrameCulledDrawCalls += nrCulledDrawCalls;
+}
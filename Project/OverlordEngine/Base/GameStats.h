@@ -8,6 +8,8 @@ public:
 	static void BeginFrame();
 	static void EndFrame();
 	static void Reset();
+	// Renderers report their draw calls here, the stats show the totals of the last frame
+	static void AddDrawCalls(int nrDrawCalls, int nrCulledDrawCalls = 0);
 	static const PerfStats& GetStats() { return m_Stats; }
 
 private:
@@ -19,6 +21,8 @@ private:
 	static int m_FrameTimingCount;
 	static float m_InterimDelay;
 	static std::deque<float> m_FrameMsTimings;
+	static int m_FrameDrawCalls;
+	static int m_FrameCulledDrawCalls;
 
 	static PerfStats m_Stats;
 };
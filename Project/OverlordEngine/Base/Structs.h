@@ -72,6 +72,10 @@ struct PerfStats
 
 	long frameNr;
 
+	// Of the last frame, culled draw calls were skipped because they were outside the view
+	int nrDrawCalls;
+	int nrCulledDrawCalls;
+
 	void Reset()
 	{
 		averageFps = 0;
@@ -83,5 +87,8 @@ struct PerfStats
 		averageMs_interim = 0;
 
 		frameNr = 0;
+
+		nrDrawCalls = 0;
+		nrCulledDrawCalls = 0;
 	}
 };
\ No newline at end of file
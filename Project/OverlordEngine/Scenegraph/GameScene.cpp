@@ -304,6 +304,7 @@ void GameScene::RootOnGUI()
 			const PerfStats gameStats{ GameStats::GetStats() };
 			ImGui::PushFont(nullptr);
 			ImGui::Text("FPS %.1f (%.1f ms)", gameStats.averageFps_interim, gameStats.averageMs_interim);
+			ImGui::Text("Draw calls %d (%d culled)", gameStats.nrDrawCalls, gameStats.nrCulledDrawCalls);
 			ImGui::Dummy(ImVec2{ 0,10.f });
 			ImGui::PopFont();
 #pragma endregion
@@ -17,6 +17,23 @@ BlockInteractionComponent::BlockInteractionComponent(PxScene* pxScene, WorldComp
 	, m_pBreakRenderer{ pBreakRenderer }
 	, m_pBlockBreakParticle{ pBlockBreakParticle }
 {
+	m_pWorld->OnEditApplied.AddListener(this);
+}
+
+BlockInteractionComponent::~BlockInteractionComponent()
+{
+	if (m_pWorld) m_pWorld->OnEditApplied.RemoveListener(this);
+}
+
+void BlockInteractionComponent::Notify(const WorldComponent::WorldEvent& edit)
+{
+	// An earlier edit already filled this position, the block was taken from the inventory when it was placed
+	if (edit.placeBlock && !edit.isApplied) GetGameObject()->GetComponent<Inventory>()->Add(edit.type);
+}
+
+void BlockInteractionComponent::OnSubjectDestroy()
+{
+	m_pWorld = nullptr;
 }
 
 bool BlockInteractionComponent::ShouldPlayAnimation() const
@@ -1,18 +1,19 @@
 #pragma once
 
 #include "Components/BaseComponent.h"
+#include "Components/WorldComponent.h"
+#include "Observer/Observer.h"
 
-class WorldComponent;
 class WireframeRenderer;
 class BlockBreakRenderer;
 class BlockBreakParticle;
 struct Block;
 
-class BlockInteractionComponent : public BaseComponent
+class BlockInteractionComponent : public BaseComponent, public Observer<WorldComponent::WorldEvent>
 {
 public:
 	BlockInteractionComponent(PxScene* pxScene, WorldComponent* pWorld, WireframeRenderer* pSelection, BlockBreakRenderer* pBreakRenderer, BlockBreakParticle* pBlockBreakParticle);
-	virtual ~BlockInteractionComponent() = default;
+	virtual ~BlockInteractionComponent();
 
 	BlockInteractionComponent(const BlockInteractionComponent& other) = delete;
 	BlockInteractionComponent(BlockInteractionComponent&& other) noexcept = delete;
@@ -22,6 +23,10 @@ public:
 	bool ShouldPlayAnimation() const;
 	bool IsBreakingBlock() const { return m_IsBreakingBlock; }
 
+	// Gives the block back when the world thread couldn't place it
+	virtual void Notify(const WorldComponent::WorldEvent& edit) override;
+	virtual void OnSubjectDestroy() override;
+
 protected:
 	virtual void Initialize(const SceneContext& /*sceneContext*/) override {};
 	virtual void Update(const SceneContext& sceneContext) override;
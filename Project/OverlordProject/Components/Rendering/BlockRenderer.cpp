@@ -7,51 +7,52 @@ BlockRenderer::BlockRenderer(BlockType type, const SceneContext& sceneContext)
 {
 	m_enableShadowMapDraw = true;
 
-	TileAtlas tileAltas{};
+	// The texture coordinates of every face come from the tables of the tile atlas
+	const TileAtlas::FaceUVs& faceUVs{ TileAtlas::GetFaceUVs(type) };
 
 	std::vector<VertexPosNormTexTransparency> vertices =
 	{
-		{ { 0.5f, 0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::FORWARD), { 0.0f, 0.0f }) },
-		{ { -0.5f, 0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::FORWARD), { 1.0, 0.0f }) },
-		{ { -0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::FORWARD), { 1.0, 1.0 }) },
-		{ { 0.5f, 0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::FORWARD), { 0.0f, 0.0f }) },
-		{ { -0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::FORWARD), { 1.0, 1.0 }) },
-		{ { 0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::FORWARD), { 0.0f, 1.0 }) },
-
-		{ { -0.5f, 0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BACK), { 0.0f, 0.0f }) },
-		{ { 0.5f, 0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BACK), { 1.0, 0.0f }) },
-		{ { 0.5f, -0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BACK), { 1.0, 1.0 }) },
-		{ { -0.5f, 0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BACK), { 0.0f, 0.0f }) },
-		{ { 0.5f, -0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BACK), { 1.0, 1.0 }) },
-		{ { -0.5f, -0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BACK), { 0.0f, 1.0 }) },
-
-		{ { 0.5f, 0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::RIGHT), { 0.0f, 0.0f }) },
-		{ { 0.5f, 0.5f, 0.5f }, { 1.0f, 0.0f, 0.0f },tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::RIGHT), { 1.0, 0.0f }) },
-		{ { 0.5f, -0.5f, 0.5f }, { 1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::RIGHT), { 1.0, 1.0 }) },
-		{ { 0.5f, 0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::RIGHT), { 0.0f, 0.0f }) },
-		{ { 0.5f, -0.5f, 0.5f }, { 1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::RIGHT), { 1.0, 1.0 }) },
-		{ { 0.5f, -0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::RIGHT), { 0.0f, 1.0 }) },
-
-		{ { -0.5f, 0.5f, 0.5f }, { -1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::LEFT), { 0.0f, 0.0f }) },
-		{ { -0.5f, 0.5f, -0.5f }, { -1.0f, 0.0f, 0.0f },tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::LEFT), { 1.0, 0.0f }) },
-		{ { -0.5f, -0.5f, -0.5f }, { -1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::LEFT), {  1.0, 1.0 }) },
-		{ { -0.5f, 0.5f, 0.5f }, { -1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::LEFT), {  0.0f, 0.0f }) },
-		{ { -0.5f, -0.5f, -0.5f }, { -1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::LEFT), {  1.0, 1.0 }) },
-		{ { -0.5f, -0.5f, 0.5f }, { -1.0f, 0.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::LEFT), {  0.0f, 1.0 }) },
-
-		{ { -0.5f, 0.5f, 0.5f }, { 0.0f, 1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::UP), {  0.0f, 0.0f }) },
-		{ { 0.5f, 0.5f, 0.5f }, { 0.0f, 1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::UP), {  1.0, 0.0f }) },
-		{ { 0.5f, 0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::UP), {  1.0, 1.0 }) },
-		{ { -0.5f, 0.5f, 0.5f }, { 0.0f, 1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::UP), {  0.0f, 0.0f }) },
-		{ { 0.5f, 0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::UP), {  1.0, 1.0 }) },
-		{ { -0.5f, 0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::UP), { 0.0f, 1.0 }) },
-
-		{ { -0.5f, -0.5f, -0.5f }, { 0.0f, -1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BOTTOM), { 0.0f, 0.0f })  },
-		{ { 0.5f, -0.5f, -0.5f }, { 0.0f, -1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BOTTOM), { 1.0, 0.0f }) },
-		{ { 0.5f, -0.5f, 0.5f }, { 0.0f, -1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BOTTOM), { 1.0, 1.0 }) } ,
-		{ { -0.5f, -0.5f, -0.5f }, { 0.0f, -1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BOTTOM), { 0.0f, 0.0f }) },
-		{ { 0.5f, -0.5f, 0.5f }, { 0.0f, -1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BOTTOM), { 1.0, 1.0 }) } ,
-		{ { -0.5f, -0.5f, 0.5f }, { 0.0f, -1.0f, 0.0f }, tileAltas.GetUV(tileAltas.GetFaceType(type, FaceDirection::BOTTOM), { 0.0f, 1.0 }) }
+		{ { 0.5f, 0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, faceUVs[0][0] },
+		{ { -0.5f, 0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, faceUVs[0][1] },
+		{ { -0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, faceUVs[0][2] },
+		{ { 0.5f, 0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, faceUVs[0][0] },
+		{ { -0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, faceUVs[0][2] },
+		{ { 0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f }, faceUVs[0][3] },
+
+		{ { -0.5f, 0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, faceUVs[1][0] },
+		{ { 0.5f, 0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, faceUVs[1][1] },
+		{ { 0.5f, -0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, faceUVs[1][2] },
+		{ { -0.5f, 0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, faceUVs[1][0] },
+		{ { 0.5f, -0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, faceUVs[1][2] },
+		{ { -0.5f, -0.5f, -0.5f }, { 0.0f, 0.0f, -1.0f }, faceUVs[1][3] },
+
+		{ { 0.5f, 0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f }, faceUVs[2][0] },
+		{ { 0.5f, 0.5f, 0.5f }, { 1.0f, 0.0f, 0.0f },faceUVs[2][1] },
+		{ { 0.5f, -0.5f, 0.5f }, { 1.0f, 0.0f, 0.0f }, faceUVs[2][2] },
+		{ { 0.5f, 0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f }, faceUVs[2][0] },
+		{ { 0.5f, -0.5f, 0.5f }, { 1.0f, 0.0f, 0.0f }, faceUVs[2][2] },
+		{ { 0.5f, -0.5f, -0.5f }, { 1.0f, 0.0f, 0.0f }, faceUVs[2][3] },
+
+		{ { -0.5f, 0.5f, 0.5f }, { -1.0f, 0.0f, 0.0f }, faceUVs[3][0] },
+		{ { -0.5f, 0.5f, -0.5f }, { -1.0f, 0.0f, 0.0f },faceUVs[3][1] },
+		{ { -0.5f, -0.5f, -0.5f }, { -1.0f, 0.0f, 0.0f }, faceUVs[3][2] },
+		{ { -0.5f, 0.5f, 0.5f }, { -1.0f, 0.0f, 0.0f }, faceUVs[3][0] },
+		{ { -0.5f, -0.5f, -0.5f }, { -1.0f, 0.0f, 0.0f }, faceUVs[3][2] },
+		{ { -0.5f, -0.5f, 0.5f }, { -1.0f, 0.0f, 0.0f }, faceUVs[3][3] },
+
+		{ { -0.5f, 0.5f, 0.5f }, { 0.0f, 1.0f, 0.0f }, faceUVs[4][0] },
+		{ { 0.5f, 0.5f, 0.5f }, { 0.0f, 1.0f, 0.0f }, faceUVs[4][1] },
+		{ { 0.5f, 0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f }, faceUVs[4][2] },
+		{ { -0.5f, 0.5f, 0.5f }, { 0.0f, 1.0f, 0.0f }, faceUVs[4][0] },
+		{ { 0.5f, 0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f }, faceUVs[4][2] },
+		{ { -0.5f, 0.5f, -0.5f }, { 0.0f, 1.0f, 0.0f }, faceUVs[4][3] },
+
+		{ { -0.5f, -0.5f, -0.5f }, { 0.0f, -1.0f, 0.0f }, faceUVs[5][0]  },
+		{ { 0.5f, -0.5f, -0.5f }, { 0.0f, -1.0f, 0.0f }, faceUVs[5][1] },
+		{ { 0.5f, -0.5f, 0.5f }, { 0.0f, -1.0f, 0.0f }, faceUVs[5][2] } ,
+		{ { -0.5f, -0.5f, -0.5f }, { 0.0f, -1.0f, 0.0f }, faceUVs[5][0] },
+		{ { 0.5f, -0.5f, 0.5f }, { 0.0f, -1.0f, 0.0f }, faceUVs[5][2] } ,
+		{ { -0.5f, -0.5f, 0.5f }, { 0.0f, -1.0f, 0.0f }, faceUVs[5][3] }
 	};
 
 	if (vertices.size() == 0) return;
@@ -8,13 +8,18 @@
 #include "Prefabs/SheepPrefab.h"
 
 #include "Managers/BlockManager.h"
+#include "Misc/World/QuadMesh.h"
 
 #include <chrono>
 
-WorldComponent::WorldComponent(const SceneContext& sceneContext)
+WorldComponent::WorldComponent(const SceneContext& sceneContext, const std::filesystem::path& saveDirectory)
+    : m_Generator{ saveDirectory }
 {
 	m_Renderer.LoadEffect(sceneContext);
 
+    // Recycle the chunks that get unloaded
+    m_Chunks.SetPool(&m_ChunkPool);
+
     m_enablePostDraw = true;
 
     // Create the cooking interface
@@ -32,9 +37,6 @@ WorldComponent::~WorldComponent()
 
     // Release the collider cooking
     m_pColliderCooking->release();
-
-    for (Chunk& chunk : m_Chunks) chunk.DeleteChunk();
-    for (Chunk& chunk : m_WaterChunks) chunk.DeleteChunk();
 }
 
 void WorldComponent::StartWorldThread(const SceneContext& sceneContext)
@@ -53,27 +55,25 @@ void WorldComponent::StartWorldThread(const SceneContext& sceneContext)
 
         if (!m_NeedsWorldReload) // don't change the world while the main thread is updating
         {
-            if (m_DestroyBlock)
-            {
-                // Remove the block from the right chunk
-                m_Generator.RemoveBlock(m_EditBlock, sceneContext, &m_Renderer);
+            // Apply every edit that the main thread made since the last reload, in order
+            //  all edits are applied as one batch, so every changed chunk is only remeshed once
+            m_Generator.BeginEdit();
 
-                // Let the main thread now to get the latest worlddata
-                m_NeedsWorldReload = true;
+            WorldEvent edit{};
+            while (m_Edits.Pop(edit))
+            {
+                if (edit.placeBlock) edit.isApplied = m_Generator.PlaceBlock(edit.position, edit.type, sceneContext, &m_Renderer);
+                else edit.isApplied = m_Generator.RemoveBlock(edit.position, sceneContext, &m_Renderer);
 
-                // Disable destroy block flag
-                m_DestroyBlock = false;
+                m_AppliedEdits.emplace_back(edit);
             }
-            else if (m_PlaceBlock)
-            {
-                // Place the block in the right chunk
-                m_Generator.PlaceBlock(m_EditBlock, m_EditBlockType, sceneContext, &m_Renderer);
 
+            m_Generator.Commit(sceneContext, &m_Renderer);
+
+            if (!m_AppliedEdits.empty())
+            {
                 // Let the main thread now to get the latest worlddata
                 m_NeedsWorldReload = true;
-
-                // Disable place block flag
-                m_PlaceBlock = false;
             }
             else
             {
@@ -107,15 +107,12 @@ void WorldComponent::StartWorldThread(const SceneContext& sceneContext)
 
 bool WorldComponent::PlaceBlock(const XMFLOAT3& hitNormal, XMFLOAT3 hitBlockPosition, BlockType block)
 {
-    if (m_NeedsWorldReload || m_PlaceBlock) return false;
-
     hitBlockPosition.x += hitNormal.x;
     hitBlockPosition.y += hitNormal.y;
     hitBlockPosition.z += hitNormal.z;
 
-    m_EditBlock = hitBlockPosition;
-    m_EditBlockType = block;
-    m_PlaceBlock = true;
+    // Every edit is queued, if an earlier edit already filled this position the world thread skips this one
+    QueueEdit(WorldEvent{ true, hitBlockPosition, block });
 
     PlayBlockSound(BlockManager::Get()->GetBlock(block)->pEventSound);
 
@@ -124,13 +121,14 @@ bool WorldComponent::PlaceBlock(const XMFLOAT3& hitNormal, XMFLOAT3 hitBlockPosi
 
 bool WorldComponent::DestroyBlock(const XMFLOAT3& position)
 {
-    // If the world is already update, cancel the destroy block event
-    if (m_NeedsWorldReload || m_DestroyBlock) return false;
+    // The collider of the block stays until the edit is loaded, so the player can hit a block that is already being destroyed
+    //  the edit is still queued, the world thread skips it when the block is already gone
+    const XMINT3 blockPos{ static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z) };
 
     // Drop an item, particle and play a sound on the position of the destroyed block
-    const XMINT3 blockPos{ static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z) };
-    Block* pBlockToDestroy{ GetBlockAt(blockPos.x,blockPos.y,blockPos.z) };
-    Block* pDropBlock{ pBlockToDestroy->dropBlock };
+    //  the block is looked up after the edits that are still pending, so a block doesn't drop twice
+    Block* pBlockToDestroy{ GetLatestBlockAt(blockPos) };
+    Block* pDropBlock{ pBlockToDestroy ? pBlockToDestroy->dropBlock : nullptr };
     if (pDropBlock)
     {
         GetScene()->AddChild(new ItemEntity{ pDropBlock->type, position });
@@ -139,16 +137,15 @@ bool WorldComponent::DestroyBlock(const XMFLOAT3& position)
     }
 
     // If the block above the to-be-destroyed-block is a cross block, play a particle and sound for this block as well
-    Block* pBlockUp{ GetBlockAt(blockPos.x,blockPos.y+1,blockPos.z) };
-    if (pBlockUp && pBlockUp->mesh == BlockMesh::CROSS)
+    Block* pBlockUp{ GetLatestBlockAt(XMINT3{ blockPos.x, blockPos.y + 1, blockPos.z }) };
+    if (pBlockToDestroy && pBlockUp && pBlockUp->mesh == BlockMesh::CROSS)
     {
         GetScene()->AddChild(new BlockDestroyParticle{ pBlockUp->type })->GetTransform()->Translate(position.x, position.y + 1.0f, position.z);
         PlayBlockSound(pBlockUp->pEventSound);
     }
 
-    // Set the event data
-    m_EditBlock = position;
-    m_DestroyBlock = true;
+    // Send the edit to the world thread
+    QueueEdit(WorldEvent{ false, position, BlockType::AIR });
 
     // Return success
     return true;
@@ -156,7 +153,12 @@ bool WorldComponent::DestroyBlock(const XMFLOAT3& position)
 
 Block* WorldComponent::GetBlockAt(int x, int y, int z) const
 {
-    return m_Generator.GetBlockAt(x, y, z);
+    // The chunks of the generator are changed by the world thread, the main thread reads its own copy of the blocks
+    XMINT3 lookUpPos{};
+    const Chunk* pChunk{ FindChunk(x, y, z, lookUpPos) };
+    if (!pChunk || pChunk->sections.empty()) return BlockManager::Get()->GetBlock(BlockType::AIR);
+
+    return BlockManager::Get()->GetBlock(pChunk->GetBlock(lookUpPos.x, lookUpPos.y, lookUpPos.z));
 }
 
 bool WorldComponent::IsPositionWater(float worldX, float worldY, float worldZ) const
@@ -166,13 +168,13 @@ bool WorldComponent::IsPositionWater(float worldX, float worldY, float worldZ) c
     const int y{ static_cast<int>(worldY + 0.5f) };
     const int z{ worldZ > 0.0f ? static_cast<int>(worldZ + 0.5f) : static_cast<int>(worldZ + 0.5f) - 1 };
 
-    // If there is a water block in the water chunks at this position, the position is in water
-    const bool isInWaterBlock{ GetBlockAt(x, y, z, m_WaterChunks) == BlockType::WATER };
+    // If there is water in the fluid layer at this position, the position is in water
+    const bool isInWaterBlock{ GetFluidAt(x, y, z) == BlockType::WATER };
 
     // The top water block has a small offset downwards so we also need to check that
     
     // If there is a block on top of the current block, there is no need to check this offset
-    const BlockType blockAbove{ GetBlockAt(x,y+1,z, m_WaterChunks) };
+    const BlockType blockAbove{ GetFluidAt(x, y + 1, z) };
     if(blockAbove == BlockType::WATER) return isInWaterBlock;
 
     // Also check if the position is under the small offset
@@ -204,6 +206,83 @@ void WorldComponent::UpdateColliders(const XMFLOAT3& playerPosition)
 void WorldComponent::SetRenderDistance(int renderDistance)
 {
     m_Generator.SetRenderDistance(renderDistance);
+
+    // Size the main thread chunk tables for the new render distance
+    const int renderWidth{ renderDistance * 2 + 1 };
+    m_Chunks.Reserve(renderWidth * renderWidth);
+    m_ChunkPool.Reserve(renderWidth * renderWidth);
+}
+
+void WorldComponent::OnGUI()
+{
+    const auto drawPoolStats{ [](const char* name, const ChunkPool::Stats& stats)
+        {
+            ImGui::Text("%s: %d in use, %d free (peak %d)", name, stats.nrInUse, stats.nrFree, stats.highWaterMark);
+            ImGui::Text("    %d allocated, %d recycled", stats.nrAllocated, stats.nrRecycled);
+        } };
+
+    // The generator stats are written by the world thread, they are only read here for display
+    ImGui::Text("Chunk pools");
+    drawPoolStats("Generator", m_Generator.GetChunkPoolStats());
+    drawPoolStats("World", m_ChunkPool.GetStats());
+
+    const RegionStorage& regionStorage{ m_Generator.GetRegionStorage() };
+    ImGui::Text("Region files (seed %u): %d chunks loaded, %d saved", m_Generator.GetSeed(), regionStorage.GetNrLoadedChunks(), regionStorage.GetNrSavedChunks());
+
+    const ChunkCache::Stats& cacheStats{ m_Generator.GetChunkCacheStats() };
+    const int nrLookups{ cacheStats.nrHits + cacheStats.nrMisses };
+    const float hitRate{ nrLookups > 0 ? 100.0f * cacheStats.nrHits / nrLookups : 0.0f };
+    ImGui::Text("Chunk cache: %d chunks, %.1f / %.1f KB", cacheStats.nrChunks, cacheStats.nrBytes / 1024.0f, m_Generator.GetChunkCacheBudget() / 1024.0f);
+    ImGui::Text("    %.1f%% hits (%d hits, %d misses), %d evicted", hitRate, cacheStats.nrHits, cacheStats.nrMisses, cacheStats.nrEvictions);
+
+    ImGui::Text("Block edits: %d pending, %d waiting for the queue", static_cast<int>(m_PendingEdits.size()), static_cast<int>(m_OverflowEdits.size()));
+
+    // Compare the meshers on the chunks that used them
+    bool useGreedyMeshing{ m_Generator.IsGreedyMeshing() };
+    if (ImGui::Checkbox("Greedy meshing for new chunks", &useGreedyMeshing)) m_Generator.SetGreedyMeshing(useGreedyMeshing);
+
+    // Chunks switch their level of detail the next time the world thread loads chunks
+    int lodDistance{ m_Generator.GetLodDistance() };
+    if (ImGui::SliderInt("LOD distance (0 is off)", &lodDistance, 0, 16)) m_Generator.SetLodDistance(lodDistance);
+
+    // The far terrain covers the terrain past the render distance with a surface that is built from the height noise
+    int farDistance{ m_FarTerrain.GetDistance() };
+    if (ImGui::SliderInt("Far terrain distance (0 is off)", &farDistance, 0, 64)) m_FarTerrain.SetDistance(farDistance);
+    ImGui::Text("Far terrain: %d tiles, %d building", static_cast<int>(m_FarTerrain.GetTiles().size()), m_FarTerrain.GetNrBuildingTiles());
+
+    // The shadow pass only draws the chunks that can cast a shadow into the view, its draw calls aren't part of the frame's draw calls
+    const WorldRenderer::DrawStats& shadowStats{ m_Renderer.GetShadowStats() };
+    ImGui::Text("Shadow draw calls: %d drawn, %d culled", shadowStats.nrDrawCalls, shadowStats.nrCulledDrawCalls);
+
+    // Sections that the camera can't reach through air are hidden behind stone
+    bool isCaveCulling{ m_Renderer.IsCaveCulling() };
+    if (ImGui::Checkbox("Cave culling", &isCaveCulling)) m_Renderer.SetCaveCulling(isCaveCulling);
+    const WorldRenderer::CaveStats& caveStats{ m_Renderer.GetCaveStats() };
+    ImGui::Text("Sections: %d visible, %d hidden", caveStats.nrVisibleSections, caveStats.nrHiddenSections);
+
+    // The chunks are only sorted again when the camera enters another chunk or the loaded chunks change
+    ImGui::Text("Draw order: %d chunks, sorted %d times", static_cast<int>(m_Renderer.GetDrawList().GetEntries().size()), m_Renderer.GetDrawList().GetNrSorts());
+
+    // Every chunk mesh is a range of one of a few big vertex buffers
+    const ChunkBufferPool::Stats bufferStats{ m_Renderer.GetBufferStats() };
+    ImGui::Text("Vertex buffers: %d pages, %d meshes, %.1f / %.1f MB", bufferStats.nrPages, bufferStats.nrMeshes,
+        bufferStats.nrUsed * sizeof(ChunkVertex) / (1024.0f * 1024.0f), bufferStats.capacity * sizeof(ChunkVertex) / (1024.0f * 1024.0f));
+    ImGui::Text("    %.1f%% fragmented, %d written in place, %d reallocated, %d moved", bufferStats.fragmentation * 100.0f,
+        bufferStats.nrInPlaceUploads, bufferStats.nrReallocations, bufferStats.nrMovedMeshes);
+
+    for (int isGreedy{}; isGreedy <= 1; ++isGreedy)
+    {
+        const WorldGenerator::MeshStats& meshStats{ m_Generator.GetMeshStats(isGreedy) };
+        const WorldGenerator::MeshStats& cookStats{ m_CookStats[isGreedy] };
+        const int nrMeshes{ std::max(meshStats.nrChunks, 1) };
+        const int nrCooks{ std::max(cookStats.nrChunks, 1) };
+
+        const int64_t nrVerticesPerMesh{ meshStats.nrVertices / nrMeshes };
+        ImGui::Text("%s mesher: %d meshes, %lld vertices (%.1f KB), %.3f ms per mesh", isGreedy ? "Greedy" : "Naive",
+            meshStats.nrChunks, nrVerticesPerMesh, nrVerticesPerMesh * sizeof(ChunkVertex) / 1024.0f, meshStats.totalTime / nrMeshes);
+        ImGui::Text("    %d colliders, %lld vertices, %.3f ms cooking per collider",
+            cookStats.nrChunks, cookStats.nrVertices / nrCooks, cookStats.totalTime / nrCooks);
+    }
 }
 
 void WorldComponent::LoadStartChunk(const SceneContext& sceneContext)
@@ -241,106 +320,72 @@ void WorldComponent::Initialize(const SceneContext& sceneContext)
     m_WorldThread = std::thread{ [this,sceneContext]() { StartWorldThread(sceneContext); } };
 }
 
-void WorldComponent::Update(const SceneContext&)
+void WorldComponent::Update(const SceneContext& sceneContext)
 {
+    // Send the edits that didn't fit in the queue before
+    FlushOverflowEdits();
+
+    // Stream the far terrain around the player, it doesn't wait for the world thread
+    m_FarTerrain.Update(m_ChunkCenter, sceneContext);
+
+    // Move a few chunk meshes out of the emptiest vertex buffer, so it can be released once it is empty
+    m_Renderer.DefragmentBuffers(sceneContext);
+
     // If the world doesn't need a reload, stop here
     if (!m_NeedsWorldReload) return;
 
     // Get the current chunks in the generator
     auto& genChunks{ m_Generator.GetChunks() };
-    auto& genWaterChunks{ m_Generator.GetWater() };
 
     // Delete any chunks that are not in the generator anymore
-    for (int i{ static_cast<int>(m_Chunks.size() - 1) }; i >= 0; --i)
-    {
-        auto& curChunk{ m_Chunks[i] };
-        auto chunkIt{ std::find_if(begin(genChunks), end(genChunks), [&](const Chunk& chunk) { return chunk.position.x == curChunk.position.x && chunk.position.y == curChunk.position.y; }) };
-        if (chunkIt != genChunks.end()) continue;
-
-        curChunk.DeleteChunk();
-        m_Chunks[i] = m_Chunks[m_Chunks.size() - 1];
-        m_Chunks.pop_back();
-    }
-    for (int i{ static_cast<int>(m_WaterChunks.size() - 1) }; i >= 0; --i)
-    {
-        auto& curChunk{ m_WaterChunks[i] };
-        auto chunkIt{ std::find_if(begin(genWaterChunks), end(genWaterChunks), [&](const Chunk& chunk) { return chunk.position.x == curChunk.position.x && chunk.position.y == curChunk.position.y; }) };
-        if (chunkIt != genWaterChunks.end()) continue;
+    m_Chunks.EraseIf([&](Chunk& curChunk)
+        {
+            if (genChunks.Find(curChunk.position)) return false;
 
-        curChunk.DeleteChunk();
-        m_WaterChunks[i] = m_WaterChunks[m_WaterChunks.size() - 1];
-        m_WaterChunks.pop_back();
-    }
+            m_Renderer.FreeMeshes(curChunk);
+            return true;
+        });
 
     // For each chunk in the generator
     for (auto& genChunk : genChunks)
     {
         // Try finding the chunk in the current world
-        const auto chunkIt{ std::find_if(begin(m_Chunks), end(m_Chunks),
-            [&](const Chunk& chunk) { return chunk.position.x == genChunk.position.x && chunk.position.y == genChunk.position.y; }) };
+        Chunk* pChunk{ m_Chunks.Find(genChunk.position) };
 
         // If the chunk already exists in the world
-        if (chunkIt != end(m_Chunks))
+        if (pChunk)
         {
-            auto& chunk{ *chunkIt };
+            auto& chunk{ *pChunk };
 
-            // If there is a new vertex buffer
-            if (genChunk.pVertexBuffer)
+            // Upload the new meshes, the collider only changes with the blocks
+            if (UploadMeshes(genChunk, chunk, sceneContext))
             {
-                // Release the previous vertex buffer
-                SafeRelease(chunk.pVertexBuffer);
-
-                // Copy the vertices and buffer
-                chunk.vertices = genChunk.vertices;
-                chunk.pVertexBuffer = genChunk.pVertexBuffer;
-                chunk.vertexBufferSize = genChunk.vertexBufferSize;
-
-                // Reset the generator vertex buffer
-                genChunk.pVertexBuffer = nullptr;
-
-                // Notify collider update
+                CopyBlocks(genChunk, chunk);
+                CopyColliderVertices(genChunk, chunk);
                 chunk.needColliderChange = true;
             }
-            // If there is a new transparent vertex buffer
-            if (genChunk.pVertexTransparentBuffer)
-            {
-                // Release the previous vertex buffer
-                SafeRelease(chunk.pVertexTransparentBuffer);
-
-                // Copy the buffer
-                chunk.pVertexTransparentBuffer = genChunk.pVertexTransparentBuffer;
-                chunk.vertexTransparentBufferSize = genChunk.vertexTransparentBufferSize;
-
-                // Reset the generator buffer
-                genChunk.pVertexTransparentBuffer = nullptr;
-            }
         }
         else
         {
-            // Create a new chunk
-            Chunk chunk{};
+            // Get a new chunk from the pool
+            std::unique_ptr<Chunk> pNewChunk{ m_ChunkPool.Acquire() };
+            Chunk& chunk{ *pNewChunk };
 
             // Copy the chunk position
             chunk.position = genChunk.position;
+            chunk.useGreedyMesh = genChunk.useGreedyMesh;
+            chunk.fluidSections = genChunk.fluidSections;
 
-            // Copy the vertices and buffer
-            chunk.vertices = genChunk.vertices;
-            chunk.pVertexBuffer = genChunk.pVertexBuffer;
-            chunk.vertexBufferSize = genChunk.vertexBufferSize;
+            // Upload the meshes, a chunk that still waits for its neighbours gets its meshes once it is meshed
+            UploadMeshes(genChunk, chunk, sceneContext);
 
-            // Notify a collider change
+            // Copy the blocks and vertices and notify a collider change
+            CopyBlocks(genChunk, chunk);
+            CopyColliderVertices(genChunk, chunk);
             chunk.needColliderChange = true;
 
-            // Copy the transparent vertex buffer
-            chunk.pVertexTransparentBuffer = genChunk.pVertexTransparentBuffer;
-            chunk.vertexTransparentBufferSize = genChunk.vertexTransparentBufferSize;
-
-            // Reset all the generator buffers
-            genChunk.pVertexBuffer = nullptr;
-            genChunk.pVertexTransparentBuffer = nullptr;
-
             // Add the chunk to the world
-            m_Chunks.push_back(chunk);
+            m_Chunks.Insert(std::move(pNewChunk));
 
             // If this chunk is a sheep chunk, spawn sheep
             if (m_Generator.IsSheepChunk(genChunk.position))
@@ -350,85 +395,28 @@ void WorldComponent::Update(const SceneContext&)
                 {
                     constexpr float distanceBetweenSheep{ 2.0f };
 
-                    // Sheep have to spawn in the air because this chunk isn't in the collider radius yet,
-                    // The moment a chunk gets a collider under the sheep, it will teleport to the right location
+                    // Spawn the sheep just above the highest block of its column
+                    // This chunk isn't in the collider radius yet, the sheep stays in place until a collider is created under it
                     const int chunkSize{ m_Generator.GetChunkSize() };
-                    GetScene()->AddChild(new SheepPrefab{})->GetTransform()->Translate((genChunk.position.x + 0.5f) * chunkSize + distanceBetweenSheep * i,
-                        1000.0f,
-                        (genChunk.position.y + 0.5f) * chunkSize + distanceBetweenSheep * i);
+                    const float posInChunk{ 0.5f * chunkSize + distanceBetweenSheep * i };
+                    const int groundHeight{ genChunk.GetHeight(static_cast<int>(posInChunk), static_cast<int>(posInChunk)) };
+                    GetScene()->AddChild(new SheepPrefab{})->GetTransform()->Translate(genChunk.position.x * chunkSize + posInChunk,
+                        groundHeight + 2.0f,
+                        genChunk.position.y * chunkSize + posInChunk);
                 }
             }
         }
     }
 
-    // For each water chunk in the generator
-    for (auto& genChunk : genWaterChunks)
-    {
-        // Try finding the chunk in the current world
-        const auto chunkIt{ std::find_if(begin(m_WaterChunks), end(m_WaterChunks),
-            [&](const Chunk& chunk) { return chunk.position.x == genChunk.position.x && chunk.position.y == genChunk.position.y; }) };
-
-        // If the chunk already exists in the world
-        if (chunkIt != end(m_WaterChunks))
-        {
-            auto& chunk{ *chunkIt };
-
-            // If there is a new vertex buffer
-            if (genChunk.pVertexBuffer)
-            {
-                // Release the previous buffer
-                SafeRelease(chunk.pVertexBuffer);
-
-                // Copy the vertex buffer
-                chunk.pVertexBuffer = genChunk.pVertexBuffer;
-                chunk.vertexBufferSize = genChunk.vertexBufferSize;
-
-                // Reset the buffer in the generator
-                genChunk.pVertexBuffer = nullptr;
-            }
-
-            // If there is a new transparent vertex buffer
-            if (genChunk.pVertexTransparentBuffer)
-            {
-                // Release the previous buffer
-                SafeRelease(chunk.pVertexTransparentBuffer);
-
-                // Copy the blocks and the buffer
-                chunk.blocks = genChunk.blocks;
-                chunk.pVertexTransparentBuffer = genChunk.pVertexTransparentBuffer;
-                chunk.vertexTransparentBufferSize = genChunk.vertexTransparentBufferSize;
-
-                // Reset the buffer in the generator
-                genChunk.pVertexTransparentBuffer = nullptr;
-            }
-        }
-        else
-        {
-            // Create a new chunk
-            Chunk chunk{};
-
-            // Copy the position
-            chunk.position = genChunk.position;
-
-            // Copy the blocks and the buffers
-            chunk.blocks = genChunk.blocks;
-
-            chunk.pVertexBuffer = genChunk.pVertexBuffer;
-            chunk.vertexBufferSize = genChunk.vertexBufferSize;
-
-            chunk.pVertexTransparentBuffer = genChunk.pVertexTransparentBuffer;
-            chunk.vertexTransparentBufferSize = genChunk.vertexTransparentBufferSize;
-
-            // Reset the buffers in the generator
-            genChunk.pVertexBuffer = nullptr;
-            genChunk.pVertexTransparentBuffer = nullptr;
+    LoadColliders();
 
-            // Add the chunk to the world
-            m_WaterChunks.push_back(chunk);
-        }
+    // The applied edits are part of the loaded world now
+    for (const WorldEvent& edit : m_AppliedEdits)
+    {
+        m_PendingEdits.pop_front();
+        OnEditApplied.Notify(edit);
     }
-
-    LoadColliders();
+    m_AppliedEdits.clear();
 
     m_NeedsWorldReload = false;
 }
@@ -475,32 +463,85 @@ void WorldComponent::LoadColliders(bool reloadAll)
     }
 }
 
+bool WorldComponent::UploadMeshes(Chunk& genChunk, Chunk& chunk, const SceneContext& sceneContext)
+{
+    // The world thread doesn't touch its chunks while the main thread takes them over, so their vertices can be read here
+    if (genChunk.hasNewWaterVertices)
+    {
+        // Copy the fluid layer and upload the water
+        chunk.fluidSections = genChunk.fluidSections;
+        m_Renderer.UploadVertices(genChunk.waterVertices, chunk.waterMeshHandle, sceneContext);
+        chunk.waterVertexBufferSize = static_cast<int>(genChunk.waterVertices.size());
+        chunk.waterBounds = genChunk.waterBounds;
+
+        genChunk.hasNewWaterVertices = false;
+    }
+
+    if (!genChunk.hasNewVertices) return false;
+
+    // Every mesh layer is written in place when it still fits in its range of the buffer pool
+    for (int layerIdx{}; layerIdx < Chunk::NrMeshLayers; ++layerIdx)
+    {
+        m_Renderer.UploadVertices(genChunk.vertices[layerIdx], chunk.meshHandles[layerIdx], sceneContext);
+        chunk.vertexBufferSizes[layerIdx] = static_cast<int>(genChunk.vertices[layerIdx].size());
+    }
+
+    // Copy where the sections start in the meshes and which of their faces see each other
+    chunk.sectionVertexStarts = genChunk.sectionVertexStarts;
+    chunk.sectionVisibility = genChunk.sectionVisibility;
+    chunk.bounds = genChunk.bounds;
+    chunk.useGreedyMesh = genChunk.useGreedyMesh;
+
+    genChunk.hasNewVertices = false;
+    return true;
+}
+
+void WorldComponent::CopyBlocks(const Chunk& genChunk, Chunk& chunk) const
+{
+    // The sections keep their memory, so a copy into a recycled chunk doesn't allocate again
+    chunk.sections = genChunk.sections;
+    chunk.sectionBits = genChunk.sectionBits;
+}
+
+void WorldComponent::CopyColliderVertices(const Chunk& genChunk, Chunk& chunk) const
+{
+    // Only the solid and cutout vertices are read by the collider
+    for (MeshLayer layer : { MeshLayer::SOLID, MeshLayer::CUTOUT })
+    {
+        chunk.vertices[static_cast<int>(layer)] = genChunk.vertices[static_cast<int>(layer)];
+    }
+}
+
 void WorldComponent::LoadChunkCollider(Chunk& chunk, physx::PxCooking* cooking, physx::PxPhysics& physX, physx::PxMaterial* pPhysMat)
 {
     // Get all the vertices of the world
     std::vector<XMFLOAT3> vertices{ m_Generator.GetPositions(chunk) };
 
-    // Create a list of indices (starts at 0 and ends at nrVertices)
+    // Create the indices of the 2 triangles of every quad
     std::vector<PxU32> indices{};
-    indices.reserve(vertices.size());
-    for (PxU32 i{}; i < static_cast<PxU32>(vertices.size()); ++i)
-    {
-        indices.emplace_back(i);
-    }
+    QuadMesh::CreateIndices(QuadMesh::GetNrQuads(vertices.size()), indices);
 
     // Create the triangle mesh desc
     PxTriangleMeshDesc meshDesc;
     meshDesc.points.count = static_cast<PxU32>(vertices.size());
     meshDesc.points.stride = sizeof(PxVec3);
     meshDesc.points.data = vertices.data();
-    meshDesc.triangles.count = static_cast<PxU32>(vertices.size()) / 3;
+    meshDesc.triangles.count = static_cast<PxU32>(indices.size()) / 3;
     meshDesc.triangles.stride = 3 * sizeof(PxU32);
     meshDesc.triangles.data = indices.data();
 
     // Cook the mesh
+    const auto cookStart{ std::chrono::high_resolution_clock::now() };
     PxDefaultMemoryOutputStream writeBuffer;
     cooking->cookTriangleMesh(meshDesc, writeBuffer);
 
+    // Keep track of the cooking cost of the mesher of this chunk
+    const std::chrono::duration<double, std::milli> cookTime{ std::chrono::high_resolution_clock::now() - cookStart };
+    WorldGenerator::MeshStats& cookStats{ m_CookStats[chunk.useGreedyMesh] };
+    ++cookStats.nrChunks;
+    cookStats.nrVertices += static_cast<int64_t>(vertices.size());
+    cookStats.totalTime += cookTime.count();
+
     // Create the triangle mesh
     PxDefaultMemoryInputData readBuffer(writeBuffer.getData(), writeBuffer.getSize());
     PxTriangleMesh* triangleMesh = physX.createTriangleMesh(readBuffer);
@@ -527,7 +568,20 @@ void WorldComponent::LoadChunkCollider(Chunk& chunk, physx::PxCooking* cooking,
     chunk.verticesChanged = false;
 }
 
-BlockType WorldComponent::GetBlockAt(int x, int y, int z, const std::vector<Chunk>& chunks) const
+BlockType WorldComponent::GetFluidAt(int x, int y, int z) const
+{
+    // Find the chunk that the player is in
+    XMINT3 lookUpPos{};
+    const Chunk* pChunk{ FindChunk(x, y, z, lookUpPos) };
+    if (!pChunk) return BlockType::AIR; // If this chunk does not exist, return air
+
+    if (!pChunk->HasFluid()) return BlockType::AIR; // If this chunk does not have any fluids, return air
+
+    // Return the fluid
+    return pChunk->GetFluid(lookUpPos.x, lookUpPos.y, lookUpPos.z);
+}
+
+const Chunk* WorldComponent::FindChunk(int x, int y, int z, XMINT3& lookUpPos) const
 {
     const int chunkSize{ m_Generator.GetChunkSize() };
 
@@ -538,28 +592,46 @@ BlockType WorldComponent::GetBlockAt(int x, int y, int z, const std::vector<Chun
         z < 0 ? (static_cast<int>(z) + 1) / chunkSize - 1 : static_cast<int>(z) / chunkSize
     };
 
-    // Find the chunk that the player is in
-    auto it{ std::find_if(begin(chunks), end(chunks), [&](const Chunk& chunk)
-        {
-            return chunk.position.x == chunkPos.x && chunk.position.y == chunkPos.y;
-        }) };
-    if (it == chunks.end()) return BlockType::AIR; // If this chunk does not exist, return air
-
-    if (it->blocks.empty()) return BlockType::AIR; // If this chunk does not have any blocks, return air
-
     // Find the relative position of this block inside this chunk
-    const XMINT3 lookUpPos{ static_cast<int>(x) - chunkPos.x * chunkSize, static_cast<int>(y), static_cast<int>(z) - chunkPos.y * chunkSize };
+    lookUpPos = XMINT3{ static_cast<int>(x) - chunkPos.x * chunkSize, static_cast<int>(y), static_cast<int>(z) - chunkPos.y * chunkSize };
 
-    // If the look up position is outside the chunk, return air
+    // If the look up position is outside the chunk, there is no chunk
     if (lookUpPos.x < 0 || lookUpPos.x >= chunkSize
         || lookUpPos.z < 0 || lookUpPos.z >= chunkSize
-        || lookUpPos.y < 0 || lookUpPos.y >= m_Generator.GetWorldHeight()) return BlockType::AIR;
+        || lookUpPos.y < 0 || lookUpPos.y >= m_Generator.GetWorldHeight()) return nullptr;
+
+    return m_Chunks.Find(chunkPos);
+}
+
+void WorldComponent::QueueEdit(const WorldEvent& edit)
+{
+    m_PendingEdits.emplace_back(edit);
 
-    // Calculate the block id
-    const int blockIdx{ lookUpPos.x + lookUpPos.z * chunkSize + lookUpPos.y * chunkSize * chunkSize };
+    // If the queue is full, keep the edit until there is room instead of dropping it
+    // Once an edit waits, every next edit waits behind it so the edits stay in order
+    if (!m_OverflowEdits.empty() || !m_Edits.Push(edit)) m_OverflowEdits.push(edit);
+}
 
-    // Return the block
-    return *(it->blocks.data() + blockIdx);
+void WorldComponent::FlushOverflowEdits()
+{
+    while (!m_OverflowEdits.empty() && m_Edits.Push(m_OverflowEdits.front()))
+    {
+        m_OverflowEdits.pop();
+    }
+}
+
+Block* WorldComponent::GetLatestBlockAt(const XMINT3& position) const
+{
+    // The last pending edit of this block decides what the world thread ends up with
+    const auto lastEditIt{ std::find_if(m_PendingEdits.rbegin(), m_PendingEdits.rend(), [&](const WorldEvent& edit)
+        {
+            return static_cast<int>(edit.position.x) == position.x
+                && static_cast<int>(edit.position.y) == position.y
+                && static_cast<int>(edit.position.z) == position.z;
+        }) };
+
+    if (lastEditIt == m_PendingEdits.rend()) return GetBlockAt(position.x, position.y, position.z);
+    return BlockManager::Get()->GetBlock(lastEditIt->type);
 }
 
 void WorldComponent::PlayBlockSound(FMOD::Sound* pSound)
@@ -572,17 +644,15 @@ void WorldComponent::PlayBlockSound(FMOD::Sound* pSound)
 void WorldComponent::Draw(const SceneContext& sceneContext)
 {
     m_Renderer.Draw(m_Chunks, sceneContext);
+    m_Renderer.DrawFarTerrain(m_FarTerrain, m_ChunkCenter, m_Generator.GetRenderDistance(), m_Generator.GetChunkSize(), sceneContext);
 }
 
 void WorldComponent::PostDraw(const SceneContext& sceneContext)
 {
-    m_Renderer.Draw(m_WaterChunks, sceneContext);
+    m_Renderer.DrawWater(m_Chunks, sceneContext);
 }
 
 void WorldComponent::ShadowMapDraw(const SceneContext& sceneContext)
 {
-    for (const Chunk& chunk : m_Chunks)
-    {
-        m_Renderer.DrawShadowMap(chunk, sceneContext);
-    }
+    m_Renderer.DrawShadowMap(m_Chunks, sceneContext);
 }
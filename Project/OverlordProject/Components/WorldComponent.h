@@ -3,7 +3,12 @@
 #include <Misc/World/WorldGenerator.h>
 #include <Misc/World/WorldRenderer.h>
 
-#include "Misc/World/Chunk.h"
+#include "Misc/World/ChunkMap.h"
+#include "Utils/SpscQueue.h"
+#include "Observer/Subject.h"
+
+#include <atomic>
+#include <deque>
 #include <queue>
 
 class RigidBodyComponent;
@@ -11,7 +16,18 @@ class RigidBodyComponent;
 class WorldComponent final : public BaseComponent
 {
 public:
-	WorldComponent(const SceneContext& sceneContext);
+	// A block edit, edits are applied on the world thread in the order they are made
+	struct WorldEvent
+	{
+		bool placeBlock{};
+		XMFLOAT3 position{};
+		BlockType type{};
+		// False if the edit couldn't change the world, because its chunk isn't loaded or an earlier edit already changed the block
+		bool isApplied{};
+	};
+
+	// The world is saved in the save directory and loaded from it again the next time the directory is used
+	WorldComponent(const SceneContext& sceneContext, const std::filesystem::path& saveDirectory);
 	virtual ~WorldComponent();
 
 	WorldComponent(const WorldComponent& other) = delete;
@@ -29,7 +45,12 @@ public:
 	Block* GetBlockAt(int x, int y, int z) const;
 	bool IsPositionWater(float worldX, float worldY, float worldZ) const;
 
-	bool IsLoaded() { return !m_Chunks.empty(); }
+	bool IsLoaded() { return !m_Chunks.Empty(); }
+
+	void OnGUI();
+
+	// Notified on the main thread once an edit is applied and the changed world is loaded
+	Subject<WorldEvent> OnEditApplied{};
 
 protected:
 	virtual void Initialize(const SceneContext& sceneContext) override;
@@ -39,42 +60,57 @@ protected:
 	virtual void ShadowMapDraw(const SceneContext& sceneContext) override;
 
 private:
-	struct WorldEvent
-	{
-		bool placeBlock{};
-		XMFLOAT3 position{};
-		BlockType type{};
-	};
-
 	void StartWorldThread(const SceneContext& sceneContext);
 	void LoadColliders(bool reloadAll = false);
+	// Uploads the meshes that the world thread finished, returns true if the meshes of the blocks changed
+	bool UploadMeshes(Chunk& genChunk, Chunk& chunk, const SceneContext& sceneContext);
+	// The main thread looks blocks up in its own chunks, the world thread changes the chunks of the generator at any time
+	void CopyBlocks(const Chunk& genChunk, Chunk& chunk) const;
+	void CopyColliderVertices(const Chunk& genChunk, Chunk& chunk) const;
 	void LoadChunkCollider(Chunk& chunk, physx::PxCooking* cooking, physx::PxPhysics& physX, physx::PxMaterial* pPhysMat);
 
-	BlockType GetBlockAt(int x, int y, int z, const std::vector<Chunk>& chunks) const;
+	BlockType GetFluidAt(int x, int y, int z) const;
+	// The main thread chunk of this block and the position of the block in it, nullptr outside the loaded world
+	const Chunk* FindChunk(int x, int y, int z, XMINT3& lookUpPos) const;
+
+	void QueueEdit(const WorldEvent& edit);
+	void FlushOverflowEdits();
+	// The block at this position once the pending edits are applied
+	Block* GetLatestBlockAt(const XMINT3& position) const;
 
 	void PlayBlockSound(FMOD::Sound* pSound);
 
 	std::thread m_WorldThread{};
-	bool m_IsMultithreaded{ true };
+	std::atomic<bool> m_IsMultithreaded{ true };
 
-	bool m_NeedsWorldReload{};
+	// Set by the world thread when it has new world data, the main thread resets it after taking the data over
+	std::atomic<bool> m_NeedsWorldReload{};
 
-	bool m_PlaceBlock{};
-	bool m_DestroyBlock{};
-	XMFLOAT3 m_EditBlock{};
-	BlockType m_EditBlockType{};
+	// Edits from the main thread to the world thread, neither thread ever waits for the other
+	SpscQueue<WorldEvent> m_Edits{ 256 };
+	// Edits that didn't fit in the queue yet, only used by the main thread
+	std::queue<WorldEvent> m_OverflowEdits{};
+	// Edits that aren't loaded in the main thread yet, in the order they were made
+	std::deque<WorldEvent> m_PendingEdits{};
+	// Edits that the world thread applied since the last reload, handed to the main thread together with the world data
+	std::vector<WorldEvent> m_AppliedEdits{};
 
-	std::vector<Chunk> m_Chunks{};
-	std::vector<Chunk> m_WaterChunks{};
+	ChunkPool m_ChunkPool{};
+	ChunkMap m_Chunks{};
 
-	WorldGenerator m_Generator{};
+	WorldGenerator m_Generator;
 	WorldRenderer m_Renderer{};
+	// Declared after the generator, so it is destroyed first and can still wait for its jobs
+	FarTerrain m_FarTerrain{ m_Generator, m_Generator.GetJobSystem() };
 
 	RigidBodyComponent* m_pRb{};
 	PxCooking* m_pColliderCooking{};
 
 	XMINT2 m_ChunkCenter{};
 
+	// Collider cooking cost of the chunks of each mesher
+	WorldGenerator::MeshStats m_CookStats[2]{};
+
 	bool m_CanChangeEnvironment{};
 
 	// AUDIO
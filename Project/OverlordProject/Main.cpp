@@ -1,10 +1,11 @@
 #include "stdafx.h"
 #include "MainGame.h"
+#include "Tests/TestRunner.h"
 
 int wmain(int argc, wchar_t* argv[])
 {
-	UNREFERENCED_PARAMETER(argc);
-	UNREFERENCED_PARAMETER(argv);
+	// Run the tests and benchmarks instead of the game
+	if (argc > 1 && std::wstring{ argv[1] } == L"--tests") return TestRunner::Run();
 
 #pragma warning(push)
 #pragma warning(disable: 6387)
@@ -14,8 +15,11 @@ int wmain(int argc, wchar_t* argv[])
 
 #pragma warning(push)
 #pragma warning(disable: 28251 6387)
-int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR /*pCmdLine*/, int /*nCmdShow*/)
+int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR pCmdLine, int /*nCmdShow*/)
 {
+	// Run the tests and benchmarks instead of the game, without creating a window
+	if (pCmdLine && std::wstring{ pCmdLine } == L"--tests") return TestRunner::Run();
+
 	//UNREFERENCED_PARAMETER(nCmdShow);
 	//UNREFERENCED_PARAMETER(pCmdLine);
 	////notify user if heap is corrupt
@@ -12,9 +12,26 @@ BlockManager::BlockManager()
 	JsonReader json{};
 	m_pBlocksByIdentifier = json.ReadBlocks();
 
+	// Flatten the blocks into tables indexed by block type
 	for (const auto& blockPair : m_pBlocksByIdentifier)
 	{
-		m_pBlocksByType[blockPair.second->type] = blockPair.second;
+		const Block* pBlock{ blockPair.second };
+		const int typeIdx{ static_cast<int>(pBlock->type) };
+
+		m_pBlocksByType[typeIdx] = blockPair.second;
+		m_Meshes[typeIdx] = pBlock->mesh;
+		m_IsTransparent[typeIdx] = pBlock->transparent;
+		m_DropBlocks[typeIdx] = pBlock->dropBlock ? pBlock->dropBlock->type : BlockType::AIR;
+		m_BreakTimes[typeIdx] = pBlock->breakTime;
+
+		// Air never has or hides faces
+		m_IsCube[typeIdx] = pBlock->type != BlockType::AIR && pBlock->mesh == BlockMesh::CUBE;
+		m_IsOpaqueCube[typeIdx] = m_IsCube[typeIdx] && !pBlock->transparent;
+
+		// Cross blocks and cutout cubes are clipped, other see-through blocks are blended
+		if (pBlock->mesh == BlockMesh::CROSS || pBlock->cutout) m_MeshLayers[typeIdx] = MeshLayer::CUTOUT;
+		else if (pBlock->transparent) m_MeshLayers[typeIdx] = MeshLayer::TRANSLUCENT;
+		else m_MeshLayers[typeIdx] = MeshLayer::SOLID;
 	}
 
 	m_StructuresByIdentifier = json.ReadStructures(m_pBlocksByIdentifier);
@@ -50,18 +67,6 @@ Block* BlockManager::GetBlock(const std::string& identifier) const
 	return nullptr;
 }
 
-Block* BlockManager::GetBlock(BlockType type) const
-{
-	const auto it{ m_pBlocksByType.find(type) };
-
-	if (it != m_pBlocksByType.end())
-	{
-		return it->second;
-	}
-
-	return nullptr;
-}
-
 const std::string& BlockManager::GetBlockName(BlockType type) const
 {
 	const auto it{ std::find_if(begin(m_pBlocksByIdentifier), end(m_pBlocksByIdentifier), [type](const auto& blockPair) { return blockPair.second->type == type; }) };
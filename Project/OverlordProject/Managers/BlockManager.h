@@ -1,18 +1,36 @@
 #pragma once
 #include <Misc/World/WorldData.h>
 
+#include <array>
+
 class BlockManager final : public Singleton<BlockManager>
 {
 public:
+	static constexpr int NrBlockTypes{ 256 };
+
 	BlockManager(const BlockManager& other) = delete;
 	BlockManager(BlockManager&& other) noexcept = delete;
 	BlockManager& operator=(const BlockManager& other) = delete;
 	BlockManager& operator=(BlockManager&& other) noexcept = delete;
 
 	Block* GetBlock(const std::string& identifier) const;
-	Block* GetBlock(BlockType type) const;
+	Block* GetBlock(BlockType type) const { return m_pBlocksByType[static_cast<int>(type)]; }
 	const std::string& GetBlockName(BlockType type) const;
 
+	// The properties of every block type, read from dense tables so the mesher doesn't have to look up the block
+	//	block types that aren't registered have no faces and don't hide anything
+	BlockMesh GetMesh(BlockType type) const { return m_Meshes[static_cast<int>(type)]; }
+	bool IsTransparent(BlockType type) const { return m_IsTransparent[static_cast<int>(type)]; }
+	BlockType GetDropBlock(BlockType type) const { return m_DropBlocks[static_cast<int>(type)]; }
+	float GetBreakTime(BlockType type) const { return m_BreakTimes[static_cast<int>(type)]; }
+	bool IsCube(BlockType type) const { return m_IsCube[static_cast<int>(type)]; }
+	bool IsOpaqueCube(BlockType type) const { return m_IsOpaqueCube[static_cast<int>(type)]; }
+	MeshLayer GetMeshLayer(BlockType type) const { return m_MeshLayers[static_cast<int>(type)]; }
+
+	// The tables of cubes and opaque cubes, indexed by block type
+	const bool* GetCubeTable() const { return m_IsCube.data(); }
+	const bool* GetOpaqueCubeTable() const { return m_IsOpaqueCube.data(); }
+
 	const std::vector<VertexPosNormTexTransparency>& GetVertices(const std::string& identifier) const;
 
 	const Biome& GetBiome(const std::string& identifier) const;
@@ -25,7 +43,15 @@ private:
 	~BlockManager();
 
 	std::unordered_map<std::string, Block*> m_pBlocksByIdentifier{};
-	std::unordered_map<BlockType, Block*> m_pBlocksByType{};
+	std::array<Block*, NrBlockTypes> m_pBlocksByType{};
+
+	std::array<BlockMesh, NrBlockTypes> m_Meshes{};
+	std::array<bool, NrBlockTypes> m_IsTransparent{};
+	std::array<BlockType, NrBlockTypes> m_DropBlocks{};
+	std::array<float, NrBlockTypes> m_BreakTimes{};
+	std::array<bool, NrBlockTypes> m_IsCube{};
+	std::array<bool, NrBlockTypes> m_IsOpaqueCube{};
+	std::array<MeshLayer, NrBlockTypes> m_MeshLayers{};
 
 	std::unordered_map<std::string, Biome> m_BiomesByIdentifier{};
 
@@ -64,6 +64,9 @@ void JsonReader::ReadBlock(const rapidjson::Value& block, std::unordered_map<std
 	const auto& transparentIt = block.FindMember("transparent");
 	pBlock->transparent = transparentIt != block.MemberEnd() ? transparentIt->value.GetBool() : false;
 
+	const auto& cutoutIt = block.FindMember("cutout");
+	pBlock->cutout = cutoutIt != block.MemberEnd() ? cutoutIt->value.GetBool() : false;
+
 	pBlock->mesh = static_cast<BlockMesh>(block["mesh"].GetInt());
 
 	const auto pFmod{ SoundManager::Get()->GetSystem() };
@@ -1,31 +1,193 @@
 #pragma once
 
-#include "Utils/VertexHelper.h"
 #include "WorldData.h"
+#include "ChunkSection.h"
+#include "ChunkVertex.h"
+#include "SectionVisibility.h"
 
 #include <DirectXMath.h>
+#include <array>
 #include <vector>
 
 struct Chunk
 {
-	void DeleteChunk() 
+	static constexpr int NrMeshLayers{ 3 };
+
+	// The vertices of one section, an edit only remeshes the sections around it and the chunk joins the lists of all its sections
+	struct SectionMesh
+	{
+		std::array<std::vector<ChunkVertex>, NrMeshLayers> vertices{};
+		std::vector<ChunkVertex> waterVertices{};
+	};
+
+	// Positions are relative to the chunk, y goes over the full world height
+	BlockType GetBlock(int x, int y, int z) const
+	{
+		return sections[y / ChunkSection::Size].GetBlock(x, y % ChunkSection::Size, z);
+	}
+	void SetBlock(int x, int y, int z, BlockType block)
+	{
+		if (block != BlockType::AIR) sectionBits |= 1U << (y / ChunkSection::Size);
+
+		sections[y / ChunkSection::Size].SetBlock(x, y % ChunkSection::Size, z, block);
+	}
+
+	// The fluid layer only exists once a fluid has been added to this chunk
+	BlockType GetFluid(int x, int y, int z) const
+	{
+		if (fluidSections.empty()) return BlockType::AIR;
+
+		return fluidSections[y / ChunkSection::Size].GetBlock(x, y % ChunkSection::Size, z);
+	}
+	void SetFluid(int x, int y, int z, BlockType fluid)
 	{
-		SafeRelease(pVertexBuffer);
-		SafeRelease(pVertexTransparentBuffer);
+		if (fluidSections.empty())
+		{
+			if (fluid == BlockType::AIR) return;
+
+			fluidSections.resize(sections.size());
+		}
+
+		if (fluid != BlockType::AIR) fluidSectionBits |= 1U << (y / ChunkSection::Size);
+
+		fluidSections[y / ChunkSection::Size].SetBlock(x, y % ChunkSection::Size, z, fluid);
 	}
+	bool HasFluid() const { return !fluidSections.empty(); }
+
+	// A section without its bit only contains air, a section with its bit can contain blocks
+	bool HasBlocksInSection(int sectionIdx) const { return (sectionBits >> sectionIdx) & 1U; }
+	bool HasFluidInSection(int sectionIdx) const { return (fluidSectionBits >> sectionIdx) & 1U; }
+
+	static int GetColumnIdx(int x, int z) { return x + z * ChunkSection::Size; }
+
+	// The world position that the positions of the vertices are relative to
+	DirectX::XMFLOAT3 GetOrigin() const { return DirectX::XMFLOAT3{ static_cast<float>(position.x * ChunkSection::Size), 0.0f, static_cast<float>(position.y * ChunkSection::Size) }; }
+
+	// The height of the highest block in this column, -1 if the column only contains air
+	int GetHeight(int x, int z) const { return heightMap[GetColumnIdx(x, z)]; }
+	// The lowest block in this column that is not an opaque cube (air, transparent and cross blocks)
+	//	every block underneath it is hidden from above
+	int GetLowestExposed(int x, int z) const { return lowestExposedMap[GetColumnIdx(x, z)]; }
+
+	void Compact()
+	{
+		for (ChunkSection& section : sections) section.Compact();
+		for (ChunkSection& section : fluidSections) section.Compact();
+
+		// Sections that only contain air after compacting lose their bit
+		UpdateSectionBits();
+	}
+
+	void UpdateSectionBits()
+	{
+		sectionBits = 0;
+		for (size_t i{}; i < sections.size(); ++i)
+		{
+			if (!sections[i].IsEmpty()) sectionBits |= 1U << i;
+		}
+
+		fluidSectionBits = 0;
+		for (size_t i{}; i < fluidSections.size(); ++i)
+		{
+			if (!fluidSections[i].IsEmpty()) fluidSectionBits |= 1U << i;
+		}
+	}
+
+	// Clears the chunk so it can be reused for another position
+	// The containers keep their memory, so a reused chunk doesn't have to allocate it again
+	void Reset()
+	{
+		for (ChunkSection& section : sections) section.Reset();
+		fluidSections.clear();
+
+		sectionBits = 0;
+		fluidSectionBits = 0;
+		heightMap.fill(-1);
+		lowestExposedMap.fill(0);
+
+		for (std::vector<ChunkVertex>& layerVertices : vertices) layerVertices.clear();
+		waterVertices.clear();
+		for (SectionMesh& sectionMesh : sectionMeshes)
+		{
+			for (std::vector<ChunkVertex>& layerVertices : sectionMesh.vertices) layerVertices.clear();
+			sectionMesh.waterVertices.clear();
+		}
+		for (std::vector<int>& sectionStarts : sectionVertexStarts) sectionStarts.clear();
+		sectionVisibility.assign(sectionVisibility.size(), SectionVisibility{});
+		visibleSectionBits = ~0U;
+
+		// A reused chunk is meshed from scratch
+		dirtySectionBits = ~0U;
+		dirtyFluidSectionBits = ~0U;
+
+		position = {};
+
+		meshHandles.fill(-1);
+		waterMeshHandle = -1;
+
+		vertexBufferSizes.fill(0);
+		waterVertexBufferSize = 0;
+		bounds = DirectX::BoundingBox{ DirectX::XMFLOAT3{}, DirectX::XMFLOAT3{} };
+		waterBounds = DirectX::BoundingBox{ DirectX::XMFLOAT3{}, DirectX::XMFLOAT3{} };
+
+		colliderIdx = -1;
+		lodLevel = 0;
+		isModified = false;
+		useGreedyMesh = false;
+		verticesChanged = true;
+		waterVerticesChanged = true;
+		hasNewVertices = false;
+		hasNewWaterVertices = false;
+		needColliderChange = true;
+	}
+
+	// The vertices of the block layer, one list per MeshLayer so they can be uploaded without sorting
+	std::array<std::vector<ChunkVertex>, NrMeshLayers> vertices{};
+	std::vector<ChunkVertex> waterVertices{};
+	std::vector<SectionMesh> sectionMeshes{};
+	// Where the vertices of every section start in the list of each mesh layer, the size of the list is the last entry
+	//	the renderer only draws the runs of sections that the camera can see
+	std::array<std::vector<int>, NrMeshLayers> sectionVertexStarts{};
+	// Which faces of every section see each other, built together with the vertices of the block layer
+	std::vector<SectionVisibility> sectionVisibility{};
+	std::vector<ChunkSection> sections{};
+	std::vector<ChunkSection> fluidSections{};
+
+	// One bit per section, so the world can be up to 32 sections high
+	uint32_t sectionBits{};
+	uint32_t fluidSectionBits{};
+
+	// One bit per section that has to be remeshed, in the block layer and in the fluid layer
+	uint32_t dirtySectionBits{ ~0U };
+	uint32_t dirtyFluidSectionBits{ ~0U };
+
+	std::array<int16_t, ChunkSection::Size * ChunkSection::Size> heightMap{};
+	std::array<int16_t, ChunkSection::Size * ChunkSection::Size> lowestExposedMap{};
+
+	DirectX::XMINT2 position;
+
+	// The meshes of the chunks on the main thread in the buffer pool of the renderer, -1 without a mesh
+	std::array<int, NrMeshLayers> meshHandles{ -1, -1, -1 };
+	int waterMeshHandle{ -1 };
 
-	std::vector<VertexPosNormTexTransparency> vertices{};
-	std::vector<BlockType> blocks{};
+	std::array<int, NrMeshLayers> vertexBufferSizes{};
+	int waterVertexBufferSize{};
 
-	XMINT2 position;
+	// The boxes around the vertices of the mesh layers and of the water relative to the chunk, the renderer skips the buffers when their box is out of view
+	DirectX::BoundingBox bounds{ DirectX::XMFLOAT3{}, DirectX::XMFLOAT3{} };
+	DirectX::BoundingBox waterBounds{ DirectX::XMFLOAT3{}, DirectX::XMFLOAT3{} };
 
-	ID3D11Buffer* pVertexBuffer{};
-	ID3D11Buffer* pVertexTransparentBuffer{};
-	
-	int vertexBufferSize{};
-	int vertexTransparentBufferSize{};
+	// The sections that the camera can reach through the caves, set by the renderer every frame
+	uint32_t visibleSectionBits{ ~0U };
 
 	int colliderIdx{ -1 };
+	int lodLevel{}; // 0 is full resolution, every level merges twice as many blocks along every axis into one cell
+	bool isModified{}; // Set when the chunk has been changed after it was generated or loaded
+	bool useGreedyMesh{}; // Merges the faces of opaque blocks into bigger quads when the chunk is meshed
 	bool verticesChanged{ true };
+	bool waterVerticesChanged{ true };
+	// Set when the world thread is done with the vertices, the main thread uploads them when it takes the chunk over
+	bool hasNewVertices{};
+	bool hasNewWaterVertices{};
 	bool needColliderChange{ true };
 };
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "stdafx.h"
+#include "ChunkBufferPool.h"
+
+ChunkBufferPool::~ChunkBufferPool()
+{
+	for (std::unique_ptr<Page>& pPage : m_pPages)
+	{
+		if (pPage) SafeRelease(pPage->pBuffer);
+	}
+}
+
+void ChunkBufferPool::Upload(const std::vector<ChunkVertex>& vertices, int& handle, const SceneContext& sceneContext)
+{
+	const int nrVertices{ static_cast<int>(vertices.size()) };
+	if (nrVertices == 0)
+	{
+		Free(handle);
+		return;
+	}
+
+	if (handle == InvalidHandle)
+	{
+		if (m_FreeHandles.empty())
+		{
+			handle = static_cast<int>(m_Allocations.size());
+			m_Allocations.emplace_back();
+		}
+		else
+		{
+			handle = m_FreeHandles.back();
+			m_FreeHandles.pop_back();
+		}
+	}
+
+	// A mesh that still fits in its range is written in place, otherwise it gets a new range
+	//	a mesh that shrank to less than half of its range moves as well, so the rest of the range can be used again
+	Allocation& allocation{ m_Allocations[handle] };
+	if (allocation.pageIdx >= 0 && nrVertices <= allocation.capacity && GetRangeSize(nrVertices) * 2 > allocation.capacity)
+	{
+		++m_NrInPlaceUploads;
+	}
+	else
+	{
+		if (allocation.pageIdx >= 0)
+		{
+			FreeRange(allocation);
+			++m_NrReallocations;
+		}
+
+		Allocate(GetRangeSize(nrVertices), -1, true, allocation, sceneContext);
+	}
+	allocation.nrVertices = nrVertices;
+
+	// Only the bytes of the vertices are written, the rest of the range keeps what it held
+	constexpr UINT stride{ sizeof(ChunkVertex) };
+	const D3D11_BOX box{ static_cast<UINT>(allocation.offset) * stride, 0, 0, static_cast<UINT>(allocation.offset + nrVertices) * stride, 1, 1 };
+	sceneContext.d3dContext.pDeviceContext->UpdateSubresource(m_pPages[allocation.pageIdx]->pBuffer, 0, &box, vertices.data(), 0, 0);
+}
+
+void ChunkBufferPool::Free(int& handle)
+{
+	if (handle == InvalidHandle) return;
+
+	FreeRange(m_Allocations[handle]);
+	m_Allocations[handle] = Allocation{};
+	m_FreeHandles.emplace_back(handle);
+
+	handle = InvalidHandle;
+}
+
+ChunkBufferPool::Mesh ChunkBufferPool::GetMesh(int handle) const
+{
+	if (handle == InvalidHandle) return Mesh{};
+
+	const Allocation& allocation{ m_Allocations[handle] };
+	return Mesh{ m_pPages[allocation.pageIdx]->pBuffer, allocation.offset, allocation.nrVertices };
+}
+
+void ChunkBufferPool::Defragment(int maxNrMoves, const SceneContext& sceneContext)
+{
+	// Empty the page that has the least vertices in use, if the other pages have room for them
+	int emptiestPageIdx{ -1 };
+	int nrFreeInOtherPages{};
+	for (int pageIdx{}; pageIdx < static_cast<int>(m_pPages.size()); ++pageIdx)
+	{
+		if (!m_pPages[pageIdx]) continue;
+
+		const RangeAllocator& allocator{ m_pPages[pageIdx]->allocator };
+		nrFreeInOtherPages += allocator.GetNrFree();
+		if (emptiestPageIdx < 0 || allocator.GetNrUsed() < m_pPages[emptiestPageIdx]->allocator.GetNrUsed()) emptiestPageIdx = pageIdx;
+	}
+	if (emptiestPageIdx < 0) return;
+
+	const RangeAllocator& emptiestAllocator{ m_pPages[emptiestPageIdx]->allocator };
+	nrFreeInOtherPages -= emptiestAllocator.GetNrFree();
+	if (emptiestAllocator.GetNrUsed() > nrFreeInOtherPages) return;
+
+	// Copy the meshes on the GPU, their handles stay the same so the chunks don't notice the move
+	for (Allocation& allocation : m_Allocations)
+	{
+		if (maxNrMoves <= 0) break;
+		if (allocation.pageIdx != emptiestPageIdx) continue;
+
+		Allocation movedAllocation{};
+		if (!Allocate(allocation.capacity, emptiestPageIdx, false, movedAllocation, sceneContext)) break;
+		movedAllocation.nrVertices = allocation.nrVertices;
+
+		constexpr UINT stride{ sizeof(ChunkVertex) };
+		const D3D11_BOX box{ static_cast<UINT>(allocation.offset) * stride, 0, 0, static_cast<UINT>(allocation.offset + allocation.nrVertices) * stride, 1, 1 };
+		sceneContext.d3dContext.pDeviceContext->CopySubresourceRegion(m_pPages[movedAllocation.pageIdx]->pBuffer, 0, static_cast<UINT>(movedAllocation.offset) * stride, 0, 0,
+			m_pPages[emptiestPageIdx]->pBuffer, 0, &box);
+
+		// Freeing the last range releases the page, the device keeps it alive until the recorded copy is done
+		FreeRange(allocation);
+		allocation = movedAllocation;
+
+		++m_NrMovedMeshes;
+		--maxNrMoves;
+	}
+}
+
+ChunkBufferPool::Stats ChunkBufferPool::GetStats() const
+{
+	Stats stats{};
+	int nrFree{};
+	for (const std::unique_ptr<Page>& pPage : m_pPages)
+	{
+		if (!pPage) continue;
+
+		const RangeAllocator::Stats pageStats{ pPage->allocator.GetStats() };
+		++stats.nrPages;
+		stats.nrMeshes += pageStats.nrAllocations;
+		stats.capacity += pageStats.capacity;
+		stats.nrUsed += pageStats.nrUsed;
+		stats.largestFreeRange = std::max(stats.largestFreeRange, pageStats.largestFreeRange);
+		nrFree += pageStats.capacity - pageStats.nrUsed;
+	}
+
+	// Over all pages, a mesh can't be split over two pages
+	if (nrFree > 0) stats.fragmentation = 1.0f - static_cast<float>(stats.largestFreeRange) / nrFree;
+
+	stats.nrInPlaceUploads = m_NrInPlaceUploads;
+	stats.nrReallocations = m_NrReallocations;
+	stats.nrMovedMeshes = m_NrMovedMeshes;
+
+	return stats;
+}
+
+int ChunkBufferPool::GetRangeSize(int nrVertices)
+{
+	// A quarter more than needed, so a mesh can grow a bit before it has to move
+	const int size{ nrVertices + nrVertices / 4 };
+	return (size + RangeGranularity - 1) / RangeGranularity * RangeGranularity;
+}
+
+bool ChunkBufferPool::Allocate(int size, int excludedPageIdx, bool canCreatePage, Allocation& allocation, const SceneContext& sceneContext)
+{
+	for (int pageIdx{}; pageIdx < static_cast<int>(m_pPages.size()); ++pageIdx)
+	{
+		if (pageIdx == excludedPageIdx || !m_pPages[pageIdx]) continue;
+
+		const int offset{ m_pPages[pageIdx]->allocator.Allocate(size) };
+		if (offset == RangeAllocator::InvalidOffset) continue;
+
+		allocation = Allocation{ pageIdx, offset, size, allocation.nrVertices };
+		return true;
+	}
+
+	if (!canCreatePage) return false;
+
+	const int pageIdx{ CreatePage(std::max(size, PageSize), sceneContext) };
+	allocation = Allocation{ pageIdx, m_pPages[pageIdx]->allocator.Allocate(size), size, allocation.nrVertices };
+	return true;
+}
+
+void ChunkBufferPool::FreeRange(const Allocation& allocation)
+{
+	if (allocation.pageIdx < 0) return;
+
+	std::unique_ptr<Page>& pPage{ m_pPages[allocation.pageIdx] };
+	pPage->allocator.Free(allocation.offset, allocation.capacity);
+
+	// Pages without meshes are released, the next page is created when a mesh doesn't fit anymore
+	if (pPage->allocator.IsEmpty())
+	{
+		SafeRelease(pPage->pBuffer);
+		pPage.reset();
+	}
+}
+
+int ChunkBufferPool::CreatePage(int capacity, const SceneContext& sceneContext)
+{
+	std::unique_ptr<Page> pPage{ std::make_unique<Page>(capacity) };
+
+	//*************
+	//VERTEX BUFFER
+	D3D11_BUFFER_DESC vertexBuffDesc{};
+	vertexBuffDesc.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_VERTEX_BUFFER;
+	vertexBuffDesc.ByteWidth = static_cast<UINT>(sizeof(ChunkVertex) * capacity);
+	vertexBuffDesc.CPUAccessFlags = 0;
+	vertexBuffDesc.Usage = D3D11_USAGE::D3D11_USAGE_DEFAULT;
+	vertexBuffDesc.MiscFlags = 0;
+
+	sceneContext.d3dContext.pDevice->CreateBuffer(&vertexBuffDesc, nullptr, &pPage->pBuffer);
+
+	// Reuse the slot of a released page
+	for (int pageIdx{}; pageIdx < static_cast<int>(m_pPages.size()); ++pageIdx)
+	{
+		if (m_pPages[pageIdx]) continue;
+
+		m_pPages[pageIdx] = std::move(pPage);
+		return pageIdx;
+	}
+
+	m_pPages.emplace_back(std::move(pPage));
+	return static_cast<int>(m_pPages.size()) - 1;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "ChunkVertex.h"
+#include "Utils/RangeAllocator.h"
+
+#include <memory>
+#include <vector>
+
+// The vertices of every chunk mesh live in a few big vertex buffers, every mesh is a range of one of these pages
+//	a mesh is rewritten in place while it fits in its range, and meshes are moved out of the emptiest page a few at a time so it can be released
+// Only use it on the main thread, the meshes are written with the immediate context
+class ChunkBufferPool final
+{
+public:
+	// Where the vertices of a mesh are, the first vertex is the base vertex of its draws
+	struct Mesh
+	{
+		ID3D11Buffer* pBuffer{};
+		int firstVertex{};
+		int nrVertices{};
+	};
+
+	struct Stats
+	{
+		int nrPages{};
+		int nrMeshes{};
+		// Over all pages, in vertices
+		int capacity{};
+		int nrUsed{};
+		int largestFreeRange{};
+		float fragmentation{};
+		int nrInPlaceUploads{};
+		int nrReallocations{};
+		int nrMovedMeshes{};
+	};
+
+	static constexpr int InvalidHandle{ -1 };
+	// The vertices of one page, a mesh that is bigger gets a page of its own size
+	static constexpr int PageSize{ 1 << 20 };
+	// Ranges are rounded up to this, so small changes to a mesh don't have to move it
+	static constexpr int RangeGranularity{ 256 };
+
+	ChunkBufferPool() = default;
+	~ChunkBufferPool();
+
+	ChunkBufferPool(const ChunkBufferPool& other) = delete;
+	ChunkBufferPool(ChunkBufferPool&& other) noexcept = delete;
+	ChunkBufferPool& operator=(const ChunkBufferPool& other) = delete;
+	ChunkBufferPool& operator=(ChunkBufferPool&& other) noexcept = delete;
+
+	// Writes the vertices into the mesh of the handle, an invalid handle gets a new mesh
+	//	without vertices the mesh is freed and the handle becomes invalid
+	void Upload(const std::vector<ChunkVertex>& vertices, int& handle, const SceneContext& sceneContext);
+	void Free(int& handle);
+	Mesh GetMesh(int handle) const;
+
+	// Moves at most this many meshes from the emptiest page into the free ranges of the other pages
+	void Defragment(int maxNrMoves, const SceneContext& sceneContext);
+
+	Stats GetStats() const;
+
+private:
+	struct Page
+	{
+		explicit Page(int capacity) : allocator{ capacity } {}
+
+		ID3D11Buffer* pBuffer{};
+		RangeAllocator allocator;
+	};
+
+	struct Allocation
+	{
+		int pageIdx{ -1 };
+		int offset{};
+		int capacity{};
+		int nrVertices{};
+	};
+
+	static int GetRangeSize(int nrVertices);
+
+	// Finds a free range in any page except the excluded one, a new page is only created when it is allowed
+	bool Allocate(int size, int excludedPageIdx, bool canCreatePage, Allocation& allocation, const SceneContext& sceneContext);
+	void FreeRange(const Allocation& allocation);
+	int CreatePage(int capacity, const SceneContext& sceneContext);
+
+	// Released pages leave an empty slot, so the page indices of the allocations stay valid
+	std::vector<std::unique_ptr<Page>> m_pPages{};
+	std::vector<Allocation> m_Allocations{};
+	std::vector<int> m_FreeHandles{};
+
+	int m_NrInPlaceUploads{};
+	int m_NrReallocations{};
+	int m_NrMovedMeshes{};
+};
@@ -0,0 +1,96 @@
+#include "stdafx.h"
+#include "ChunkCache.h"
+
+#include "Chunk.h"
+#include "ChunkSerializer.h"
+
+ChunkCache::ChunkCache(size_t byteBudget)
+	: m_ByteBudget{ byteBudget }
+{
+}
+
+void ChunkCache::Add(const Chunk& chunk)
+{
+	const uint64_t key{ PackPosition(chunk.position.x, chunk.position.y) };
+
+	// Remove the previous version of this chunk
+	if (const auto it{ m_EntriesByKey.find(key) }; it != m_EntriesByKey.end()) Remove(it->second);
+
+	// Reuse the memory of the oldest entry if the cache is full, otherwise create a new entry
+	if (!m_Entries.empty() && m_Stats.nrBytes >= m_ByteBudget)
+	{
+		Entry& oldestEntry{ m_Entries.back() };
+		m_EntriesByKey.erase(oldestEntry.key);
+		m_Stats.nrBytes -= oldestEntry.data.size();
+		--m_Stats.nrChunks;
+		++m_Stats.nrEvictions;
+
+		m_Entries.splice(m_Entries.begin(), m_Entries, std::prev(m_Entries.end()));
+	}
+	else
+	{
+		m_Entries.emplace_front();
+	}
+
+	// Serialize the chunk in the entry
+	Entry& entry{ m_Entries.front() };
+	entry.key = key;
+	entry.data.clear();
+	ChunkSerializer::Serialize(chunk, entry.data);
+
+	m_EntriesByKey[key] = m_Entries.begin();
+	m_Stats.nrBytes += entry.data.size();
+	++m_Stats.nrChunks;
+
+	// Remove the oldest chunks until the cache fits in its budget again
+	Evict();
+}
+
+bool ChunkCache::Load(Chunk& chunk)
+{
+	const auto it{ m_EntriesByKey.find(PackPosition(chunk.position.x, chunk.position.y)) };
+	if (it == m_EntriesByKey.end())
+	{
+		++m_Stats.nrMisses;
+		return false;
+	}
+
+	// The chunk is loaded again, so it doesn't need to stay in the cache
+	const bool isLoaded{ ChunkSerializer::Deserialize(chunk, it->second->data.data(), it->second->data.size()) };
+	Remove(it->second);
+
+	if (isLoaded) ++m_Stats.nrHits;
+	else ++m_Stats.nrMisses;
+
+	return isLoaded;
+}
+
+void ChunkCache::SetByteBudget(size_t byteBudget)
+{
+	m_ByteBudget = byteBudget;
+
+	Evict();
+}
+
+uint64_t ChunkCache::PackPosition(int chunkX, int chunkY)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY);
+}
+
+void ChunkCache::Remove(std::list<Entry>::iterator it)
+{
+	m_Stats.nrBytes -= it->data.size();
+	--m_Stats.nrChunks;
+
+	m_EntriesByKey.erase(it->key);
+	m_Entries.erase(it);
+}
+
+void ChunkCache::Evict()
+{
+	while (!m_Entries.empty() && m_Stats.nrBytes > m_ByteBudget)
+	{
+		Remove(std::prev(m_Entries.end()));
+		++m_Stats.nrEvictions;
+	}
+}
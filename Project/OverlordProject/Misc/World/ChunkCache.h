@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+struct Chunk;
+
+// Keeps recently unloaded chunks in memory in their serialized form, so they don't have to be generated again
+// When the cache goes over its byte budget, the chunks that have been in the cache the longest are removed
+class ChunkCache final
+{
+public:
+	struct Stats
+	{
+		int nrHits{};
+		int nrMisses{};
+		int nrEvictions{}; // Chunks that were removed to stay under the byte budget
+		int nrChunks{};
+		size_t nrBytes{}; // The serialized size of all the chunks in the cache
+	};
+
+	explicit ChunkCache(size_t byteBudget);
+	~ChunkCache() = default;
+
+	ChunkCache(const ChunkCache& other) = delete;
+	ChunkCache(ChunkCache&& other) noexcept = delete;
+	ChunkCache& operator=(const ChunkCache& other) = delete;
+	ChunkCache& operator=(ChunkCache&& other) noexcept = delete;
+
+	// Stores the blocks and fluids of the chunk, replacing a previous version of the same chunk
+	void Add(const Chunk& chunk);
+	// Fills the sections of the chunk with the cached version and removes it from the cache
+	// Returns false if the chunk isn't in the cache
+	bool Load(Chunk& chunk);
+
+	void SetByteBudget(size_t byteBudget);
+	size_t GetByteBudget() const { return m_ByteBudget; }
+
+	const Stats& GetStats() const { return m_Stats; }
+
+private:
+	struct Entry
+	{
+		uint64_t key{};
+		std::vector<uint8_t> data{};
+	};
+
+	static uint64_t PackPosition(int chunkX, int chunkY);
+
+	void Remove(std::list<Entry>::iterator it);
+	void Evict();
+
+	// The most recently added chunk is at the front
+	std::list<Entry> m_Entries{};
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> m_EntriesByKey{};
+
+	size_t m_ByteBudget{};
+	Stats m_Stats{};
+};
@@ -0,0 +1,52 @@
+#include "stdafx.h"
+#include "ChunkDrawList.h"
+
+#include <algorithm>
+
+void ChunkDrawList::Build(const ChunkMap& chunks, const XMINT2& cameraChunk)
+{
+	if (!HasChanged(chunks, cameraChunk)) return;
+
+	m_CameraChunk = cameraChunk;
+	m_Entries.clear();
+	m_pMapChunks.clear();
+	m_MapPositions.clear();
+
+	int chunkIdx{};
+	for (Chunk& chunk : chunks)
+	{
+		const int offsetX{ chunk.position.x - cameraChunk.x };
+		const int offsetY{ chunk.position.y - cameraChunk.y };
+		m_Entries.emplace_back(Entry{ &chunk, chunkIdx++, offsetX * offsetX + offsetY * offsetY });
+
+		// Erased chunks go back to the pool and can come back at another position, so the position is kept as well
+		m_pMapChunks.emplace_back(&chunk);
+		m_MapPositions.emplace_back(chunk.position);
+	}
+
+	// Chunks at the same distance keep the order of the map, so the order doesn't flicker between builds
+	std::sort(m_Entries.begin(), m_Entries.end(), [](const Entry& a, const Entry& b)
+		{
+			if (a.distance != b.distance) return a.distance < b.distance;
+			return a.chunkIdx < b.chunkIdx;
+		});
+
+	++m_NrSorts;
+}
+
+bool ChunkDrawList::HasChanged(const ChunkMap& chunks, const XMINT2& cameraChunk) const
+{
+	if (cameraChunk.x != m_CameraChunk.x || cameraChunk.y != m_CameraChunk.y) return true;
+	if (chunks.Size() != static_cast<int>(m_pMapChunks.size())) return true;
+
+	int chunkIdx{};
+	for (const Chunk& chunk : chunks)
+	{
+		const XMINT2& position{ m_MapPositions[chunkIdx] };
+		if (m_pMapChunks[chunkIdx] != &chunk || position.x != chunk.position.x || position.y != chunk.position.y) return true;
+
+		++chunkIdx;
+	}
+
+	return false;
+}
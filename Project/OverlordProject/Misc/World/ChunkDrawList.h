@@ -0,0 +1,45 @@
+#pragma once
+#include "ChunkMap.h"
+
+#include <vector>
+
+// The loaded chunks sorted by their distance to the chunk of the camera
+//	opaque layers are drawn nearest first so the depth test rejects what is behind them, blended layers farthest first so they blend in order
+// Only reads the positions of the chunks, so it doesn't need a device
+class ChunkDrawList final
+{
+public:
+	struct Entry
+	{
+		Chunk* pChunk{};
+		int chunkIdx{}; // In the order of the chunk map, the index of the box of the chunk in a culler
+		int distance{}; // Squared, in chunks
+	};
+
+	ChunkDrawList() = default;
+	~ChunkDrawList() = default;
+
+	ChunkDrawList(const ChunkDrawList& other) = delete;
+	ChunkDrawList(ChunkDrawList&& other) noexcept = delete;
+	ChunkDrawList& operator=(const ChunkDrawList& other) = delete;
+	ChunkDrawList& operator=(ChunkDrawList&& other) noexcept = delete;
+
+	// Only sorts again when the camera went to another chunk or the chunks in the map changed
+	//	the distances are in whole chunks, so the order stays the same while the camera stays inside one chunk
+	void Build(const ChunkMap& chunks, const XMINT2& cameraChunk);
+
+	// Nearest first, walk it backwards for farthest first
+	const std::vector<Entry>& GetEntries() const { return m_Entries; }
+	// How many builds had to sort, for profiling
+	int GetNrSorts() const { return m_NrSorts; }
+
+private:
+	bool HasChanged(const ChunkMap& chunks, const XMINT2& cameraChunk) const;
+
+	std::vector<Entry> m_Entries{};
+	// The chunk of every entry in the order of the chunk map, to find out whether the map changed
+	std::vector<const Chunk*> m_pMapChunks{};
+	std::vector<XMINT2> m_MapPositions{};
+	XMINT2 m_CameraChunk{};
+	int m_NrSorts{};
+};
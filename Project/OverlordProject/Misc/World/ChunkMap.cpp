@@ -0,0 +1,169 @@
+#include "stdafx.h"
+#include "ChunkMap.h"
+
+Chunk* ChunkMap::Find(int chunkX, int chunkY) const
+{
+	const int slotIdx{ FindSlot(PackPosition(chunkX, chunkY)) };
+
+	if (slotIdx < 0) return nullptr;
+
+	return m_pChunks[m_Slots[slotIdx].chunkIdx].get();
+}
+
+Chunk& ChunkMap::Insert(Chunk&& chunk)
+{
+	// If the chunk already exists, overwrite it
+	if (Chunk* pExisting{ Find(chunk.position) })
+	{
+		*pExisting = std::move(chunk);
+		return *pExisting;
+	}
+
+	// Store the chunk on the heap so its address doesn't change when other chunks are added or erased
+	return Insert(std::make_unique<Chunk>(std::move(chunk)));
+}
+
+Chunk& ChunkMap::Insert(std::unique_ptr<Chunk> pChunk)
+{
+	// If the chunk already exists, replace it
+	const int existingSlotIdx{ FindSlot(PackPosition(pChunk->position.x, pChunk->position.y)) };
+	if (existingSlotIdx >= 0)
+	{
+		std::unique_ptr<Chunk>& pExisting{ m_pChunks[m_Slots[existingSlotIdx].chunkIdx] };
+		std::swap(pExisting, pChunk);
+
+		if (m_pPool) m_pPool->Release(std::move(pChunk));
+		return *pExisting;
+	}
+
+	// Keep the load factor under 50% so probe sequences stay short
+	if ((m_pChunks.size() + 1) * 2 > m_Slots.size())
+	{
+		Rehash(std::max<size_t>(m_Slots.size() * 2, 16));
+	}
+
+	m_pChunks.emplace_back(std::move(pChunk));
+	Chunk& newChunk{ *m_pChunks.back() };
+
+	// Find the first free slot in the probe sequence
+	const uint64_t key{ PackPosition(newChunk.position.x, newChunk.position.y) };
+	const size_t mask{ m_Slots.size() - 1 };
+	size_t slotIdx{ Hash(key) & mask };
+	while (m_Slots[slotIdx].chunkIdx >= 0)
+	{
+		slotIdx = (slotIdx + 1) & mask;
+	}
+
+	m_Slots[slotIdx].key = key;
+	m_Slots[slotIdx].chunkIdx = static_cast<int>(m_pChunks.size()) - 1;
+
+	return newChunk;
+}
+
+void ChunkMap::Erase(const XMINT2& chunkPosition)
+{
+	const int erasedSlotIdx{ FindSlot(PackPosition(chunkPosition.x, chunkPosition.y)) };
+	if (erasedSlotIdx < 0) return;
+
+	const int chunkIdx{ m_Slots[erasedSlotIdx].chunkIdx };
+	const int lastChunkIdx{ static_cast<int>(m_pChunks.size()) - 1 };
+
+	// Move the last chunk into the hole and point its slot to the new index
+	if (chunkIdx != lastChunkIdx)
+	{
+		const Chunk& lastChunk{ *m_pChunks[lastChunkIdx] };
+		m_Slots[FindSlot(PackPosition(lastChunk.position.x, lastChunk.position.y))].chunkIdx = chunkIdx;
+
+		std::swap(m_pChunks[chunkIdx], m_pChunks[lastChunkIdx]);
+	}
+	if (m_pPool) m_pPool->Release(std::move(m_pChunks.back()));
+	m_pChunks.pop_back();
+
+	// Backward shift deletion: pull every following entry of the cluster into the hole
+	//	if its ideal slot isn't located cyclically between the hole and itself
+	const size_t mask{ m_Slots.size() - 1 };
+	size_t holeIdx{ static_cast<size_t>(erasedSlotIdx) };
+	size_t slotIdx{ holeIdx };
+	while (true)
+	{
+		slotIdx = (slotIdx + 1) & mask;
+
+		const Slot& slot{ m_Slots[slotIdx] };
+		if (slot.chunkIdx < 0) break;
+
+		const size_t idealIdx{ Hash(slot.key) & mask };
+		const bool idealBetween{ holeIdx <= slotIdx ? (holeIdx < idealIdx && idealIdx <= slotIdx) : (holeIdx < idealIdx || idealIdx <= slotIdx) };
+		if (idealBetween) continue;
+
+		m_Slots[holeIdx] = slot;
+		holeIdx = slotIdx;
+	}
+
+	m_Slots[holeIdx] = Slot{};
+}
+
+void ChunkMap::Reserve(int nrChunks)
+{
+	size_t nrSlots{ 16 };
+	while (nrSlots < static_cast<size_t>(nrChunks) * 2) nrSlots *= 2;
+
+	if (nrSlots > m_Slots.size()) Rehash(nrSlots);
+
+	m_pChunks.reserve(nrChunks);
+}
+
+uint64_t ChunkMap::PackPosition(int chunkX, int chunkY)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY);
+}
+
+size_t ChunkMap::Hash(uint64_t key)
+{
+	// 64 bit finalizer of MurmurHash3, neighbouring chunks end up in unrelated slots
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+
+	return static_cast<size_t>(key);
+}
+
+int ChunkMap::FindSlot(uint64_t key) const
+{
+	if (m_Slots.empty()) return -1;
+
+	const size_t mask{ m_Slots.size() - 1 };
+
+	// Linear probe until the key or an empty slot is found
+	for (size_t slotIdx{ Hash(key) & mask }; ; slotIdx = (slotIdx + 1) & mask)
+	{
+		const Slot& slot{ m_Slots[slotIdx] };
+
+		if (slot.chunkIdx < 0) return -1;
+		if (slot.key == key) return static_cast<int>(slotIdx);
+	}
+}
+
+void ChunkMap::Rehash(size_t nrSlots)
+{
+	m_Slots.assign(nrSlots, Slot{});
+
+	const size_t mask{ nrSlots - 1 };
+
+	// Re-insert every chunk in the new table
+	for (int i{}; i < static_cast<int>(m_pChunks.size()); ++i)
+	{
+		const Chunk& chunk{ *m_pChunks[i] };
+		const uint64_t key{ PackPosition(chunk.position.x, chunk.position.y) };
+
+		size_t slotIdx{ Hash(key) & mask };
+		while (m_Slots[slotIdx].chunkIdx >= 0)
+		{
+			slotIdx = (slotIdx + 1) & mask;
+		}
+
+		m_Slots[slotIdx].key = key;
+		m_Slots[slotIdx].chunkIdx = i;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "Chunk.h"
+#include "ChunkPool.h"
+
+#include <memory>
+#include <vector>
+
+class ChunkMap final
+{
+public:
+	class Iterator final
+	{
+	public:
+		using BaseIterator = std::vector<std::unique_ptr<Chunk>>::const_iterator;
+
+		Iterator(BaseIterator it) : m_It{ it } {}
+
+		Chunk& operator*() const { return **m_It; }
+		Chunk* operator->() const { return m_It->get(); }
+		Iterator& operator++() { ++m_It; return *this; }
+		bool operator==(const Iterator& other) const { return m_It == other.m_It; }
+		bool operator!=(const Iterator& other) const { return m_It != other.m_It; }
+	private:
+		BaseIterator m_It;
+	};
+
+	ChunkMap() = default;
+	~ChunkMap() = default;
+
+	ChunkMap(const ChunkMap& other) = delete;
+	ChunkMap(ChunkMap&& other) noexcept = delete;
+	ChunkMap& operator=(const ChunkMap& other) = delete;
+	ChunkMap& operator=(ChunkMap&& other) noexcept = delete;
+
+	// Returns the chunk with this chunk position or nullptr if it isn't loaded
+	// The returned pointer stays valid until this chunk itself is erased
+	Chunk* Find(int chunkX, int chunkY) const;
+	Chunk* Find(const XMINT2& chunkPosition) const { return Find(chunkPosition.x, chunkPosition.y); }
+
+	Chunk& Insert(Chunk&& chunk);
+	Chunk& Insert(std::unique_ptr<Chunk> pChunk);
+	void Erase(const XMINT2& chunkPosition);
+	template<typename Predicate>
+	void EraseIf(Predicate predicate);
+
+	// Erased and overwritten chunks are given back to this pool instead of being destroyed
+	void SetPool(ChunkPool* pPool) { m_pPool = pPool; }
+
+	// Makes sure the table can hold this amount of chunks without rehashing
+	void Reserve(int nrChunks);
+
+	int Size() const { return static_cast<int>(m_pChunks.size()); }
+	bool Empty() const { return m_pChunks.empty(); }
+
+	Iterator begin() const { return Iterator{ m_pChunks.cbegin() }; }
+	Iterator end() const { return Iterator{ m_pChunks.cend() }; }
+
+private:
+	struct Slot
+	{
+		uint64_t key{};
+		int chunkIdx{ -1 };
+	};
+
+	static uint64_t PackPosition(int chunkX, int chunkY);
+	static size_t Hash(uint64_t key);
+
+	int FindSlot(uint64_t key) const;
+	void Rehash(size_t nrSlots);
+
+	std::vector<Slot> m_Slots{};
+	std::vector<std::unique_ptr<Chunk>> m_pChunks{};
+	ChunkPool* m_pPool{};
+};
+
+template<typename Predicate>
+void ChunkMap::EraseIf(Predicate predicate)
+{
+	// Walk backwards so that erasing (which swaps the last chunk into the hole) doesn't skip chunks
+	for (int i{ static_cast<int>(m_pChunks.size()) - 1 }; i >= 0; --i)
+	{
+		Chunk& chunk{ *m_pChunks[i] };
+		if (predicate(chunk)) Erase(chunk.position);
+	}
+}
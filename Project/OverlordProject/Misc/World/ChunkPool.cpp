@@ -0,0 +1,58 @@
+#include "stdafx.h"
+#include "ChunkPool.h"
+
+std::unique_ptr<Chunk> ChunkPool::Acquire()
+{
+	std::unique_ptr<Chunk> pChunk{};
+
+	if (m_pFreeChunks.empty())
+	{
+		// The pool is empty, so a new chunk has to be created
+		pChunk = std::make_unique<Chunk>();
+		++m_Stats.nrAllocated;
+	}
+	else
+	{
+		// Reuse the last released chunk
+		pChunk = std::move(m_pFreeChunks.back());
+		m_pFreeChunks.pop_back();
+		++m_Stats.nrRecycled;
+	}
+
+	// Update the occupancy
+	++m_Stats.nrInUse;
+	m_Stats.nrFree = static_cast<int>(m_pFreeChunks.size());
+	m_Stats.highWaterMark = std::max(m_Stats.highWaterMark, m_Stats.nrInUse);
+
+	return pChunk;
+}
+
+void ChunkPool::Release(std::unique_ptr<Chunk> pChunk)
+{
+	if (!pChunk) return;
+
+	// Clear the chunk without releasing the memory of its containers
+	pChunk->Reset();
+
+	m_pFreeChunks.emplace_back(std::move(pChunk));
+
+	// Update the occupancy
+	--m_Stats.nrInUse;
+	m_Stats.nrFree = static_cast<int>(m_pFreeChunks.size());
+}
+
+void ChunkPool::Reserve(int nrChunks)
+{
+	const int nrFreeNeeded{ nrChunks - m_Stats.nrInUse };
+	if (nrFreeNeeded <= 0) return;
+
+	// Create new chunks until there are enough free chunks
+	m_pFreeChunks.reserve(nrFreeNeeded);
+	while (static_cast<int>(m_pFreeChunks.size()) < nrFreeNeeded)
+	{
+		m_pFreeChunks.emplace_back(std::make_unique<Chunk>());
+		++m_Stats.nrAllocated;
+	}
+
+	m_Stats.nrFree = static_cast<int>(m_pFreeChunks.size());
+}
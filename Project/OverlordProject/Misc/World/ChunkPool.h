@@ -0,0 +1,42 @@
+#pragma once
+#include "Chunk.h"
+
+#include <memory>
+#include <vector>
+
+// Keeps unloaded chunks around so their block storage and vertex vectors can be reused by new chunks
+// A pool is not thread safe, every thread that creates chunks should use its own pool
+class ChunkPool final
+{
+public:
+	struct Stats
+	{
+		int nrInUse{};
+		int nrFree{};
+		int highWaterMark{}; // The highest amount of chunks that were in use at the same time
+		int nrAllocated{}; // Chunks that had to be created because the pool was empty
+		int nrRecycled{}; // Chunks that were handed out again after being released
+	};
+
+	ChunkPool() = default;
+	~ChunkPool() = default;
+
+	ChunkPool(const ChunkPool& other) = delete;
+	ChunkPool(ChunkPool&& other) noexcept = delete;
+	ChunkPool& operator=(const ChunkPool& other) = delete;
+	ChunkPool& operator=(ChunkPool&& other) noexcept = delete;
+
+	// Returns an empty chunk, recycled from the pool if possible
+	std::unique_ptr<Chunk> Acquire();
+	// Clears the chunk and keeps it for the next Acquire, the meshes of the chunk have to be freed by their owner first
+	void Release(std::unique_ptr<Chunk> pChunk);
+
+	// Makes sure this amount of chunks can be in use at the same time without creating new chunks
+	void Reserve(int nrChunks);
+
+	const Stats& GetStats() const { return m_Stats; }
+
+private:
+	std::vector<std::unique_ptr<Chunk>> m_pFreeChunks{};
+	Stats m_Stats{};
+};
@@ -0,0 +1,248 @@
+#include "ChunkSection.h"
+
+#include <algorithm>
+
+BlockType ChunkSection::GetBlock(int x, int y, int z) const
+{
+	// Uniform sections don't have any indices
+	if (IsUniform()) return m_Palette[0];
+
+	return m_Palette[GetPaletteIdx(GetBlockIdx(x, y, z))];
+}
+
+uint32_t ChunkSection::GetRowBits(int y, int z, const bool* pIsMarked) const
+{
+	// Uniform sections mark the whole row or nothing
+	if (IsUniform()) return pIsMarked[static_cast<int>(m_Palette[0])] ? (1U << Size) - 1 : 0U;
+
+	const int firstBlockIdx{ GetBlockIdx(0, y, z) };
+
+	uint32_t bits{};
+	for (int x{}; x < Size; ++x)
+	{
+		if (pIsMarked[static_cast<int>(m_Palette[GetPaletteIdx(firstBlockIdx + x)])]) bits |= 1U << x;
+	}
+
+	return bits;
+}
+
+void ChunkSection::GetRowBits(const bool* pIsMarked, uint32_t* pRows) const
+{
+	constexpr int nrRows{ Size * Size };
+
+	// Uniform sections mark every row or nothing
+	if (IsUniform())
+	{
+		std::fill(pRows, pRows + nrRows, pIsMarked[static_cast<int>(m_Palette[0])] ? (1U << Size) - 1 : 0U);
+		return;
+	}
+
+	// Mark the palette entries once, so every block only needs its index
+	bool isPaletteMarked[UINT8_MAX + 1]{};
+	for (size_t i{}; i < m_Palette.size(); ++i) isPaletteMarked[i] = pIsMarked[static_cast<int>(m_Palette[i])];
+
+	// The indices of all blocks are read in order
+	const uint64_t mask{ (1ULL << m_BitsPerBlock) - 1 };
+	int bitIdx{};
+	for (int rowIdx{}; rowIdx < nrRows; ++rowIdx)
+	{
+		uint32_t bits{};
+		for (int x{}; x < Size; ++x, bitIdx += m_BitsPerBlock)
+		{
+			if (isPaletteMarked[(m_Indices[bitIdx >> 6] >> (bitIdx & 63)) & mask]) bits |= 1U << x;
+		}
+
+		pRows[rowIdx] = bits;
+	}
+}
+
+void ChunkSection::SetBlock(int x, int y, int z, BlockType block)
+{
+	// Find the block type in the palette
+	int paletteIdx{};
+	const int paletteSize{ static_cast<int>(m_Palette.size()) };
+	while (paletteIdx < paletteSize && m_Palette[paletteIdx] != block) ++paletteIdx;
+
+	if (paletteIdx == paletteSize)
+	{
+		// Add the new block type to the palette
+		m_Palette.push_back(block);
+
+		// If the indices can't address the new palette anymore, repack them with more bits
+		const int bitsPerBlock{ GetBitsPerBlock(static_cast<int>(m_Palette.size())) };
+		if (bitsPerBlock != m_BitsPerBlock) Repack(bitsPerBlock, {});
+	}
+	// Nothing changes if the block is the same as the rest of the section
+	else if (IsUniform()) return;
+
+	SetPaletteIdx(GetBlockIdx(x, y, z), paletteIdx);
+}
+
+void ChunkSection::Compact()
+{
+	if (IsUniform()) return;
+
+	// Count how many times every palette entry is used
+	std::vector<int> usage(m_Palette.size());
+	for (int blockIdx{}; blockIdx < Volume; ++blockIdx)
+	{
+		++usage[GetPaletteIdx(blockIdx)];
+	}
+
+	// Create a palette with only the used block types
+	std::vector<BlockType> palette{};
+	std::vector<int> paletteRemap(m_Palette.size(), -1);
+	for (size_t i{}; i < m_Palette.size(); ++i)
+	{
+		if (usage[i] == 0) continue;
+
+		paletteRemap[i] = static_cast<int>(palette.size());
+		palette.push_back(m_Palette[i]);
+	}
+
+	// If every block type is still used, there is nothing to compact
+	if (palette.size() == m_Palette.size()) return;
+
+	Repack(GetBitsPerBlock(static_cast<int>(palette.size())), paletteRemap);
+	m_Palette = std::move(palette);
+}
+
+void ChunkSection::Serialize(std::vector<uint8_t>& buffer) const
+{
+	// Write the palette
+	buffer.push_back(static_cast<uint8_t>(m_Palette.size()));
+	for (BlockType block : m_Palette) buffer.push_back(static_cast<uint8_t>(block));
+
+	// Uniform sections don't have any indices
+	if (IsUniform()) return;
+
+	// Write every run of equal indices as the palette index followed by the length of the run
+	int blockIdx{};
+	while (blockIdx < Volume)
+	{
+		const int paletteIdx{ GetPaletteIdx(blockIdx) };
+
+		int runLength{ 1 };
+		while (blockIdx + runLength < Volume && GetPaletteIdx(blockIdx + runLength) == paletteIdx) ++runLength;
+
+		buffer.push_back(static_cast<uint8_t>(paletteIdx));
+		buffer.push_back(static_cast<uint8_t>(runLength & 0xFF));
+		buffer.push_back(static_cast<uint8_t>(runLength >> 8));
+
+		blockIdx += runLength;
+	}
+}
+
+bool ChunkSection::Deserialize(const uint8_t*& pData, const uint8_t* pDataEnd)
+{
+	// Read the palette
+	if (pData >= pDataEnd) return false;
+	const int paletteSize{ *pData++ };
+	if (paletteSize == 0 || pDataEnd - pData < paletteSize) return false;
+
+	m_Palette.assign(reinterpret_cast<const BlockType*>(pData), reinterpret_cast<const BlockType*>(pData) + paletteSize);
+	pData += paletteSize;
+
+	// Uniform sections don't have any indices
+	m_BitsPerBlock = GetBitsPerBlock(paletteSize);
+	if (IsUniform())
+	{
+		std::vector<uint64_t>{}.swap(m_Indices);
+		return true;
+	}
+
+	m_Indices.assign(Volume * m_BitsPerBlock / 64, 0);
+
+	// Read the runs until every block has been filled in
+	int blockIdx{};
+	while (blockIdx < Volume)
+	{
+		if (pDataEnd - pData < 3) return false;
+
+		const int paletteIdx{ pData[0] };
+		const int runLength{ pData[1] | pData[2] << 8 };
+		pData += 3;
+
+		if (paletteIdx >= paletteSize || runLength == 0 || blockIdx + runLength > Volume) return false;
+
+		for (int i{}; i < runLength; ++i) SetPaletteIdx(blockIdx + i, paletteIdx);
+		blockIdx += runLength;
+	}
+
+	return true;
+}
+
+void ChunkSection::Reset()
+{
+	m_Palette.assign(1, BlockType::AIR);
+	m_Indices.clear();
+	m_BitsPerBlock = 0;
+}
+
+int ChunkSection::GetBitsPerBlock(int paletteSize)
+{
+	// Only use bit sizes that divide 64, so an index never spans two words
+	if (paletteSize <= 1) return 0;
+	if (paletteSize <= 2) return 1;
+	if (paletteSize <= 4) return 2;
+	if (paletteSize <= 16) return 4;
+	return 8;
+}
+
+int ChunkSection::GetPaletteIdx(int blockIdx, int bitsPerBlock) const
+{
+	const int bitIdx{ blockIdx * bitsPerBlock };
+	const uint64_t mask{ (1ULL << bitsPerBlock) - 1 };
+
+	return static_cast<int>((m_Indices[bitIdx >> 6] >> (bitIdx & 63)) & mask);
+}
+
+void ChunkSection::SetPaletteIdx(int blockIdx, int paletteIdx, int bitsPerBlock)
+{
+	const int bitIdx{ blockIdx * bitsPerBlock };
+	const uint64_t mask{ (1ULL << bitsPerBlock) - 1 };
+
+	uint64_t& word{ m_Indices[bitIdx >> 6] };
+	word = (word & ~(mask << (bitIdx & 63))) | (static_cast<uint64_t>(paletteIdx) << (bitIdx & 63));
+}
+
+void ChunkSection::Repack(int bitsPerBlock, const std::vector<int>& paletteRemap)
+{
+	// A uniform section doesn't need any indices anymore, so give the memory back
+	if (bitsPerBlock == 0)
+	{
+		std::vector<uint64_t>{}.swap(m_Indices);
+		m_BitsPerBlock = 0;
+		return;
+	}
+
+	const int oldBitsPerBlock{ m_BitsPerBlock };
+	const bool isGrowing{ bitsPerBlock > oldBitsPerBlock };
+
+	// The indices are repacked in place, so memory that is already reserved gets reused
+	if (isGrowing) m_Indices.resize(Volume * bitsPerBlock / 64);
+
+	// Copy every index into the new size, remapping it to the new palette if needed
+	// Growing indices are copied back to front and shrinking indices front to back,
+	//	this way an index is never overwritten before it has been read
+	const auto repackIdx = [&](int blockIdx)
+	{
+		int paletteIdx{ oldBitsPerBlock == 0 ? 0 : GetPaletteIdx(blockIdx, oldBitsPerBlock) };
+		if (!paletteRemap.empty()) paletteIdx = paletteRemap[paletteIdx];
+
+		SetPaletteIdx(blockIdx, paletteIdx, bitsPerBlock);
+	};
+
+	if (isGrowing)
+	{
+		for (int blockIdx{ Volume - 1 }; blockIdx >= 0; --blockIdx) repackIdx(blockIdx);
+	}
+	else
+	{
+		for (int blockIdx{}; blockIdx < Volume; ++blockIdx) repackIdx(blockIdx);
+
+		m_Indices.resize(Volume * bitsPerBlock / 64);
+	}
+
+	m_BitsPerBlock = bitsPerBlock;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "WorldData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A 16x16x16 part of a chunk
+// Blocks are stored as indices into a small palette of the block types in this section,
+//	packed with as few bits as the palette size allows
+// Sections that only contain one block type (mostly air) don't store any indices
+class ChunkSection final
+{
+public:
+	static constexpr int Size{ 16 };
+	static constexpr int Volume{ Size * Size * Size };
+
+	BlockType GetBlock(int x, int y, int z) const;
+	void SetBlock(int x, int y, int z, BlockType block);
+	// Returns one bit per block along x in this row, set when the table marks the type of the block
+	//	the table is indexed by block type
+	uint32_t GetRowBits(int y, int z, const bool* pIsMarked) const;
+	// Writes the bits of all Size * Size rows of the section, ordered by y and then z
+	void GetRowBits(const bool* pIsMarked, uint32_t* pRows) const;
+
+	bool IsUniform() const { return m_BitsPerBlock == 0; }
+	bool IsEmpty() const { return IsUniform() && m_Palette[0] == BlockType::AIR; }
+	BlockType GetUniformBlock() const { return m_Palette[0]; }
+	const std::vector<BlockType>& GetPalette() const { return m_Palette; }
+
+	// Removes block types that aren't used anymore from the palette and packs the indices with the smallest size possible
+	void Compact();
+	// Makes the section empty again, but keeps the memory of the indices so it can be reused
+	void Reset();
+
+	// Appends the section to the buffer, runs of the same block are stored once
+	void Serialize(std::vector<uint8_t>& buffer) const;
+	// Reads a section that was written by Serialize and moves the data pointer past it
+	// Returns false if the data isn't a valid section
+	bool Deserialize(const uint8_t*& pData, const uint8_t* pDataEnd);
+
+	size_t GetMemorySize() const { return m_Indices.capacity() * sizeof(uint64_t) + m_Palette.capacity() * sizeof(BlockType); }
+
+private:
+	static int GetBlockIdx(int x, int y, int z) { return x + z * Size + y * Size * Size; }
+	static int GetBitsPerBlock(int paletteSize);
+
+	int GetPaletteIdx(int blockIdx) const { return GetPaletteIdx(blockIdx, m_BitsPerBlock); }
+	int GetPaletteIdx(int blockIdx, int bitsPerBlock) const;
+	void SetPaletteIdx(int blockIdx, int paletteIdx) { SetPaletteIdx(blockIdx, paletteIdx, m_BitsPerBlock); }
+	void SetPaletteIdx(int blockIdx, int paletteIdx, int bitsPerBlock);
+	void Repack(int bitsPerBlock, const std::vector<int>& paletteRemap);
+
+	std::vector<BlockType> m_Palette{ BlockType::AIR };
+	std::vector<uint64_t> m_Indices{};
+	int m_BitsPerBlock{};
+};
@@ -0,0 +1,57 @@
+#include "ChunkSerializer.h"
+
+#include "Chunk.h"
+
+void ChunkSerializer::Serialize(const Chunk& chunk, std::vector<uint8_t>& buffer)
+{
+	// Write the version, the block sections and the fluid sections
+	buffer.push_back(m_Version);
+
+	buffer.push_back(static_cast<uint8_t>(chunk.sections.size()));
+	for (const ChunkSection& section : chunk.sections) section.Serialize(buffer);
+
+	// Chunks without fluids don't store any fluid sections
+	buffer.push_back(static_cast<uint8_t>(chunk.fluidSections.size()));
+	for (const ChunkSection& section : chunk.fluidSections) section.Serialize(buffer);
+}
+
+bool ChunkSerializer::Deserialize(Chunk& chunk, const uint8_t* pData, size_t dataSize)
+{
+	const uint8_t* pDataEnd{ pData + dataSize };
+
+	// If reading fails halfway, the chunk is cleared again so it can be generated instead
+	const auto failRead{ [&]()
+		{
+			for (ChunkSection& section : chunk.sections) section.Reset();
+			chunk.fluidSections.clear();
+			return false;
+		} };
+
+	// Chunks of another version or another world height can't be read
+	if (dataSize < 2 || pData[0] != m_Version || pData[1] != static_cast<uint8_t>(chunk.sections.size())) return false;
+	pData += 2;
+
+	// Read the block sections
+	for (ChunkSection& section : chunk.sections)
+	{
+		if (!section.Deserialize(pData, pDataEnd)) return failRead();
+	}
+
+	// Read the fluid sections
+	if (pData >= pDataEnd) return failRead();
+	const size_t nrFluidSections{ *pData++ };
+	if (nrFluidSections > 0)
+	{
+		if (nrFluidSections != chunk.sections.size()) return failRead();
+
+		chunk.fluidSections.resize(nrFluidSections);
+		for (ChunkSection& section : chunk.fluidSections)
+		{
+			if (!section.Deserialize(pData, pDataEnd)) return failRead();
+		}
+	}
+
+	chunk.UpdateSectionBits();
+
+	return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Chunk;
+
+// Converts the blocks and fluids of a chunk to bytes and back
+class ChunkSerializer final
+{
+public:
+	ChunkSerializer() = default;
+	~ChunkSerializer() = default;
+	ChunkSerializer(const ChunkSerializer& other) = delete;
+	ChunkSerializer(ChunkSerializer&& other) noexcept = delete;
+	ChunkSerializer& operator=(const ChunkSerializer& other) = delete;
+	ChunkSerializer& operator=(ChunkSerializer&& other) noexcept = delete;
+
+	// Appends the block sections and the fluid sections of the chunk to the buffer
+	static void Serialize(const Chunk& chunk, std::vector<uint8_t>& buffer);
+	// Fills the sections of the chunk with serialized data, the sections should already be sized for the world height
+	// Returns false and leaves the chunk empty if the data can't be read
+	static bool Deserialize(Chunk& chunk, const uint8_t* pData, size_t dataSize);
+
+private:
+	static constexpr uint8_t m_Version{ 1 };
+};
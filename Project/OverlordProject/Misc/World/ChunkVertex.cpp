@@ -0,0 +1,134 @@
+#include "stdafx.h"
+#include "ChunkVertex.h"
+
+#include "Managers/BlockManager.h"
+#include "QuadMesh.h"
+
+ChunkVertex::ChunkVertex(const XMINT3& cell, int faceIdx, int cornerIdx, FaceType tile, const XMINT2& faceUV, bool isLoweredTop)
+{
+	packedPosition =
+		(static_cast<uint32_t>(cell.x) & XMask) |
+		(static_cast<uint32_t>(cell.y) & YMask) << YShift |
+		(static_cast<uint32_t>(cell.z) & ZMask) << ZShift |
+		(static_cast<uint32_t>(faceIdx) & FaceMask) << FaceShift |
+		(static_cast<uint32_t>(cornerIdx) & CornerMask) << CornerShift |
+		static_cast<uint32_t>(isLoweredTop) << LoweredTopShift;
+
+	packedTexture =
+		(static_cast<uint32_t>(tile) & TileMask) |
+		(static_cast<uint32_t>(faceUV.x) & UVMask) << UShift |
+		(static_cast<uint32_t>(faceUV.y) & UVMask) << VShift;
+}
+
+XMINT3 ChunkVertex::GetCell() const
+{
+	return XMINT3
+	{
+		static_cast<int>(packedPosition & XMask),
+		static_cast<int>((packedPosition >> YShift) & YMask),
+		static_cast<int>((packedPosition >> ZShift) & ZMask)
+	};
+}
+
+XMINT2 ChunkVertex::GetFaceUV() const
+{
+	return XMINT2
+	{
+		static_cast<int>((packedTexture >> UShift) & UVMask),
+		static_cast<int>((packedTexture >> VShift) & UVMask)
+	};
+}
+
+XMFLOAT3 ChunkVertex::GetLocalPosition() const
+{
+	const XMINT3 cell{ GetCell() };
+	const XMFLOAT4& offset{ GetFaceData().cornerOffsets[GetFaceIdx() * NrCorners + GetCornerIdx()] };
+
+	return XMFLOAT3
+	{
+		static_cast<float>(cell.x) + offset.x,
+		static_cast<float>(cell.y) + offset.y - (IsLoweredTop() ? LoweredTopOffset : 0.0f),
+		static_cast<float>(cell.z) + offset.z
+	};
+}
+
+BoundingBox ChunkVertex::GetBounds(const std::vector<ChunkVertex>* pVertexLists, size_t nrLists)
+{
+	XMVECTOR boundsMin{ XMVectorReplicate(FLT_MAX) };
+	XMVECTOR boundsMax{ XMVectorReplicate(-FLT_MAX) };
+	bool hasVertices{};
+
+	for (size_t listIdx{}; listIdx < nrLists; ++listIdx)
+	{
+		for (const ChunkVertex& v : pVertexLists[listIdx])
+		{
+			const XMFLOAT3 localPosition{ v.GetLocalPosition() };
+			const XMVECTOR position{ XMLoadFloat3(&localPosition) };
+			boundsMin = XMVectorMin(boundsMin, position);
+			boundsMax = XMVectorMax(boundsMax, position);
+			hasVertices = true;
+		}
+	}
+
+	BoundingBox bounds{ XMFLOAT3{}, XMFLOAT3{} };
+	if (hasVertices) BoundingBox::CreateFromPoints(bounds, boundsMin, boundsMax);
+
+	return bounds;
+}
+
+XMINT3 ChunkVertex::GetTemplateCell(const XMFLOAT3& templatePosition)
+{
+	// Block meshes are centered around the block, so the cell of the block goes from -0.5 to 0.5
+	return XMINT3
+	{
+		static_cast<int>(floorf(templatePosition.x + 0.5f)),
+		static_cast<int>(floorf(templatePosition.y + 0.5f)),
+		static_cast<int>(floorf(templatePosition.z + 0.5f))
+	};
+}
+
+const ChunkVertex::FaceData& ChunkVertex::GetFaceData()
+{
+	// Build the table once from the cube and cross meshes
+	static const FaceData faceData{ []()
+		{
+			FaceData data{};
+
+			BlockManager* pBlockManager{ BlockManager::Get() };
+			const auto& cubeVertices{ pBlockManager->GetVertices("cube") };
+			const auto& crossVertices{ pBlockManager->GetVertices("cross") };
+
+			for (int faceIdx{}; faceIdx < NrFaces; ++faceIdx)
+			{
+				const auto& templateVertices{ faceIdx < NrCubeFaces ? cubeVertices : crossVertices };
+				const int templateFaceIdx{ faceIdx < NrCubeFaces ? faceIdx : faceIdx - NrCubeFaces };
+				if (templateFaceIdx >= QuadMesh::GetNrQuads(templateVertices.size())) continue;
+				if (faceIdx >= NrCubeFaces) ++data.nrCrossFaces;
+
+				for (int cornerIdx{}; cornerIdx < NrCorners; ++cornerIdx)
+				{
+					const VertexPosNormTexTransparency& v{ templateVertices[templateFaceIdx * QuadMesh::NrVerticesPerQuad + cornerIdx] };
+
+					// Every corner of a face has the same normal
+					data.normals[faceIdx] = XMFLOAT4{ v.Normal.x, v.Normal.y, v.Normal.z, 0.0f };
+
+					// The offset is what the cell corner is missing to get to the vertex of the block mesh
+					const int tableIdx{ faceIdx * NrCorners + cornerIdx };
+					const XMINT3 cell{ GetTemplateCell(v.Position) };
+					data.cornerCells[tableIdx] = cell;
+					data.cornerUVs[tableIdx] = XMINT2{ static_cast<int>(lroundf(v.TexCoord.x)), static_cast<int>(lroundf(v.TexCoord.y)) };
+					data.cornerOffsets[tableIdx] = XMFLOAT4
+					{
+						v.Position.x - static_cast<float>(cell.x),
+						v.Position.y - static_cast<float>(cell.y),
+						v.Position.z - static_cast<float>(cell.z),
+						0.0f
+					};
+				}
+			}
+
+			return data;
+		}() };
+
+	return faceData;
+}
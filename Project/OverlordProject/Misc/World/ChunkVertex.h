@@ -0,0 +1,80 @@
+#pragma once
+#include "WorldData.h"
+
+#include <DirectXCollision.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A vertex of a chunk mesh packed in 8 bytes
+//	the position is a corner of a block cell relative to the chunk, the shader adds the origin of the chunk
+//	the face and corner index look up the normal and the offset of the vertex inside its cell
+//	the texture is the tile of the atlas and the position inside the face in blocks
+// The bit layout has to match UnpackPosition and UnpackTexture in World.fx
+struct ChunkVertex
+{
+	// Cube faces are in the order of FaceDirection, the faces of the cross mesh come after them
+	static constexpr int NrCubeFaces{ 6 };
+	static constexpr int NrFaces{ 8 };
+	static constexpr int NrCorners{ 4 };
+
+	// How far the top of a lowered face (the surface of water) is under the top of its block
+	static constexpr float LoweredTopOffset{ 0.125f };
+
+	// The normal of every face and the offset of every corner inside its cell, read from the block meshes
+	//	stored as float4 so they can be set as effect arrays directly
+	// The cell and the position inside the face of every corner are stored as well, so the mesher only has to add the block
+	struct FaceData
+	{
+		DirectX::XMFLOAT4 normals[NrFaces]{};
+		DirectX::XMFLOAT4 cornerOffsets[NrFaces * NrCorners]{};
+		DirectX::XMINT3 cornerCells[NrFaces * NrCorners]{};
+		DirectX::XMINT2 cornerUVs[NrFaces * NrCorners]{};
+		int nrCrossFaces{};
+	};
+
+	ChunkVertex() = default;
+	ChunkVertex(const DirectX::XMINT3& cell, int faceIdx, int cornerIdx, FaceType tile, const DirectX::XMINT2& faceUV, bool isLoweredTop);
+
+	DirectX::XMINT3 GetCell() const;
+	int GetFaceIdx() const { return static_cast<int>((packedPosition >> FaceShift) & FaceMask); }
+	int GetCornerIdx() const { return static_cast<int>((packedPosition >> CornerShift) & CornerMask); }
+	bool IsLoweredTop() const { return (packedPosition >> LoweredTopShift) & 1U; }
+
+	FaceType GetTile() const { return static_cast<FaceType>(packedTexture & TileMask); }
+	DirectX::XMINT2 GetFaceUV() const;
+
+	// The position of the vertex relative to the origin of its chunk
+	DirectX::XMFLOAT3 GetLocalPosition() const;
+
+	// The corner of the block cell that a vertex of a block mesh belongs to, 0 or 1 on every axis
+	static DirectX::XMINT3 GetTemplateCell(const DirectX::XMFLOAT3& templatePosition);
+	static const FaceData& GetFaceData();
+
+	// The box around the vertices of all lists relative to the chunk, an empty box at the origin if there are no vertices
+	static DirectX::BoundingBox GetBounds(const std::vector<ChunkVertex>* pVertexLists, size_t nrLists);
+
+	uint32_t packedPosition{};
+	uint32_t packedTexture{};
+
+private:
+	// Bits of the packed position
+	static constexpr uint32_t XMask{ 0x1F };
+	static constexpr uint32_t YShift{ 5 };
+	static constexpr uint32_t YMask{ 0x3FF };
+	static constexpr uint32_t ZShift{ 15 };
+	static constexpr uint32_t ZMask{ 0x1F };
+	static constexpr uint32_t FaceShift{ 20 };
+	static constexpr uint32_t FaceMask{ 0x7 };
+	static constexpr uint32_t CornerShift{ 23 };
+	static constexpr uint32_t CornerMask{ 0x3 };
+	static constexpr uint32_t LoweredTopShift{ 25 };
+
+	// Bits of the packed texture
+	static constexpr uint32_t TileMask{ 0xFF };
+	static constexpr uint32_t UShift{ 8 };
+	static constexpr uint32_t VShift{ 20 };
+	static constexpr uint32_t UVMask{ 0xFFF };
+};
+
+static_assert(sizeof(ChunkVertex) == 8, "Chunk vertices should stay packed in 8 bytes");
@@ -0,0 +1,169 @@
+#include "stdafx.h"
+#include "FaceMasks.h"
+
+#include "Chunk.h"
+#include "Managers/BlockManager.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+FaceMasks::FaceMasks()
+	: m_pIsOpaqueCube{ BlockManager::Get()->GetOpaqueCubeTable() }
+	, m_pIsCube{ BlockManager::Get()->GetCubeTable() }
+{
+}
+
+void FaceMasks::Build(const Chunk& chunk, const std::array<const Chunk*, 4>& pNeighbours, bool isFluidLayer, uint32_t sectionMask)
+{
+	constexpr int size{ ChunkSection::Size };
+
+	m_IsFluidLayer = isFluidLayer;
+
+	const int nrSections{ static_cast<int>(chunk.sections.size()) };
+	const int height{ nrSections * size };
+	m_NrRows = height * size;
+
+	// The padding above and below the world is never written, so it stays empty
+	if (m_CubeRows.size() != static_cast<size_t>(m_NrRows))
+	{
+		m_OccluderRows.assign(static_cast<size_t>((height + 2) * PaddedSize), 0U);
+		m_CubeRows.assign(static_cast<size_t>(m_NrRows), 0U);
+		m_VisibleRows.assign(static_cast<size_t>(NrFaces * m_NrRows), 0U);
+	}
+
+	const Chunk* pForward{ pNeighbours[static_cast<int>(FaceDirection::FORWARD)] };
+	const Chunk* pBack{ pNeighbours[static_cast<int>(FaceDirection::BACK)] };
+	const Chunk* pRight{ pNeighbours[static_cast<int>(FaceDirection::RIGHT)] };
+	const Chunk* pLeft{ pNeighbours[static_cast<int>(FaceDirection::LEFT)] };
+
+	// Only sections with blocks in this layer get meshed, the faces on their top and bottom also need the sections around them
+	const uint32_t meshBits{ (isFluidLayer ? chunk.fluidSectionBits : chunk.sectionBits) & sectionMask };
+	const uint32_t occluderBits{ meshBits | meshBits << 1 | meshBits >> 1 };
+	const std::vector<ChunkSection>& meshSections{ isFluidLayer ? chunk.fluidSections : chunk.sections };
+
+	uint32_t occluderRows[size * size]{};
+	for (int sectionIdx{}; sectionIdx < nrSections; ++sectionIdx)
+	{
+		const bool hasOccluders{ ((occluderBits >> sectionIdx) & 1U) != 0 };
+		const bool isMeshed{ ((meshBits >> sectionIdx) & 1U) != 0 };
+
+		// Read all rows of the section at once
+		if (hasOccluders) GetOccluderRows(chunk, sectionIdx, occluderRows);
+		if (isMeshed) meshSections[sectionIdx].GetRowBits(m_pIsCube, &m_CubeRows[GetRowIdx(sectionIdx * size, 0)]);
+
+		for (int y{ sectionIdx * size }; y < (sectionIdx + 1) * size; ++y)
+		{
+			// The rows of this chunk, with the blocks of the left and right neighbour on both ends
+			for (int z{}; z < size; ++z)
+			{
+				uint32_t row{};
+				if (hasOccluders)
+				{
+					row = occluderRows[GetRowIdx(y % size, z)] << 1;
+					if (pLeft && IsOccluder(*pLeft, size - 1, y, z)) row |= 1U;
+					if (pRight && IsOccluder(*pRight, 0, y, z)) row |= 1U << (size + 1);
+				}
+				m_OccluderRows[GetPaddedRowIdx(y, z)] = row;
+			}
+
+			// The rows before and after this chunk come from the back and forward neighbour
+			m_OccluderRows[GetPaddedRowIdx(y, -1)] = hasOccluders && pBack ? GetOccluderRow(*pBack, y, size - 1) << 1 : 0U;
+			m_OccluderRows[GetPaddedRowIdx(y, size)] = hasOccluders && pForward ? GetOccluderRow(*pForward, y, 0) << 1 : 0U;
+		}
+	}
+
+	// Every face direction reads the occluder rows next to the rows of blocks, in the order of FaceDirection
+	//	the shift moves the bit of the neighbour along x onto the bit of the block
+	struct FaceOffset
+	{
+		int y;
+		int z;
+		int shift;
+	};
+	constexpr FaceOffset faceOffsets[NrFaces]{ { 0, 1, 1 }, { 0, -1, 1 }, { 0, 0, 2 }, { 0, 0, 0 }, { 1, 0, 1 }, { -1, 0, 1 } };
+
+	for (int sectionIdx{}; sectionIdx < nrSections; ++sectionIdx)
+	{
+		if (!((meshBits >> sectionIdx) & 1U)) continue;
+
+		for (int y{ sectionIdx * size }; y < (sectionIdx + 1) * size; ++y)
+		{
+			for (int faceIdx{}; faceIdx < NrFaces; ++faceIdx)
+			{
+				const FaceOffset& offset{ faceOffsets[faceIdx] };
+				CreateVisibleRows(&m_OccluderRows[GetPaddedRowIdx(y + offset.y, offset.z)], &m_CubeRows[GetRowIdx(y, 0)],
+					&m_VisibleRows[faceIdx * m_NrRows + GetRowIdx(y, 0)], offset.shift, size);
+			}
+		}
+	}
+}
+
+uint32_t FaceMasks::GetOccluderRow(const Chunk& chunk, int y, int z) const
+{
+	const int sectionIdx{ y / ChunkSection::Size };
+	if (sectionIdx >= static_cast<int>(chunk.sections.size())) return 0U;
+
+	const int sectionY{ y % ChunkSection::Size };
+
+	// Blocks are only hidden by opaque cubes
+	if (!m_IsFluidLayer) return chunk.HasBlocksInSection(sectionIdx) ? chunk.sections[sectionIdx].GetRowBits(sectionY, z, m_pIsOpaqueCube) : 0U;
+
+	// Water is hidden by every cube, in the block layer and in the fluid layer
+	uint32_t row{ chunk.HasBlocksInSection(sectionIdx) ? chunk.sections[sectionIdx].GetRowBits(sectionY, z, m_pIsCube) : 0U };
+	if (chunk.HasFluidInSection(sectionIdx)) row |= chunk.fluidSections[sectionIdx].GetRowBits(sectionY, z, m_pIsCube);
+
+	return row;
+}
+
+void FaceMasks::GetOccluderRows(const Chunk& chunk, int sectionIdx, uint32_t* pRows) const
+{
+	constexpr int nrRows{ ChunkSection::Size * ChunkSection::Size };
+
+	// Blocks are only hidden by opaque cubes
+	if (!m_IsFluidLayer)
+	{
+		if (chunk.HasBlocksInSection(sectionIdx)) chunk.sections[sectionIdx].GetRowBits(m_pIsOpaqueCube, pRows);
+		else std::fill(pRows, pRows + nrRows, 0U);
+
+		return;
+	}
+
+	// Water is hidden by every cube, in the block layer and in the fluid layer
+	if (chunk.HasBlocksInSection(sectionIdx)) chunk.sections[sectionIdx].GetRowBits(m_pIsCube, pRows);
+	else std::fill(pRows, pRows + nrRows, 0U);
+
+	if (!chunk.HasFluidInSection(sectionIdx)) return;
+
+	uint32_t fluidRows[nrRows];
+	chunk.fluidSections[sectionIdx].GetRowBits(m_pIsCube, fluidRows);
+	for (int rowIdx{}; rowIdx < nrRows; ++rowIdx) pRows[rowIdx] |= fluidRows[rowIdx];
+}
+
+bool FaceMasks::IsOccluder(const Chunk& chunk, int x, int y, int z) const
+{
+	if (y / ChunkSection::Size >= static_cast<int>(chunk.sections.size())) return false;
+
+	if (!m_IsFluidLayer) return m_pIsOpaqueCube[static_cast<int>(chunk.GetBlock(x, y, z))];
+
+	return m_pIsCube[static_cast<int>(chunk.GetBlock(x, y, z))] || m_pIsCube[static_cast<int>(chunk.GetFluid(x, y, z))];
+}
+
+void FaceMasks::CreateVisibleRows(const uint32_t* pOccluders, const uint32_t* pCubes, uint32_t* pVisible, int shift, int nrRows)
+{
+	int rowIdx{};
+
+#if defined(_M_X64) || defined(__SSE2__)
+	// 4 rows at once, SSE2 is part of every x64 build
+	const __m128i shiftCount{ _mm_cvtsi32_si128(shift) };
+	for (; rowIdx + 4 <= nrRows; rowIdx += 4)
+	{
+		const __m128i occluders{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pOccluders + rowIdx)) };
+		const __m128i cubes{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pCubes + rowIdx)) };
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pVisible + rowIdx), _mm_andnot_si128(_mm_srl_epi32(occluders, shiftCount), cubes));
+	}
+#endif
+
+	// The rows that are left one by one
+	for (; rowIdx < nrRows; ++rowIdx) pVisible[rowIdx] = ~(pOccluders[rowIdx] >> shift) & pCubes[rowIdx];
+}
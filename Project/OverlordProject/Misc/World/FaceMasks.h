@@ -0,0 +1,67 @@
+#pragma once
+#include "ChunkSection.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+struct Chunk;
+
+// Finds the visible cube faces of every block in one layer of a chunk with bit operations
+//	every row of blocks along x is a bit mask, padded with the blocks of the neighbouring chunks on both sides
+//	a face is visible where the row next to it along the face direction has no occluder
+// Blocks of the block layer are hidden by opaque cubes, water in the fluid layer is hidden by any cube in either layer
+class FaceMasks final
+{
+public:
+	FaceMasks();
+	~FaceMasks() = default;
+
+	FaceMasks(const FaceMasks& other) = delete;
+	FaceMasks(FaceMasks&& other) noexcept = delete;
+	FaceMasks& operator=(const FaceMasks& other) = delete;
+	FaceMasks& operator=(FaceMasks&& other) noexcept = delete;
+
+	// The neighbours are in the order of FaceDirection (forward, back, right, left), missing chunks are nullptr
+	//	only the sections in the section mask are built, the faces of other sections keep whatever they held before
+	void Build(const Chunk& chunk, const std::array<const Chunk*, 4>& pNeighbours, bool isFluidLayer, uint32_t sectionMask);
+
+	// One bit per FaceDirection, only cube blocks have visible faces
+	uint8_t GetVisibleFaces(int x, int y, int z) const
+	{
+		const int rowIdx{ GetRowIdx(y, z) };
+
+		uint8_t faces{};
+		for (int faceIdx{}; faceIdx < NrFaces; ++faceIdx) faces |= static_cast<uint8_t>(((m_VisibleRows[faceIdx * m_NrRows + rowIdx] >> x) & 1U) << faceIdx);
+
+		return faces;
+	}
+	bool IsCube(int x, int y, int z) const { return (m_CubeRows[GetRowIdx(y, z)] >> x) & 1U; }
+
+private:
+	static constexpr int NrFaces{ 6 };
+	static constexpr int PaddedSize{ ChunkSection::Size + 2 };
+
+	static int GetRowIdx(int y, int z) { return y * ChunkSection::Size + z; }
+	// Rows of occluders have one extra row on every side, their bits are shifted by one for the block before the row
+	static int GetPaddedRowIdx(int y, int z) { return (y + 1) * PaddedSize + z + 1; }
+
+	// Writes the occluders of all rows of a section of this chunk
+	void GetOccluderRows(const Chunk& chunk, int sectionIdx, uint32_t* pRows) const;
+	uint32_t GetOccluderRow(const Chunk& chunk, int y, int z) const;
+	bool IsOccluder(const Chunk& chunk, int x, int y, int z) const;
+
+	// Writes ~(occluders >> shift) & cubes for a number of rows
+	static void CreateVisibleRows(const uint32_t* pOccluders, const uint32_t* pCubes, uint32_t* pVisible, int shift, int nrRows);
+
+	// Which block types hide faces and which block types have faces, the tables of the block manager
+	const bool* m_pIsOpaqueCube{};
+	const bool* m_pIsCube{};
+
+	bool m_IsFluidLayer{};
+	int m_NrRows{};
+
+	std::vector<uint32_t> m_OccluderRows{};
+	std::vector<uint32_t> m_CubeRows{};
+	std::vector<uint32_t> m_VisibleRows{};
+};
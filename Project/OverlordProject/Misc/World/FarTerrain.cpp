@@ -0,0 +1,191 @@
+#include "stdafx.h"
+#include "FarTerrain.h"
+
+#include "TileAtlas.h"
+#include "WorldGenerator.h"
+
+FarTerrain::FarTerrain(const WorldGenerator& generator, JobSystem& jobSystem)
+	: m_Generator{ generator }
+	, m_JobSystem{ jobSystem }
+{
+}
+
+FarTerrain::~FarTerrain()
+{
+	// The jobs that are still building a tile push their result into this object
+	m_JobSystem.Wait(m_BuildBatch);
+
+	for (auto& [key, tile] : m_Tiles) SafeRelease(tile.pVertexBuffer);
+}
+
+void FarTerrain::Update(const XMINT2& chunkCenter, const SceneContext& sceneContext)
+{
+	// Create the buffers of the tiles that the jobs have built
+	BuiltTile builtTile{};
+	while (m_BuiltTiles.Pop(builtTile))
+	{
+		--m_NrBuildingTiles;
+
+		Tile& tile{ m_Tiles[PackPosition(builtTile.position.x, builtTile.position.y)] };
+		tile.isBuilding = false;
+		tile.bounds = builtTile.bounds;
+		CreateVertexBuffer(builtTile.vertices, tile.pVertexBuffer, sceneContext);
+	}
+
+	const XMINT2 centerTile{ GetTileCoordinate(chunkCenter.x), GetTileCoordinate(chunkCenter.y) };
+	const int tileDistance{ (m_Distance + TileSize - 1) / TileSize };
+
+	// Release the tiles that are out of range, the ring just outside the range is kept so walking back and forth doesn't rebuild it
+	//	tiles that are still building are released once they are built
+	const int keepDistance{ m_Distance > 0 ? tileDistance + 1 : -1 };
+	for (auto it{ m_Tiles.begin() }; it != m_Tiles.end();)
+	{
+		Tile& tile{ it->second };
+		const int distance{ std::max(abs(tile.position.x - centerTile.x), abs(tile.position.y - centerTile.y)) };
+		if (tile.isBuilding || distance <= keepDistance)
+		{
+			++it;
+			continue;
+		}
+
+		SafeRelease(tile.pVertexBuffer);
+		it = m_Tiles.erase(it);
+	}
+
+	if (m_Distance == 0) return;
+
+	// Build the missing tiles closest to the center first
+	//	only a few tiles are built at once, so the far terrain doesn't hold up the chunks on the job system
+	const int maxBuildingTiles{ m_JobSystem.GetNrWorkers() };
+	for (int ring{}; ring <= tileDistance; ++ring)
+	{
+		for (int y{ -ring }; y <= ring; ++y)
+		{
+			for (int x{ -ring }; x <= ring; ++x)
+			{
+				if (std::max(abs(x), abs(y)) != ring) continue;
+
+				if (m_NrBuildingTiles >= maxBuildingTiles) return;
+
+				const XMINT2 tilePosition{ centerTile.x + x, centerTile.y + y };
+				if (m_Tiles.find(PackPosition(tilePosition.x, tilePosition.y)) != m_Tiles.end()) continue;
+
+				StartBuildingTile(tilePosition);
+			}
+		}
+	}
+}
+
+void FarTerrain::CreateIndices(std::vector<uint32_t>& indices)
+{
+	constexpr uint32_t nrVerticesPerRow{ GridSize + 1 };
+
+	indices.reserve(indices.size() + GetNrIndices());
+	for (uint32_t z{}; z < GridSize; ++z)
+	{
+		for (uint32_t x{}; x < GridSize; ++x)
+		{
+			// The 2 triangles of a cell are clockwise when seen from above
+			const uint32_t corner{ z * nrVerticesPerRow + x };
+			const uint32_t cellIndices[]{ corner, corner + nrVerticesPerRow, corner + 1, corner + 1, corner + nrVerticesPerRow, corner + nrVerticesPerRow + 1 };
+			indices.insert(indices.end(), std::begin(cellIndices), std::end(cellIndices));
+		}
+	}
+}
+
+uint64_t FarTerrain::PackPosition(int tileX, int tileY)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(tileX)) << 32) | static_cast<uint32_t>(tileY);
+}
+
+int FarTerrain::GetTileCoordinate(int chunkCoordinate)
+{
+	return chunkCoordinate < 0 ? (chunkCoordinate + 1) / TileSize - 1 : chunkCoordinate / TileSize;
+}
+
+void FarTerrain::StartBuildingTile(const XMINT2& tilePosition)
+{
+	// The tile is already in the map, so it isn't started again before it is built
+	m_Tiles[PackPosition(tilePosition.x, tilePosition.y)] = Tile{ tilePosition, nullptr, {}, true };
+	++m_NrBuildingTiles;
+
+	m_JobSystem.Submit([this, tilePosition]()
+		{
+			BuiltTile builtTile{ tilePosition };
+			CreateTileVertices(tilePosition, builtTile.vertices, builtTile.bounds);
+			m_BuiltTiles.Push(std::move(builtTile));
+		}, &m_BuildBatch);
+}
+
+void FarTerrain::CreateTileVertices(const XMINT2& tilePosition, std::vector<Vertex>& vertices, BoundingBox& bounds) const
+{
+	const int tileWidth{ TileSize * m_Generator.GetChunkSize() };
+	const int spacing{ tileWidth / GridSize };
+	const XMINT2 origin{ tilePosition.x * tileWidth, tilePosition.y * tileWidth };
+
+	// Sample one extra row on every side, so the normals on the border of the tile are the same as the normals of the next tile
+	constexpr int nrSamples{ GridSize + 3 };
+	std::vector<float> heights(nrSamples * nrSamples);
+	std::vector<BlockType> blocks(nrSamples * nrSamples);
+	for (int sampleZ{}; sampleZ < nrSamples; ++sampleZ)
+	{
+		for (int sampleX{}; sampleX < nrSamples; ++sampleX)
+		{
+			const int sampleIdx{ sampleZ * nrSamples + sampleX };
+
+			// The height is the top of the highest block of the column
+			int surfaceY{};
+			blocks[sampleIdx] = m_Generator.GetSurfaceBlock(origin.x + (sampleX - 1) * spacing, origin.y + (sampleZ - 1) * spacing, surfaceY);
+			heights[sampleIdx] = static_cast<float>(surfaceY) + 0.5f;
+		}
+	}
+
+	vertices.reserve((GridSize + 1) * (GridSize + 1));
+	float minHeight{ FLT_MAX };
+	float maxHeight{ -FLT_MAX };
+	for (int z{}; z <= GridSize; ++z)
+	{
+		for (int x{}; x <= GridSize; ++x)
+		{
+			const int sampleIdx{ (z + 1) * nrSamples + x + 1 };
+
+			// The normal follows the slope between the samples around the vertex
+			const float slopeX{ heights[sampleIdx + 1] - heights[sampleIdx - 1] };
+			const float slopeZ{ heights[sampleIdx + nrSamples] - heights[sampleIdx - nrSamples] };
+			XMFLOAT3 normal{};
+			XMStoreFloat3(&normal, XMVector3Normalize(XMVectorSet(-slopeX, 2.0f * spacing, -slopeZ, 0.0f)));
+
+			const XMFLOAT3 position{ static_cast<float>(origin.x + x * spacing), heights[sampleIdx], static_cast<float>(origin.y + z * spacing) };
+			const FaceType tile{ TileAtlas::GetFaceType(blocks[sampleIdx], FaceDirection::UP) };
+
+			vertices.emplace_back(Vertex{ position, normal, static_cast<uint32_t>(tile) });
+
+			minHeight = std::min(minHeight, position.y);
+			maxHeight = std::max(maxHeight, position.y);
+		}
+	}
+
+	// The renderer skips the tile when this box is out of view, the shader draws the surface up to a block lower
+	const XMVECTOR boundsMin{ XMVectorSet(static_cast<float>(origin.x), minHeight - 1.0f, static_cast<float>(origin.y), 0.0f) };
+	const XMVECTOR boundsMax{ XMVectorSet(static_cast<float>(origin.x + tileWidth), maxHeight, static_cast<float>(origin.y + tileWidth), 0.0f) };
+	BoundingBox::CreateFromPoints(bounds, boundsMin, boundsMax);
+}
+
+void FarTerrain::CreateVertexBuffer(const std::vector<Vertex>& vertices, ID3D11Buffer*& pBuffer, const SceneContext& sceneContext) const
+{
+	SafeRelease(pBuffer);
+
+	//*************
+	//VERTEX BUFFER
+	D3D11_BUFFER_DESC vertexBuffDesc{};
+	vertexBuffDesc.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_VERTEX_BUFFER;
+	vertexBuffDesc.ByteWidth = static_cast<UINT>(sizeof(Vertex) * vertices.size());
+	vertexBuffDesc.CPUAccessFlags = 0;
+	vertexBuffDesc.Usage = D3D11_USAGE::D3D11_USAGE_IMMUTABLE;
+	vertexBuffDesc.MiscFlags = 0;
+
+	D3D11_SUBRESOURCE_DATA initData{};
+	initData.pSysMem = vertices.data();
+
+	sceneContext.d3dContext.pDevice->CreateBuffer(&vertexBuffDesc, &initData, &pBuffer);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "Utils/CompletionQueue.h"
+#include "Utils/JobSystem.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class WorldGenerator;
+
+// A cheap surface of the terrain past the render distance, built from the height noise alone so no chunk has to exist
+// The surface is split in square tiles that are built on the job system and kept while they are close to the center
+class FarTerrain final
+{
+public:
+	// One corner of the height grid, the color of the surface is taken from its tile in the atlas
+	struct Vertex
+	{
+		XMFLOAT3 position{};
+		XMFLOAT3 normal{};
+		uint32_t tile{};
+	};
+
+	struct Tile
+	{
+		XMINT2 position{}; // in tiles
+		ID3D11Buffer* pVertexBuffer{};
+		BoundingBox bounds{};
+		bool isBuilding{};
+	};
+
+	static constexpr int TileSize{ 8 }; // in chunks
+	// The number of quads on each side of a tile, every tile has (GridSize + 1)^2 vertices
+	static constexpr int GridSize{ 16 };
+
+	FarTerrain(const WorldGenerator& generator, JobSystem& jobSystem);
+	~FarTerrain();
+
+	FarTerrain(const FarTerrain& other) = delete;
+	FarTerrain(FarTerrain&& other) noexcept = delete;
+	FarTerrain& operator=(const FarTerrain& other) = delete;
+	FarTerrain& operator=(FarTerrain&& other) noexcept = delete;
+
+	// Only call this from the main thread, creates the buffers of the built tiles and starts building the missing tiles around the center
+	void Update(const XMINT2& chunkCenter, const SceneContext& sceneContext);
+
+	// In chunks from the center, 0 turns the far terrain off
+	void SetDistance(int distance) { m_Distance = std::max(distance, 0); }
+	int GetDistance() const { return m_Distance; }
+
+	const std::unordered_map<uint64_t, Tile>& GetTiles() const { return m_Tiles; }
+	int GetNrBuildingTiles() const { return m_NrBuildingTiles; }
+
+	// The triangles of the grid of one tile, every tile has the same grid
+	static void CreateIndices(std::vector<uint32_t>& indices);
+	static int GetNrIndices() { return GridSize * GridSize * 6; }
+
+private:
+	struct BuiltTile
+	{
+		XMINT2 position{};
+		std::vector<Vertex> vertices{};
+		BoundingBox bounds{};
+	};
+
+	static uint64_t PackPosition(int tileX, int tileY);
+	static int GetTileCoordinate(int chunkCoordinate);
+
+	void StartBuildingTile(const XMINT2& tilePosition);
+	// Can run on any thread, it only reads the noise of the generator
+	void CreateTileVertices(const XMINT2& tilePosition, std::vector<Vertex>& vertices, BoundingBox& bounds) const;
+	void CreateVertexBuffer(const std::vector<Vertex>& vertices, ID3D11Buffer*& pBuffer, const SceneContext& sceneContext) const;
+
+	const WorldGenerator& m_Generator;
+	JobSystem& m_JobSystem;
+
+	int m_Distance{ 48 };
+
+	std::unordered_map<uint64_t, Tile> m_Tiles{};
+	int m_NrBuildingTiles{};
+
+	// Waited for on destruction, the jobs write to the completion queue
+	JobSystem::Batch m_BuildBatch{};
+	CompletionQueue<BuiltTile> m_BuiltTiles{};
+};
@@ -0,0 +1,25 @@
+#include "stdafx.h"
+#include "QuadMesh.h"
+
+void QuadMesh::CreateIndices(int nrQuads, std::vector<uint32_t>& indices)
+{
+	indices.reserve(indices.size() + static_cast<size_t>(nrQuads) * NrIndicesPerQuad);
+
+	// Every quad uses the same triangles, offset to its own corners
+	for (int quadIdx{}; quadIdx < nrQuads; ++quadIdx)
+	{
+		const uint32_t firstVertex{ static_cast<uint32_t>(quadIdx * NrVerticesPerQuad) };
+
+		for (uint32_t index : m_QuadIndices)
+		{
+			indices.emplace_back(firstVertex + index);
+		}
+	}
+}
+
+int QuadMesh::GetNrIndexBufferQuads(int nrNeededQuads, int nrBufferQuads)
+{
+	if (nrNeededQuads <= nrBufferQuads) return nrBufferQuads;
+
+	return std::max(nrNeededQuads, nrBufferQuads * 2);
+}
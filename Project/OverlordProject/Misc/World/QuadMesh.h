@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Chunk meshes are lists of quads with 4 vertices each
+// Every quad is drawn with the same 2 triangles, so all chunks can share one index buffer
+class QuadMesh final
+{
+public:
+	static constexpr int NrVerticesPerQuad{ 4 };
+	static constexpr int NrIndicesPerQuad{ 6 };
+
+	QuadMesh() = default;
+	~QuadMesh() = default;
+	QuadMesh(const QuadMesh& other) = delete;
+	QuadMesh(QuadMesh&& other) noexcept = delete;
+	QuadMesh& operator=(const QuadMesh& other) = delete;
+	QuadMesh& operator=(QuadMesh&& other) noexcept = delete;
+
+	// Appends the 4 corners of a quad, in the order of the faces of the block meshes
+	template<typename Vertex>
+	static void AddQuad(std::vector<Vertex>& vertices, const Vertex(&corners)[NrVerticesPerQuad]);
+
+	static int GetNrQuads(size_t nrVertices) { return static_cast<int>(nrVertices / NrVerticesPerQuad); }
+	static int GetNrIndices(size_t nrVertices) { return GetNrQuads(nrVertices) * NrIndicesPerQuad; }
+
+	// Appends the indices of the triangles of this amount of quads
+	static void CreateIndices(int nrQuads, std::vector<uint32_t>& indices);
+	// The number of quads a shared index buffer needs to draw meshes of this many quads, the current size if it still fits
+	//	a buffer that is too small grows at least twice as big, so it isn't recreated for every mesh that is a bit bigger
+	static int GetNrIndexBufferQuads(int nrNeededQuads, int nrBufferQuads);
+
+private:
+	// The 2 triangles of a quad relative to its first corner
+	static constexpr uint32_t m_QuadIndices[NrIndicesPerQuad]{ 0,1,2,3,2,1 };
+};
+
+template<typename Vertex>
+void QuadMesh::AddQuad(std::vector<Vertex>& vertices, const Vertex(&corners)[NrVerticesPerQuad])
+{
+	vertices.insert(vertices.end(), std::begin(corners), std::end(corners));
+}
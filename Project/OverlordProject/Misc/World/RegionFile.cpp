@@ -0,0 +1,203 @@
+#include "RegionFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+RegionFile::RegionFile(const std::filesystem::path& path)
+	: m_Path{ path }
+	, m_Table(Size * Size)
+	, m_NrSectors{ 1 }
+{
+	// If the file doesn't exist yet, it gets created on the first write
+	std::ifstream file{ m_Path, std::ios::binary };
+	if (!file) return;
+
+	// Read the sector table
+	file.read(reinterpret_cast<char*>(m_Table.data()), m_Table.size() * sizeof(uint32_t));
+	if (!file) std::fill(m_Table.begin(), m_Table.end(), 0U);
+
+	// Every chunk starts at the beginning of a sector
+	const auto fileSize{ std::filesystem::file_size(m_Path) };
+	m_NrSectors = std::max(1, static_cast<int>((fileSize + SectorSize - 1) / SectorSize));
+}
+
+RegionFile::~RegionFile()
+{
+	Unmap();
+}
+
+bool RegionFile::ReadChunk(int x, int z, const uint8_t*& pData, uint32_t& size)
+{
+	// If the chunk isn't in the table, it hasn't been saved
+	const uint32_t entry{ m_Table[GetTableIdx(x, z)] };
+	if (entry == 0) return false;
+
+	// Map the file the first time a chunk is read after a write
+	if (!m_pMappedData && !Map()) return false;
+
+	// Every chunk starts with the size of its data
+	const size_t offset{ static_cast<size_t>(entry >> 8) * SectorSize };
+	if (offset + sizeof(uint32_t) > m_MappedSize) return false;
+
+	uint32_t dataSize{};
+	memcpy(&dataSize, m_pMappedData + offset, sizeof(uint32_t));
+	if (offset + sizeof(uint32_t) + dataSize > m_MappedSize) return false;
+
+	pData = m_pMappedData + offset + sizeof(uint32_t);
+	size = dataSize;
+
+	return true;
+}
+
+bool RegionFile::WriteChunk(int x, int z, const std::vector<uint8_t>& data)
+{
+	const int tableIdx{ GetTableIdx(x, z) };
+
+	// The sector count is stored in 8 bits
+	const int nrSectorsNeeded{ static_cast<int>((sizeof(uint32_t) + data.size() + SectorSize - 1) / SectorSize) };
+	if (nrSectorsNeeded > UINT8_MAX) return false;
+
+	int sectorOffset{ static_cast<int>(m_Table[tableIdx] >> 8) };
+	const int nrPrevSectors{ static_cast<int>(m_Table[tableIdx] & UINT8_MAX) };
+
+	// If the data doesn't fit in the previous sectors of this chunk, search new sectors
+	if (nrSectorsNeeded > nrPrevSectors)
+	{
+		// Mark every sector that is used by the table or another chunk
+		std::vector<bool> isUsed(m_NrSectors);
+		isUsed[0] = true;
+		for (int i{}; i < static_cast<int>(m_Table.size()); ++i)
+		{
+			if (i == tableIdx) continue;
+
+			const int offset{ static_cast<int>(m_Table[i] >> 8) };
+			const int nrSectors{ static_cast<int>(m_Table[i] & UINT8_MAX) };
+			for (int sector{ offset }; sector < offset + nrSectors && sector < m_NrSectors; ++sector) isUsed[sector] = true;
+		}
+
+		// Find the first run of free sectors that is big enough
+		//	if there is none, the run at the end of the file gets extended
+		sectorOffset = 1;
+		for (int sector{ 1 }; sector < m_NrSectors && sector - sectorOffset < nrSectorsNeeded; ++sector)
+		{
+			if (isUsed[sector]) sectorOffset = sector + 1;
+		}
+	}
+
+	// The mapping doesn't cover the new data, it gets remapped on the next read
+	Unmap();
+
+	// Create the file with an empty sector table if it doesn't exist yet
+	if (!std::filesystem::exists(m_Path))
+	{
+		std::ofstream newFile{ m_Path, std::ios::binary };
+		const std::vector<char> emptyTable(SectorSize);
+		newFile.write(emptyTable.data(), emptyTable.size());
+		if (!newFile) return false;
+	}
+
+	std::fstream file{ m_Path, std::ios::in | std::ios::out | std::ios::binary };
+	if (!file) return false;
+
+	// Write the size, the data and pad the last sector
+	const uint32_t dataSize{ static_cast<uint32_t>(data.size()) };
+	const std::vector<char> padding(nrSectorsNeeded * SectorSize - sizeof(uint32_t) - data.size());
+	file.seekp(static_cast<std::streamoff>(sectorOffset) * SectorSize);
+	file.write(reinterpret_cast<const char*>(&dataSize), sizeof(uint32_t));
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	file.write(padding.data(), padding.size());
+
+	// Update the sector table
+	m_Table[tableIdx] = static_cast<uint32_t>(sectorOffset) << 8 | static_cast<uint32_t>(nrSectorsNeeded);
+	file.seekp(tableIdx * sizeof(uint32_t));
+	file.write(reinterpret_cast<const char*>(&m_Table[tableIdx]), sizeof(uint32_t));
+
+	m_NrSectors = std::max(m_NrSectors, sectorOffset + nrSectorsNeeded);
+
+	return file.good();
+}
+
+bool RegionFile::Map()
+{
+#ifdef _WIN32
+	// Open the file and map the whole file as read only
+	m_FileHandle = CreateFileW(m_Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_FileHandle == INVALID_HANDLE_VALUE)
+	{
+		m_FileHandle = nullptr;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(m_FileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Unmap();
+		return false;
+	}
+
+	m_MappingHandle = CreateFileMappingW(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_MappingHandle)
+	{
+		Unmap();
+		return false;
+	}
+
+	m_pMappedData = static_cast<const uint8_t*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	m_MappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+	// Open the file and map the whole file as read only
+	m_FileDescriptor = open(m_Path.c_str(), O_RDONLY);
+	if (m_FileDescriptor < 0) return false;
+
+	struct stat fileStats {};
+	if (fstat(m_FileDescriptor, &fileStats) != 0 || fileStats.st_size == 0)
+	{
+		Unmap();
+		return false;
+	}
+
+	void* pMappedData{ mmap(nullptr, static_cast<size_t>(fileStats.st_size), PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0) };
+	if (pMappedData != MAP_FAILED) m_pMappedData = static_cast<const uint8_t*>(pMappedData);
+	m_MappedSize = static_cast<size_t>(fileStats.st_size);
+#endif
+
+	if (!m_pMappedData)
+	{
+		Unmap();
+		return false;
+	}
+
+	return true;
+}
+
+void RegionFile::Unmap()
+{
+#ifdef _WIN32
+	if (m_pMappedData) UnmapViewOfFile(m_pMappedData);
+	if (m_MappingHandle) CloseHandle(m_MappingHandle);
+	if (m_FileHandle) CloseHandle(m_FileHandle);
+
+	m_MappingHandle = nullptr;
+	m_FileHandle = nullptr;
+#else
+	if (m_pMappedData) munmap(const_cast<uint8_t*>(m_pMappedData), m_MappedSize);
+	if (m_FileDescriptor >= 0) close(m_FileDescriptor);
+
+	m_FileDescriptor = -1;
+#endif
+
+	m_pMappedData = nullptr;
+	m_MappedSize = 0;
+}
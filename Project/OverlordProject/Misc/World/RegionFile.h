@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// A file that stores the chunks of a region of 32x32 chunks
+// The first sector holds a table with the sector offset and sector count of every chunk,
+//	the data of every chunk is stored in the sectors after it
+// Chunks are read through a memory mapping of the file, so reading a chunk doesn't copy the file
+class RegionFile final
+{
+public:
+	static constexpr int Size{ 32 };
+	static constexpr int SectorSize{ 4096 };
+
+	explicit RegionFile(const std::filesystem::path& path);
+	~RegionFile();
+
+	RegionFile(const RegionFile& other) = delete;
+	RegionFile(RegionFile&& other) noexcept = delete;
+	RegionFile& operator=(const RegionFile& other) = delete;
+	RegionFile& operator=(RegionFile&& other) noexcept = delete;
+
+	// Returns the stored data of the chunk at this position in the region, false if it hasn't been saved
+	// The data points into the mapped file and stays valid until the next write to this file
+	bool ReadChunk(int x, int z, const uint8_t*& pData, uint32_t& size);
+	// Stores the data of the chunk at this position in the region
+	// The previous sectors of the chunk are reused if the data still fits, otherwise the first free sectors are used
+	bool WriteChunk(int x, int z, const std::vector<uint8_t>& data);
+
+private:
+	static int GetTableIdx(int x, int z) { return x + z * Size; }
+
+	bool Map();
+	void Unmap();
+
+	std::filesystem::path m_Path{};
+
+	// Every entry stores the sector offset in the upper 24 bits and the sector count in the lower 8 bits
+	std::vector<uint32_t> m_Table{};
+	int m_NrSectors{};
+
+	const uint8_t* m_pMappedData{};
+	size_t m_MappedSize{};
+#ifdef _WIN32
+	void* m_FileHandle{};
+	void* m_MappingHandle{};
+#else
+	int m_FileDescriptor{ -1 };
+#endif
+};
@@ -0,0 +1,70 @@
+#include "RegionStorage.h"
+
+#include "Chunk.h"
+#include "ChunkSerializer.h"
+
+#include <sstream>
+#include <system_error>
+
+using namespace DirectX;
+
+RegionStorage::RegionStorage(const std::filesystem::path& directory)
+	: m_Directory{ directory }
+{
+	std::error_code error{};
+	std::filesystem::create_directories(m_Directory, error);
+}
+
+bool RegionStorage::LoadChunk(Chunk& chunk)
+{
+	// Get the saved data of this chunk
+	XMINT2 positionInRegion{};
+	RegionFile& region{ GetRegion(chunk.position, positionInRegion) };
+
+	const uint8_t* pData{};
+	uint32_t dataSize{};
+	if (!region.ReadChunk(positionInRegion.x, positionInRegion.y, pData, dataSize)) return false;
+
+	// Read the chunk straight from the mapped file
+	if (!ChunkSerializer::Deserialize(chunk, pData, dataSize)) return false;
+
+	++m_NrLoadedChunks;
+
+	return true;
+}
+
+void RegionStorage::SaveChunk(const Chunk& chunk)
+{
+	m_Buffer.clear();
+	ChunkSerializer::Serialize(chunk, m_Buffer);
+
+	// Store the data in the region file
+	XMINT2 positionInRegion{};
+	RegionFile& region{ GetRegion(chunk.position, positionInRegion) };
+	if (region.WriteChunk(positionInRegion.x, positionInRegion.y, m_Buffer)) ++m_NrSavedChunks;
+}
+
+RegionFile& RegionStorage::GetRegion(const XMINT2& chunkPosition, XMINT2& positionInRegion)
+{
+	// Calculate the region position of this chunk
+	const XMINT2 regionPosition
+	{
+		chunkPosition.x < 0 ? (chunkPosition.x + 1) / RegionFile::Size - 1 : chunkPosition.x / RegionFile::Size,
+		chunkPosition.y < 0 ? (chunkPosition.y + 1) / RegionFile::Size - 1 : chunkPosition.y / RegionFile::Size
+	};
+
+	positionInRegion.x = chunkPosition.x - regionPosition.x * RegionFile::Size;
+	positionInRegion.y = chunkPosition.y - regionPosition.y * RegionFile::Size;
+
+	// Open the region file if it isn't open yet
+	const uint64_t key{ (static_cast<uint64_t>(static_cast<uint32_t>(regionPosition.x)) << 32) | static_cast<uint32_t>(regionPosition.y) };
+	std::unique_ptr<RegionFile>& pRegion{ m_pRegions[key] };
+	if (!pRegion)
+	{
+		std::stringstream fileName{};
+		fileName << "r." << regionPosition.x << "." << regionPosition.y << ".region";
+		pRegion = std::make_unique<RegionFile>(m_Directory / fileName.str());
+	}
+
+	return *pRegion;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "RegionFile.h"
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct Chunk;
+
+// Saves chunks in region files and loads them back when the chunk is needed again
+class RegionStorage final
+{
+public:
+	explicit RegionStorage(const std::filesystem::path& directory);
+	~RegionStorage() = default;
+
+	RegionStorage(const RegionStorage& other) = delete;
+	RegionStorage(RegionStorage&& other) noexcept = delete;
+	RegionStorage& operator=(const RegionStorage& other) = delete;
+	RegionStorage& operator=(RegionStorage&& other) noexcept = delete;
+
+	// Fills the sections of the chunk with its saved blocks and fluids
+	// Returns false if the chunk hasn't been saved, the sections should already be sized for the world height
+	bool LoadChunk(Chunk& chunk);
+	void SaveChunk(const Chunk& chunk);
+
+	int GetNrLoadedChunks() const { return m_NrLoadedChunks; }
+	int GetNrSavedChunks() const { return m_NrSavedChunks; }
+
+private:
+	RegionFile& GetRegion(const DirectX::XMINT2& chunkPosition, DirectX::XMINT2& positionInRegion);
+
+	std::filesystem::path m_Directory{};
+	std::unordered_map<uint64_t, std::unique_ptr<RegionFile>> m_pRegions{};
+
+	// Reused for every chunk that gets saved
+	std::vector<uint8_t> m_Buffer{};
+
+	int m_NrLoadedChunks{};
+	int m_NrSavedChunks{};
+};
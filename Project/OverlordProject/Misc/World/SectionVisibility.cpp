@@ -0,0 +1,89 @@
+#include "stdafx.h"
+#include "SectionVisibility.h"
+
+void SectionVisibility::Build(const ChunkSection& section, const bool* pIsOpaqueCube)
+{
+	// A section with one block type is open or closed on every face
+	if (section.IsUniform())
+	{
+		m_ConnectedFaces.fill(pIsOpaqueCube[static_cast<int>(section.GetUniformBlock())] ? 0 : AllFaces);
+		return;
+	}
+
+	m_ConnectedFaces.fill(0);
+
+	constexpr int size{ ChunkSection::Size };
+
+	// The blocks that can't be walked through, one bit per block along x in every row, ordered by y and then z
+	//	blocks are marked in the same rows once they have been reached, so every block is only visited once
+	std::array<uint32_t, size * size> closedRows{};
+	section.GetRowBits(pIsOpaqueCube, closedRows.data());
+
+	const auto getFaces{ [](int x, int y, int z)
+		{
+			uint8_t faces{};
+			if (z == size - 1) faces |= 1U << static_cast<int>(FaceDirection::FORWARD);
+			if (z == 0) faces |= 1U << static_cast<int>(FaceDirection::BACK);
+			if (x == size - 1) faces |= 1U << static_cast<int>(FaceDirection::RIGHT);
+			if (x == 0) faces |= 1U << static_cast<int>(FaceDirection::LEFT);
+			if (y == size - 1) faces |= 1U << static_cast<int>(FaceDirection::UP);
+			if (y == 0) faces |= 1U << static_cast<int>(FaceDirection::BOTTOM);
+			return faces;
+		} };
+
+	// Every block is pushed at most once
+	std::array<uint16_t, ChunkSection::Volume> stack{};
+
+	for (int y{}; y < size; ++y)
+	{
+		for (int z{}; z < size; ++z)
+		{
+			for (int x{}; x < size; ++x)
+			{
+				// Air that doesn't touch a face of the section can't connect faces, so only the border starts a fill
+				if (!getFaces(x, y, z)) continue;
+				if ((closedRows[y * size + z] >> x) & 1U) continue;
+
+				// Fill the open blocks that are connected to this one and collect the faces they touch
+				uint8_t touchedFaces{};
+				int stackSize{};
+				closedRows[y * size + z] |= 1U << x;
+				stack[stackSize++] = static_cast<uint16_t>(x + (z + y * size) * size);
+				while (stackSize > 0)
+				{
+					const int blockIdx{ stack[--stackSize] };
+					const int blockX{ blockIdx % size };
+					const int blockZ{ (blockIdx / size) % size };
+					const int blockY{ blockIdx / (size * size) };
+					touchedFaces |= getFaces(blockX, blockY, blockZ);
+
+					const auto push{ [&](int nextX, int nextY, int nextZ)
+						{
+							if (nextX < 0 || nextY < 0 || nextZ < 0 || nextX >= size || nextY >= size || nextZ >= size) return;
+
+							uint32_t& row{ closedRows[nextY * size + nextZ] };
+							if ((row >> nextX) & 1U) return;
+
+							row |= 1U << nextX;
+							stack[stackSize++] = static_cast<uint16_t>(nextX + (nextZ + nextY * size) * size);
+						} };
+					push(blockX + 1, blockY, blockZ);
+					push(blockX - 1, blockY, blockZ);
+					push(blockX, blockY + 1, blockZ);
+					push(blockX, blockY - 1, blockZ);
+					push(blockX, blockY, blockZ + 1);
+					push(blockX, blockY, blockZ - 1);
+				}
+
+				// Every face that the air touches can see every other face it touches
+				for (int faceIdx{}; faceIdx < NrFaces; ++faceIdx)
+				{
+					if ((touchedFaces >> faceIdx) & 1U) m_ConnectedFaces[faceIdx] |= touchedFaces;
+				}
+
+				// Nothing can be added once every face is connected
+				if (touchedFaces == AllFaces) return;
+			}
+		}
+	}
+}
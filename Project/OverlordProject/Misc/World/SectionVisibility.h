@@ -0,0 +1,28 @@
+#pragma once
+#include "ChunkSection.h"
+
+#include <array>
+#include <cstdint>
+
+// Which faces of a section can see each other through the blocks that aren't opaque cubes
+// The renderer walks from the section of the camera through the connected faces, sections it can't reach are hidden behind stone
+class SectionVisibility final
+{
+public:
+	static constexpr int NrFaces{ 6 };
+
+	// Every face is connected to every face, like a section with only air
+	SectionVisibility() { m_ConnectedFaces.fill(AllFaces); }
+
+	// The table is indexed by block type and marks the opaque cubes
+	void Build(const ChunkSection& section, const bool* pIsOpaqueCube);
+
+	// The faces are indices of FaceDirection
+	bool IsConnected(int fromFace, int toFace) const { return (m_ConnectedFaces[fromFace] >> toFace) & 1U; }
+
+private:
+	static constexpr uint8_t AllFaces{ (1U << NrFaces) - 1 };
+
+	// One bit per FaceDirection for every face, a face is connected to itself when air touches it
+	std::array<uint8_t, NrFaces> m_ConnectedFaces{};
+};
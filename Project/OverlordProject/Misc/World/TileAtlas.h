@@ -1,11 +1,143 @@
 #pragma once
 #include "WorldData.h"
 
+#include <array>
+
 class TileAtlas final
 {
 public:
-	XMFLOAT2 GetUV(FaceType blockType, const XMFLOAT2& originalUV) const;
-	FaceType GetFaceType(BlockType blockType, FaceDirection faceDirection) const;
+	static constexpr int NrFaces{ 6 };
+	static constexpr int NrCorners{ 4 };
+	static constexpr int NrBlockTypes{ 256 };
+
+	// The texture coordinates of every corner of every face of a block, in the order of FaceDirection
+	//	the corners go top left, top right, bottom right, bottom left on the tile
+	using FaceUVs = std::array<std::array<XMFLOAT2, NrCorners>, NrFaces>;
+
+	static constexpr XMFLOAT2 GetUV(FaceType blockType, const XMFLOAT2& originalUV);
+	static constexpr FaceType GetFaceType(BlockType blockType, FaceDirection faceDirection);
+	static constexpr const FaceUVs& GetFaceUVs(BlockType blockType);
+
 private:
+	using FaceTypeTable = std::array<std::array<FaceType, NrFaces>, NrBlockTypes>;
+	using FaceUVTable = std::array<FaceUVs, NrBlockTypes>;
+
+	static constexpr FaceType CalculateFaceType(BlockType blockType, FaceDirection faceDirection);
+	static constexpr FaceTypeTable CreateFaceTypes();
+	static constexpr FaceUVTable CreateFaceUVs();
+
+	// Built at compile time, indexed by block type
+	static const FaceTypeTable m_FaceTypes;
+	static const FaceUVTable m_FaceUVs;
 };
 
+constexpr XMFLOAT2 TileAtlas::GetUV(FaceType blockType, const XMFLOAT2& originalUV)
+{
+	// There are 16x16 tiles in the tile atlas
+	constexpr int nrBlocksPerRow{ 16 };
+	constexpr float tileSize{ 1.0f / 16.0f };
+	constexpr float tileEpsilon{ 0.0001f };
+
+	const int blockX{ static_cast<int>(blockType) % nrBlocksPerRow };
+	const int blockY{ static_cast<int>(blockType) / nrBlocksPerRow };
+
+	constexpr float halfUV{ 0.5f };
+	const float epsilonX{ originalUV.x > halfUV ? -tileEpsilon : tileEpsilon };
+	const float epsilonY{ originalUV.y > halfUV ? -tileEpsilon : tileEpsilon };
+
+	XMFLOAT2 blockUV
+	{
+		originalUV.x * tileSize + epsilonX + tileSize * blockX,
+		originalUV.y * tileSize + epsilonY + tileSize * blockY
+	};
+
+	return blockUV;
+}
+
+constexpr FaceType TileAtlas::CalculateFaceType(BlockType blockType, FaceDirection faceDirection)
+{
+	switch (blockType)
+	{
+	case BlockType::GRASS_BLOCK:
+	{
+		switch (faceDirection)
+		{
+		case FaceDirection::UP:
+			return FaceType::GRASS_BLOCK;
+		case FaceDirection::BOTTOM:
+			return FaceType::DIRT;
+		default:
+			return FaceType::GRASS_SIDE;
+		}
+	}
+	case BlockType::SANDSTONE:
+	{
+		switch (faceDirection)
+		{
+		case FaceDirection::UP:
+			return FaceType::SANDSTONE_TOP;
+		case FaceDirection::BOTTOM:
+			return FaceType::SANDSTONE_BOTTOM;
+		default:
+			return FaceType::SANDSTONE_SIDE;
+		}
+	}
+	case BlockType::OAK_LOG:
+	{
+		switch (faceDirection)
+		{
+		case FaceDirection::UP:
+		case FaceDirection::BOTTOM:
+			return FaceType::OAK_LOG_TOP;
+		default:
+			return FaceType::OAK_LOG_SIDE;
+		}
+	}
+	}
+
+	return static_cast<FaceType>(blockType);
+}
+
+constexpr TileAtlas::FaceTypeTable TileAtlas::CreateFaceTypes()
+{
+	FaceTypeTable faceTypes{};
+	for (int type{}; type < NrBlockTypes; ++type)
+	{
+		for (int faceIdx{}; faceIdx < NrFaces; ++faceIdx)
+		{
+			faceTypes[type][faceIdx] = CalculateFaceType(static_cast<BlockType>(type), static_cast<FaceDirection>(faceIdx));
+		}
+	}
+
+	return faceTypes;
+}
+
+constexpr TileAtlas::FaceUVTable TileAtlas::CreateFaceUVs()
+{
+	constexpr XMFLOAT2 cornerUVs[NrCorners]{ { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+	FaceUVTable faceUVs{};
+	for (int type{}; type < NrBlockTypes; ++type)
+	{
+		for (int faceIdx{}; faceIdx < NrFaces; ++faceIdx)
+		{
+			const FaceType faceType{ CalculateFaceType(static_cast<BlockType>(type), static_cast<FaceDirection>(faceIdx)) };
+			for (int cornerIdx{}; cornerIdx < NrCorners; ++cornerIdx) faceUVs[type][faceIdx][cornerIdx] = GetUV(faceType, cornerUVs[cornerIdx]);
+		}
+	}
+
+	return faceUVs;
+}
+
+inline constexpr TileAtlas::FaceTypeTable TileAtlas::m_FaceTypes{ TileAtlas::CreateFaceTypes() };
+inline constexpr TileAtlas::FaceUVTable TileAtlas::m_FaceUVs{ TileAtlas::CreateFaceUVs() };
+
+constexpr FaceType TileAtlas::GetFaceType(BlockType blockType, FaceDirection faceDirection)
+{
+	return m_FaceTypes[static_cast<int>(blockType)][static_cast<int>(faceDirection)];
+}
+
+constexpr const TileAtlas::FaceUVs& TileAtlas::GetFaceUVs(BlockType blockType)
+{
+	return m_FaceUVs[static_cast<int>(blockType)];
+}
@@ -1,6 +1,14 @@
 #pragma once
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
 
-enum class FaceDirection : BYTE
+namespace FMOD
+{
+	class Sound;
+}
+
+enum class FaceDirection : uint8_t
 {
 	FORWARD,
 	BACK,
@@ -10,7 +18,7 @@ enum class FaceDirection : BYTE
 	BOTTOM
 };
 
-enum class FaceType : BYTE
+enum class FaceType : uint8_t
 {
 	AIR,
 	DIRT,
@@ -31,7 +39,7 @@ enum class FaceType : BYTE
 	WOOL
 };
 
-enum class BlockType : BYTE
+enum class BlockType : uint8_t
 {
 	AIR = 0,
 	DIRT = 1,
@@ -48,12 +56,20 @@ enum class BlockType : BYTE
 	WOOL = 16
 };
 
-enum class BlockMesh : BYTE
+enum class BlockMesh : uint8_t
 {
 	CUBE,
 	CROSS
 };
 
+// Every layer of a chunk mesh has its own vertex buffer and is drawn with its own render state
+enum class MeshLayer : uint8_t
+{
+	SOLID, // Opaque cubes
+	CUTOUT, // Cross blocks and cutout cubes like leaves, their holes are clipped
+	TRANSLUCENT // Blended blocks like water
+};
+
 struct Block
 {
 	BlockType type{};
@@ -61,6 +77,7 @@ struct Block
 	Block* dropBlock{};
 	float breakTime{};
 	bool transparent{};
+	bool cutout{};
 	FMOD::Sound* pHitSound{};
 	FMOD::Sound* pEventSound{};
 };
@@ -74,7 +91,7 @@ struct BlockLayer
 struct StructureBlock
 {
 	Block* pBlock{};
-	XMINT3 position{};
+	DirectX::XMINT3 position{};
 };
 
 struct Structure
@@ -1,49 +1,39 @@
 #include "stdafx.h"
 #include "WorldGenerator.h"
 #include "WorldRenderer.h"
+#include "QuadMesh.h"
 
 #include "Misc/World/WorldData.h"
 #include "Managers/BlockManager.h"
 
-WorldGenerator::WorldGenerator()
-	: m_HeightPerlin{ 4, 5 }
+#include <chrono>
+
+WorldGenerator::WorldGenerator(const std::filesystem::path& saveDirectory)
+	: m_SaveDirectory{ saveDirectory }
+	, m_HeightPerlin{ 4, 5 }
 	, m_UnderSeaPerlin{ 5, 25 }
 	, m_BeachPerlin{ 2, 1 }
 	, m_VegitationPerlin{ 5, 0.1f }
 	, m_SheepPerlin{ 5, 0.1f }
 {
+	// Unloaded chunks go back to the pool so new chunks can reuse their memory
+	m_Chunks.SetPool(&m_ChunkPool);
 
-	// A predicate lambda to check if there is a block on a certain postiion
-	m_IsBlockPredicate = [&](const std::vector<Chunk>& chunks, const XMINT3& position) -> bool
-	{
-		BlockType const* pBlock{ GetBlockInChunk(position.x, position.y, position.z, chunks) };
-
-		if (!pBlock) return false;
-
-		return *pBlock != BlockType::AIR;
-	};
-
-	// A predicate lambda to check if a face can be rendered
-	m_CanRenderPredicate = [&](const std::vector<Chunk>& chunks, const XMINT3& neighbourPos, BlockType curBlock) -> bool
-	{
-		BlockType const* pNeighbourBlockType{ GetBlockInChunk(neighbourPos.x, neighbourPos.y, neighbourPos.z, chunks) };
-
-		if (!pNeighbourBlockType) return true;
+	// Store the seed next to the saved chunks, so the world they belong to is generated again on the next start
+	SaveSeed();
 
-		Block* pNeighbourBlock{ BlockManager::Get()->GetBlock(*pNeighbourBlockType) };
-
-		if (!pNeighbourBlock) return true;
-
-		if (pNeighbourBlock->mesh == BlockMesh::CROSS) return true;
-
-		if (curBlock != BlockType::WATER && pNeighbourBlock->transparent) return true;
-
-		return false;
-	};
+	// A predicate to check if a face can be rendered next to a neighbouring block
+	m_CanRenderPredicate = &WorldGenerator::CanRenderFace;
 
 	// Create the water block
 	m_pWaterBlock = std::make_unique<Block>(BlockType::WATER, BlockMesh::CUBE, nullptr, -1.0f, true);
 
+	// Size the chunk tables for the default render distance
+	SetRenderDistance(m_RenderDistance);
+
+	// Every worker meshes with its own scratch
+	for (int scratchIdx{}; scratchIdx < m_JobSystem.GetNrWorkers(); ++scratchIdx) m_pMeshScratches.emplace_back(std::make_unique<MeshScratch>());
+
 	// Populate the directions of neighbouring blocks
 	for (int i{}; i <= static_cast<int>(FaceDirection::BOTTOM); ++i)
 	{
@@ -84,163 +74,165 @@ WorldGenerator::WorldGenerator()
 }
 WorldGenerator::~WorldGenerator()
 {
-	// Delete any chunks that haven't been transfered to the main thread yet
-	for (Chunk& chunk : m_Chunks) chunk.DeleteChunk();
-	for (Chunk& chunk : m_WaterChunks) chunk.DeleteChunk();
+	// Save the changed chunks that are still loaded, the world thread has already stopped
+	for (const Chunk& chunk : m_Chunks)
+	{
+		if (chunk.isModified) m_RegionStorage.SaveChunk(chunk);
+	}
 }
 
-void WorldGenerator::RemoveBlock(const XMFLOAT3& position, const SceneContext& sceneContext, WorldRenderer* pRenderer)
+bool WorldGenerator::CanRenderFace(BlockType neighbourBlock, BlockType curBlock)
 {
-	// Get the block at this position
-	BlockType* pBlock{ GetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z), m_Chunks) };
-	if (!pBlock) return;
+	const BlockManager* pBlockManager{ BlockManager::Get() };
 
-	// Set the block to air
-	*pBlock = BlockType::AIR;
+	// Air, unknown blocks and cross blocks are no cubes
+	if (!pBlockManager->IsCube(neighbourBlock)) return true;
 
-	// If the block on top is a cross block, set that block to air as well
-	BlockType* pBlockUp{ GetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y) + 1, static_cast<int>(position.z), m_Chunks) };
-	if (pBlockUp && *pBlockUp != BlockType::AIR && BlockManager::Get()->GetBlock(*pBlockUp)->mesh == BlockMesh::CROSS) *pBlockUp = BlockType::AIR;
+	if (curBlock != BlockType::WATER && pBlockManager->IsTransparent(neighbourBlock)) return true;
+
+	return false;
+}
 
-	// Reload this chunk and the chunks around this position
-	ReloadChunks(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z));
+void WorldGenerator::SetRenderDistance(int renderDistance)
+{
+	m_RenderDistance = renderDistance;
 
-	// Create new vertex buffers
-	pRenderer->SetBuffers(m_Chunks, sceneContext);
-	pRenderer->SetBuffers(m_WaterChunks, sceneContext);
+	// Make sure all the chunks in render distance fit in the chunk tables without rehashing
+	const int renderWidth{ m_RenderDistance * 2 + 1 };
+	m_Chunks.Reserve(renderWidth * renderWidth);
 
-	OutputDebugStringW(L"Destroy block update\n");
+	// Create all the chunks in render distance up front, walking around only recycles them afterwards
+	m_ChunkPool.Reserve(renderWidth * renderWidth);
 }
 
-void WorldGenerator::PlaceBlock(const XMFLOAT3& position, BlockType block, const SceneContext& sceneContext, WorldRenderer* pRenderer)
+int WorldGenerator::GetLodDistance() const
 {
-	// Get the block at this position
-	BlockType* pBlock{ GetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z), m_Chunks) };
-	if (!pBlock) return;
+	const int lodDistance{ m_LodDistance };
+	if (lodDistance >= 0) return lodDistance;
 
-	// Set the block to the new blocktype
-	*pBlock = block;
+	// The chunks with colliders always keep their full blocks
+	const int loadRadius{ m_RenderDistance - 1 };
+	return std::max(loadRadius / 2, m_PhysicsDistance + 1);
+}
 
-	// If the block underneath this block is a grass block, set it to dirt
-	BlockType* pBlockDown{ GetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y) - 1, static_cast<int>(position.z), m_Chunks) };
-	if (pBlockDown && *pBlockDown == BlockType::GRASS_BLOCK) *pBlockDown = BlockType::DIRT;
+bool WorldGenerator::RemoveBlock(const XMFLOAT3& position, const SceneContext& sceneContext, WorldRenderer* pRenderer)
+{
+	// The player can hit a block that an earlier edit already removed, the earlier edit wins
+	if (GetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z)) == BlockType::AIR) return false;
+
+	BeginEdit();
 
-	// Reload this chunk and the neighbouring chunks
-	ReloadChunks(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z));
+	// Set the block at this position to air
+	const bool isRemoved{ SetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z), BlockType::AIR) };
+
+	// If the block on top is a cross block, set that block to air as well
+	const BlockType blockUp{ GetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y) + 1, static_cast<int>(position.z)) };
+	if (isRemoved && blockUp != BlockType::AIR && BlockManager::Get()->GetMesh(blockUp) == BlockMesh::CROSS)
+		SetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y) + 1, static_cast<int>(position.z), BlockType::AIR);
 
-	// Create new vertex buffers
-	pRenderer->SetBuffers(m_Chunks, sceneContext);
-	pRenderer->SetBuffers(m_WaterChunks, sceneContext);
+	// Only chunks that the player changed are saved, structures and flowing water are generated again
+	if (isRemoved) GetChunkAt(static_cast<int>(position.x), static_cast<int>(position.z))->isModified = true;
 
-	OutputDebugStringW(L"Place block update\n");
+	// Remesh the changed chunks, if this edit is part of a bigger edit this happens when that edit is committed
+	Commit(sceneContext, pRenderer);
+
+	return isRemoved;
 }
 
-void WorldGenerator::ReloadChunks(int changedX, int changedY, int changedZ)
+bool WorldGenerator::PlaceBlock(const XMFLOAT3& position, BlockType block, const SceneContext& sceneContext, WorldRenderer* pRenderer)
 {
-	// Get the chunks at this position
-	Chunk* pChunk{ GetChunkAt(changedX, changedZ, m_Chunks) };
-	Chunk* pWaterChunk{ GetChunkAt(changedX, changedZ, m_WaterChunks) };
-	// Get the relative position of this block in the chunk
-	const XMINT3 lookUpPos{ static_cast<int>(changedX) - pChunk->position.x * m_ChunkSize, static_cast<int>(changedY), static_cast<int>(changedZ) - pChunk->position.y * m_ChunkSize };
+	// The player can aim at a position that an earlier edit already filled, the earlier edit wins
+	if (BlockManager::Get()->IsCube(GetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z)))) return false;
 
-	// Create a list of chunks to check in the predicate
-	std::vector<std::vector<Chunk>*> predicateChunks{};
-	predicateChunks.push_back(&m_Chunks);
+	BeginEdit();
 
-	// Create a list of chunks to check in the water predicate
-	std::vector<std::vector<Chunk>*> predicateWaterChunks{};
-	predicateWaterChunks.push_back(&m_Chunks);
-	predicateWaterChunks.push_back(&m_WaterChunks);
+	// Set the block at this position to the new blocktype
+	const bool isPlaced{ SetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z), block) };
 
-	// Create new vertices for this chunk
-	CreateVertices(*pChunk, predicateChunks);
-	CreateVertices(*pWaterChunk, predicateWaterChunks);
+	// If the block underneath this block is a grass block, set it to dirt
+	if (isPlaced && GetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y) - 1, static_cast<int>(position.z)) == BlockType::GRASS_BLOCK)
+		SetBlockInChunk(static_cast<int>(position.x), static_cast<int>(position.y) - 1, static_cast<int>(position.z), BlockType::DIRT);
 
-	// If the block neighbours a chunk in the x direction, reload these chunks as well
-	if (lookUpPos.x == 0 || lookUpPos.x == m_ChunkSize - 1)
-	{
-		const int otherChunkX{ lookUpPos.x == 0 ? pChunk->position.x - 1 : pChunk->position.x + 1 };
+	// Only chunks that the player changed are saved, structures and flowing water are generated again
+	if (isPlaced) GetChunkAt(static_cast<int>(position.x), static_cast<int>(position.z))->isModified = true;
 
-		auto neighbourIt{ std::find_if(begin(m_Chunks), end(m_Chunks), [&](const Chunk& chunk)
-			{
-				return chunk.position.x == otherChunkX && chunk.position.y == pChunk->position.y;
-			}) };
-		auto neighbourWaterIt{ std::find_if(begin(m_WaterChunks), end(m_WaterChunks), [&](const Chunk& chunk)
-			{
-				return chunk.position.x == otherChunkX && chunk.position.y == pChunk->position.y;
-			}) };
+	// Remesh the changed chunks, if this edit is part of a bigger edit this happens when that edit is committed
+	Commit(sceneContext, pRenderer);
 
-		if (neighbourIt != m_Chunks.end())
-			CreateVertices(*neighbourIt, predicateChunks);
-		if (neighbourWaterIt != m_WaterChunks.end())
-			CreateVertices(*neighbourWaterIt, predicateWaterChunks);
-	}
-	// If the block neighbours a chunk in the z direction, reload these chunks as well
-	if (lookUpPos.z == 0 || lookUpPos.z == m_ChunkSize - 1)
-	{
-		const int otherChunkY{ lookUpPos.z == 0 ? pChunk->position.y - 1 : pChunk->position.y + 1 };
+	return isPlaced;
+}
 
-		auto neighbourIt{ std::find_if(begin(m_Chunks), end(m_Chunks), [&](const Chunk& chunk)
-			{
-				return chunk.position.x == pChunk->position.x && chunk.position.y == otherChunkY;
-			}) };
-		auto neighbourWaterIt{ std::find_if(begin(m_WaterChunks), end(m_WaterChunks), [&](const Chunk& chunk)
-			{
-				return chunk.position.x == pChunk->position.x && chunk.position.y == otherChunkY;
-			}) };
+void WorldGenerator::Commit(const SceneContext& sceneContext, WorldRenderer* pRenderer)
+{
+	// A nested edit is remeshed together with the edit around it
+	if (m_EditDepth > 0) --m_EditDepth;
+	if (m_EditDepth > 0) return;
 
-		if (neighbourIt != m_Chunks.end())
-			CreateVertices(*neighbourIt, predicateChunks);
-		if (neighbourWaterIt != m_WaterChunks.end())
-			CreateVertices(*neighbourWaterIt, predicateWaterChunks);
-	}
+	// Edits are shown right away, even next to a chunk that is still being generated
+	MeshDirtyChunks(false, sceneContext, pRenderer);
 }
 
-void WorldGenerator::ReloadChunks(int chunkX, int chunkY)
+bool WorldGenerator::MeshDirtyChunks(bool waitForNeighbours, const SceneContext& sceneContext, WorldRenderer* pRenderer)
 {
-	// Find the chunks with this chunk position
-	auto pChunk{ std::find_if(begin(m_Chunks), end(m_Chunks), [&](const Chunk& chunk)
-		{
-			return chunk.position.x == chunkX && chunk.position.y == chunkY;
-		}) };
-	auto pWaterChunk{ std::find_if(begin(m_WaterChunks), end(m_WaterChunks), [&](const Chunk& chunk)
+	if (m_DirtyChunks.empty()) return false;
+
+	// Remesh every dirty chunk once, every chunk on its own job
+	//	a job only writes to its own chunk and reads the chunks around it
+	for (auto it{ m_DirtyChunks.begin() }; it != m_DirtyChunks.end();)
+	{
+		Chunk* pChunk{ *it };
+		if (waitForNeighbours && !HasNeighbours(*pChunk))
 		{
-			return chunk.position.x == chunkX && chunk.position.y == chunkY;
-		}) };
+			++it;
+			continue;
+		}
+
+		m_JobSystem.Submit([this, pChunk]() { m_MeshedChunks.Push(MeshedChunk{ pChunk, CreateVertices(*pChunk, GetMeshScratch()) }); }, &m_MeshBatch);
+		it = m_DirtyChunks.erase(it);
+	}
+
+	// No chunk can change while the jobs read the chunks around them, so help meshing until every chunk is done
+	m_JobSystem.Wait(m_MeshBatch);
+
+	// Hand the new vertices of the meshed chunks over, the main thread uploads them when it takes the chunks over
+	bool hasMeshedChunks{};
+	MeshedChunk meshedChunk{};
+	while (m_MeshedChunks.Pop(meshedChunk))
+	{
+		// Keep track of the cost of the mesher of each chunk
+		MeshStats& meshStats{ m_MeshStats[meshedChunk.pChunk->useGreedyMesh] };
+		meshStats.nrChunks += meshedChunk.stats.nrChunks;
+		meshStats.nrVertices += meshedChunk.stats.nrVertices;
+		meshStats.totalTime += meshedChunk.stats.totalTime;
+
+		pRenderer->QueueUpload(*meshedChunk.pChunk);
+		hasMeshedChunks = true;
+	}
 
-	// Create a list of chunks to check in the predicate
-	std::vector<std::vector<Chunk>*> predicateChunks{};
-	predicateChunks.push_back(&m_Chunks);
+	return hasMeshedChunks;
+}
 
-	// Create a list of chunks to check in the water predicate
-	std::vector<std::vector<Chunk>*> predicateWaterChunks{};
-	predicateWaterChunks.push_back(&m_Chunks);
-	predicateWaterChunks.push_back(&m_WaterChunks);
+WorldGenerator::MeshScratch& WorldGenerator::GetMeshScratch() const
+{
+	const int workerIdx{ JobSystem::GetWorkerIdx() };
+	if (workerIdx >= 0) return *m_pMeshScratches[workerIdx];
 
-	// Create new vertices for this chunk
-	CreateVertices(*pChunk, predicateChunks);
-	CreateVertices(*pWaterChunk, predicateWaterChunks);
+	// The world thread and the main thread both run queued jobs while they wait for a batch, so they can mesh at the same time
+	//	a scratch is only used during one job, so the generators on the same thread can share it
+	thread_local MeshScratch scratch{};
+	return scratch;
+}
 
-	// Create new vertices for each chunk in a cross around this chunk
+void WorldGenerator::ReloadChunks(int chunkX, int chunkY)
+{
+	// Remesh this chunk and each chunk in a cross around this chunk on the next commit
 	for (int x{ -1 }; x <= 1; ++x)
 	{
 		for (int y{ -1 }; y <= 1; ++y)
 		{
 			if (abs(x) && abs(y)) continue;
 
-			auto neighbourIt{ std::find_if(begin(m_Chunks), end(m_Chunks), [&](const Chunk& chunk)
-				{
-					return chunk.position.x == chunkX + x && chunk.position.y == chunkY + y;
-				}) };
-			auto neighbourWaterIt{ std::find_if(begin(m_WaterChunks), end(m_WaterChunks), [&](const Chunk& chunk)
-				{
-					return chunk.position.x == chunkX + x && chunk.position.y == chunkY + y;
-				}) };
-
-			if (neighbourIt != m_Chunks.end())
-				CreateVertices(*neighbourIt, predicateChunks);
-			if (neighbourWaterIt != m_WaterChunks.end())
-				CreateVertices(*neighbourWaterIt, predicateWaterChunks);
+			MarkDirty(chunkX + x, chunkY + y);
 		}
 	}
 }
@@ -264,15 +256,29 @@ bool WorldGenerator::ChangeEnvironment(const XMINT2& chunkCenter, const SceneCon
 	{
 		for (int z{ minZ }; z < maxZ; ++z)
 		{
+			// If there is no water in this chunk, continue to the next column
+			const Chunk* pChunk{ GetChunkAt(x, z) };
+			if (!pChunk || !pChunk->HasFluid()) continue;
+
+			const int localX{ x - pChunk->position.x * m_ChunkSize };
+			const int localZ{ z - pChunk->position.y * m_ChunkSize };
+
 			for (int y{ m_WorldHeight - 1 }; y >= 0; --y)
 			{
+				// If there is no water in this section, skip to the section underneath
+				if (!pChunk->HasFluidInSection(y / ChunkSection::Size))
+				{
+					y -= y % ChunkSection::Size;
+					continue;
+				}
+
 				const XMINT3 position{ x,y,z };
 
 				// If there is no water block on this position, do nothing
-				if (!m_IsBlockPredicate(m_WaterChunks, position)) continue;
+				if (pChunk->GetFluid(localX, y, localZ) == BlockType::AIR) continue;
 
 				// If there is a block at this position, continue to the next face of the block
-				if (m_IsBlockPredicate(m_Chunks, position))
+				if (pChunk->GetBlock(localX, y, localZ) != BlockType::AIR)
 				{
 					// Add this block to removal
 					removeBlocks.emplace_back(position);
@@ -295,11 +301,18 @@ bool WorldGenerator::ChangeEnvironment(const XMINT2& chunkCenter, const SceneCon
 					// If the neighbouring block is outside recalculate range, continue to the next face of the block
 					if (neighbourPosition.x < minX || neighbourPosition.x >= maxX || neighbourPosition.z < minZ || neighbourPosition.z >= maxZ || neighbourPosition.y < 0) continue;
 
+					// Get the chunk of the neighbouring block, it holds both the block and the fluid
+					const Chunk* pNeighbourChunk{ GetChunkAt(neighbourPosition.x, neighbourPosition.z) };
+					if (!pNeighbourChunk) continue;
+
+					const int neighbourLocalX{ neighbourPosition.x - pNeighbourChunk->position.x * m_ChunkSize };
+					const int neighbourLocalZ{ neighbourPosition.z - pNeighbourChunk->position.y * m_ChunkSize };
+
 					// If there is already a water block on this position, continue to the next face of the block
-					if (m_IsBlockPredicate(m_WaterChunks, neighbourPosition)) continue;
+					if (pNeighbourChunk->GetFluid(neighbourLocalX, neighbourPosition.y, neighbourLocalZ) != BlockType::AIR) continue;
 
 					// If there is a block at this position, continue to the next face of the block
-					if (m_IsBlockPredicate(m_Chunks, neighbourPosition)) continue;
+					if (pNeighbourChunk->GetBlock(neighbourLocalX, neighbourPosition.y, neighbourLocalZ) != BlockType::AIR) continue;
 
 					// Add the block to the list of new blocks
 					newBlocks.emplace_back(neighbourPosition);
@@ -316,46 +329,38 @@ bool WorldGenerator::ChangeEnvironment(const XMINT2& chunkCenter, const SceneCon
 	{
 		std::vector<Chunk*> chunksThatNeedUpdate{};
 
-		// Add the new water blocks to the water object
+		// Add the new water blocks to the fluid layer
 		for (const XMINT3& block : newBlocks)
 		{
-			BlockType* pWaterBlock{ GetBlockInChunk(static_cast<int>(block.x),static_cast<int>(block.y),static_cast<int>(block.z), m_WaterChunks) };
-
-			if (!pWaterBlock) continue;
-
-			*pWaterBlock = m_pWaterBlock.get()->type;
+			if (!SetFluidInChunk(static_cast<int>(block.x), static_cast<int>(block.y), static_cast<int>(block.z), m_pWaterBlock.get()->type)) continue;
 
-			Chunk* pChunk{ GetChunkAt(static_cast<int>(block.x),static_cast<int>(block.z), m_WaterChunks) };
+			Chunk* pChunk{ GetChunkAt(static_cast<int>(block.x),static_cast<int>(block.z)) };
 
 			if (std::find_if(begin(chunksThatNeedUpdate), end(chunksThatNeedUpdate), [pChunk](Chunk* pUpdateChunk) { return pUpdateChunk == pChunk; }) == end(chunksThatNeedUpdate))
 				chunksThatNeedUpdate.push_back(pChunk);
 		}
 
-		// remove the blocks from the water object
+		// remove the blocks from the fluid layer
 		for (const XMINT3& block : removeBlocks)
 		{
-			BlockType* pWaterBlock{ GetBlockInChunk(static_cast<int>(block.x),static_cast<int>(block.y),static_cast<int>(block.z), m_WaterChunks) };
+			SetFluidInChunk(static_cast<int>(block.x), static_cast<int>(block.y), static_cast<int>(block.z), BlockType::AIR);
 
-			*pWaterBlock = BlockType::AIR;
-
-			Chunk* pChunk{ GetChunkAt(static_cast<int>(block.x),static_cast<int>(block.z), m_WaterChunks) };
+			Chunk* pChunk{ GetChunkAt(static_cast<int>(block.x),static_cast<int>(block.z)) };
 
 			if (std::find_if(begin(chunksThatNeedUpdate), end(chunksThatNeedUpdate), [pChunk](Chunk* pUpdateChunk) { return pUpdateChunk == pChunk; }) == end(chunksThatNeedUpdate))
 				chunksThatNeedUpdate.push_back(pChunk);
 		}
 
-		// Reload the water vertices
-		std::vector<std::vector<Chunk>*> predicateChunks{};
-		predicateChunks.push_back(&m_Chunks);
-		predicateChunks.push_back(&m_WaterChunks);
+		// Reload the water vertices, every chunk on its own job
 		for (Chunk* pChunk : chunksThatNeedUpdate)
 		{
-			CreateVertices(*pChunk, predicateChunks);
+			m_JobSystem.Submit([this, pChunk]() { CreateWaterVertices(*pChunk, GetMeshScratch()); }, &m_MeshBatch);
 		}
+		m_JobSystem.Wait(m_MeshBatch);
 
 		for (Chunk* pChunk : chunksThatNeedUpdate)
 		{
-			pRenderer->SetBuffer(*pChunk, sceneContext);
+			pRenderer->QueueUpload(*pChunk);
 		}
 	}
 
@@ -363,166 +368,707 @@ bool WorldGenerator::ChangeEnvironment(const XMINT2& chunkCenter, const SceneCon
 	return changedEnvironment;
 }
 
-void WorldGenerator::CreateVertices(Chunk& chunk, const std::vector<std::vector<Chunk>*>& predicateChunks)
+WorldGenerator::MeshStats WorldGenerator::CreateVertices(Chunk& chunk, MeshScratch& scratch) const
 {
-	if (chunk.blocks.empty()) return;
+	MeshStats meshStats{};
+	if (chunk.sections.empty()) return meshStats;
+
+	// Changed blocks can hide or reveal water faces, so the water of the dirty sections is remeshed as well
+	CreateWaterVertices(chunk, scratch);
+
+	if (!chunk.dirtySectionBits) return meshStats;
 
 	// Notify the chunks that the vertices have been changed
 	chunk.verticesChanged = true;
 	chunk.needColliderChange = true;
 
-	// Get the cube and cross vertices
-	BlockManager* pBlockManager{ BlockManager::Get() };
-	const auto& cubeVertices = pBlockManager->GetVertices("cube");
-	const auto& crossVertices = pBlockManager->GetVertices("cross");
+	// Only remesh the sections that have been changed, the other sections keep their vertices
+	const auto meshStart{ std::chrono::high_resolution_clock::now() };
+	const uint32_t dirtyBits{ chunk.dirtySectionBits };
+	CreateSectionVertices(chunk, false, dirtyBits, scratch);
+	chunk.dirtySectionBits = 0;
+
+	// The faces that see each other through a section only change with its blocks
+	const bool* pIsOpaqueCube{ BlockManager::Get()->GetOpaqueCubeTable() };
+	for (size_t sectionIdx{}; sectionIdx < chunk.sections.size(); ++sectionIdx)
+	{
+		if ((dirtyBits >> sectionIdx) & 1U) chunk.sectionVisibility[sectionIdx].Build(chunk.sections[sectionIdx], pIsOpaqueCube);
+	}
+
+	// Keep track of the cost of the mesher of this chunk
+	const std::chrono::duration<double, std::milli> meshTime{ std::chrono::high_resolution_clock::now() - meshStart };
+	++meshStats.nrChunks;
+	for (size_t sectionIdx{}; sectionIdx < chunk.sectionMeshes.size(); ++sectionIdx)
+	{
+		if (!((dirtyBits >> sectionIdx) & 1U)) continue;
+
+		for (const std::vector<ChunkVertex>& layerVertices : chunk.sectionMeshes[sectionIdx].vertices) meshStats.nrVertices += static_cast<int64_t>(layerVertices.size());
+	}
+	meshStats.totalTime += meshTime.count();
+
+	// Join the vertices of all sections into the lists of the chunk, clearing keeps the memory of the previous mesh
+	//	the start of every section is kept, so the renderer can draw the sections on their own
+	for (int layerIdx{}; layerIdx < Chunk::NrMeshLayers; ++layerIdx)
+	{
+		std::vector<ChunkVertex>& layerVertices{ chunk.vertices[layerIdx] };
+		std::vector<int>& sectionStarts{ chunk.sectionVertexStarts[layerIdx] };
+		layerVertices.clear();
+		sectionStarts.clear();
+
+		for (const Chunk::SectionMesh& sectionMesh : chunk.sectionMeshes)
+		{
+			sectionStarts.emplace_back(static_cast<int>(layerVertices.size()));
+			layerVertices.insert(end(layerVertices), begin(sectionMesh.vertices[layerIdx]), end(sectionMesh.vertices[layerIdx]));
+		}
+		sectionStarts.emplace_back(static_cast<int>(layerVertices.size()));
+	}
+
+	// The renderer skips the chunk when this box is out of view
+	chunk.bounds = ChunkVertex::GetBounds(chunk.vertices.data(), chunk.vertices.size());
+
+	return meshStats;
+}
+
+void WorldGenerator::CreateWaterVertices(Chunk& chunk, MeshScratch& scratch) const
+{
+	if (!chunk.HasFluid() || !chunk.dirtyFluidSectionBits) return;
+
+	// Notify the chunk that the water vertices have been changed
+	chunk.waterVerticesChanged = true;
 
-	std::vector<VertexPosNormTexTransparency> vertices{};
+	// Only remesh the sections that have been changed
+	CreateSectionVertices(chunk, true, chunk.dirtyFluidSectionBits, scratch);
+	chunk.dirtyFluidSectionBits = 0;
 
-	// Load vertices for each chunk depending on the mesh
+	// Join the water of all sections, clearing keeps the memory of the previous mesh
+	chunk.waterVertices.clear();
+	for (const Chunk::SectionMesh& sectionMesh : chunk.sectionMeshes)
+	{
+		chunk.waterVertices.insert(end(chunk.waterVertices), begin(sectionMesh.waterVertices), end(sectionMesh.waterVertices));
+	}
+	chunk.waterBounds = ChunkVertex::GetBounds(&chunk.waterVertices, 1);
+}
+
+void WorldGenerator::CreateSectionVertices(Chunk& chunk, bool isFluidLayer, uint32_t dirtyBits, MeshScratch& scratch) const
+{
+	const BlockManager* pBlockManager{ BlockManager::Get() };
+
+	const std::vector<ChunkSection>& sections{ isFluidLayer ? chunk.fluidSections : chunk.sections };
+	const uint32_t sectionBits{ isFluidLayer ? chunk.fluidSectionBits : chunk.sectionBits };
+
+	// The column maps only describe the block layer
+	const bool useColumnMaps{ !isFluidLayer };
+
+	// Only the block layer can be merged, water has its own top offset
+	const bool useGreedyMesh{ useColumnMaps && chunk.useGreedyMesh };
+
+	// Find the visible faces of every cube in this layer at once
+	const std::array<const Chunk*, 4> pNeighbours
+	{
+		m_Chunks.Find(chunk.position.x, chunk.position.y + 1),
+		m_Chunks.Find(chunk.position.x, chunk.position.y - 1),
+		m_Chunks.Find(chunk.position.x + 1, chunk.position.y),
+		m_Chunks.Find(chunk.position.x - 1, chunk.position.y)
+	};
+
+	// The borders with chunks of another level of detail hang down as skirts
+	SkirtBottoms skirtBottoms{};
+	bool hasSkirts{};
+	if (!isFluidLayer)
+	{
+		skirtBottoms = GetSkirtBottoms(chunk, pNeighbours);
+		for (const auto& bottoms : skirtBottoms) hasSkirts = hasSkirts || bottoms[0] != INT_MAX;
+	}
+
+	// Chunks with a lower level of detail merge their blocks into cells, only the water keeps its full resolution
+	if (!isFluidLayer && chunk.lodLevel > 0)
+	{
+		for (int sectionIdx{}; sectionIdx < static_cast<int>(sections.size()); ++sectionIdx)
+		{
+			if (!((dirtyBits >> sectionIdx) & 1U)) continue;
+
+			Chunk::SectionMesh& sectionMesh{ chunk.sectionMeshes[sectionIdx] };
+			for (std::vector<ChunkVertex>& layerVertices : sectionMesh.vertices) layerVertices.clear();
+
+			if (chunk.HasBlocksInSection(sectionIdx)) CreateLodSectionVertices(chunk, sectionIdx, pNeighbours, skirtBottoms, sectionMesh.vertices[static_cast<int>(MeshLayer::SOLID)]);
+		}
+
+		return;
+	}
+
+	scratch.faceMasks.Build(chunk, pNeighbours, isFluidLayer, dirtyBits);
+	if (useGreedyMesh && scratch.greedyFaces.size() != static_cast<size_t>(6 * m_WorldHeight * m_ChunkSize * m_ChunkSize))
+		scratch.greedyFaces.assign(static_cast<size_t>(6 * m_WorldHeight * m_ChunkSize * m_ChunkSize), 0);
+
+	// The faces of the skirt on each border of this column
+	const auto getSkirtFaces{ [&](int x, int y, int z)
+		{
+			uint8_t skirtFaces{};
+			if (z == m_ChunkSize - 1 && y >= skirtBottoms[static_cast<int>(FaceDirection::FORWARD)][x]) skirtFaces |= 1U << static_cast<int>(FaceDirection::FORWARD);
+			if (z == 0 && y >= skirtBottoms[static_cast<int>(FaceDirection::BACK)][x]) skirtFaces |= 1U << static_cast<int>(FaceDirection::BACK);
+			if (x == m_ChunkSize - 1 && y >= skirtBottoms[static_cast<int>(FaceDirection::RIGHT)][z]) skirtFaces |= 1U << static_cast<int>(FaceDirection::RIGHT);
+			if (x == 0 && y >= skirtBottoms[static_cast<int>(FaceDirection::LEFT)][z]) skirtFaces |= 1U << static_cast<int>(FaceDirection::LEFT);
+
+			return skirtFaces;
+		} };
+
+	// Calculate which heights of each column can have visible faces
+	std::array<int, ChunkSection::Size * ChunkSection::Size> minYs{};
+	std::array<int, ChunkSection::Size * ChunkSection::Size> maxYs{};
 	for (int x{}; x < m_ChunkSize; ++x)
 	{
 		for (int z{}; z < m_ChunkSize; ++z)
 		{
-			for (int y{ m_WorldHeight - 1 }; y >= 0; --y)
+			const int columnIdx{ Chunk::GetColumnIdx(x, z) };
+
+			if (useColumnMaps) GetMeshRange(chunk, x, z, minYs[columnIdx], maxYs[columnIdx]);
+			else maxYs[columnIdx] = m_WorldHeight - 1;
+
+			// The skirt can reach below the faces that are visible
+			if (hasSkirts)
 			{
-				Block* pBlock{ pBlockManager->GetBlock(chunk.blocks[x + z * m_ChunkSize + y * m_ChunkSize * m_ChunkSize]) };
+				if (z == m_ChunkSize - 1) minYs[columnIdx] = std::min(minYs[columnIdx], skirtBottoms[static_cast<int>(FaceDirection::FORWARD)][x]);
+				if (z == 0) minYs[columnIdx] = std::min(minYs[columnIdx], skirtBottoms[static_cast<int>(FaceDirection::BACK)][x]);
+				if (x == m_ChunkSize - 1) minYs[columnIdx] = std::min(minYs[columnIdx], skirtBottoms[static_cast<int>(FaceDirection::RIGHT)][z]);
+				if (x == 0) minYs[columnIdx] = std::min(minYs[columnIdx], skirtBottoms[static_cast<int>(FaceDirection::LEFT)][z]);
+				minYs[columnIdx] = std::max(minYs[columnIdx], 0);
+			}
+		}
+	}
+
+	// Load vertices for each section depending on the mesh
+	for (int sectionIdx{ static_cast<int>(sections.size()) - 1 }; sectionIdx >= 0; --sectionIdx)
+	{
+		// Sections that haven't been changed keep their vertices
+		if (!((dirtyBits >> sectionIdx) & 1U)) continue;
+
+		// Every block writes straight into the list of its mesh layer of this section
+		//	the fluid layer only holds water, so every mesh layer goes into the water vertices
+		Chunk::SectionMesh& sectionMesh{ chunk.sectionMeshes[sectionIdx] };
+		std::array<std::vector<ChunkVertex>*, Chunk::NrMeshLayers> pLayerVertices{ &sectionMesh.waterVertices, &sectionMesh.waterVertices, &sectionMesh.waterVertices };
+		if (!isFluidLayer)
+		{
+			for (int layerIdx{}; layerIdx < Chunk::NrMeshLayers; ++layerIdx) pLayerVertices[layerIdx] = &sectionMesh.vertices[layerIdx];
+		}
+		for (std::vector<ChunkVertex>* pVertices : pLayerVertices) pVertices->clear();
+
+		// Sections with only air don't have any vertices
+		if (!((sectionBits >> sectionIdx) & 1U)) continue;
 
-				if (!pBlock) continue;
+		const ChunkSection& section{ sections[sectionIdx] };
+		if (section.IsEmpty()) continue;
 
-				switch (pBlock->mesh)
+		// In a section filled with one opaque cube block (or water), faces between blocks are never visible
+		//	so only the blocks on the border of the section need to be checked
+		bool onlyBorder{};
+		if (section.IsUniform())
+		{
+			const BlockType uniformBlock{ section.GetUniformBlock() };
+			onlyBorder = pBlockManager->IsOpaqueCube(uniformBlock) || uniformBlock == BlockType::WATER;
+		}
+
+		const int sectionY{ sectionIdx * ChunkSection::Size };
+		for (int x{}; x < m_ChunkSize; ++x)
+		{
+			for (int z{}; z < m_ChunkSize; ++z)
+			{
+				const bool isBorderColumn{ x == 0 || z == 0 || x == m_ChunkSize - 1 || z == m_ChunkSize - 1 };
+
+				// Get the mesh range of this column relative to the section
+				const int columnIdx{ Chunk::GetColumnIdx(x, z) };
+				const int minY{ minYs[columnIdx] - sectionY };
+				const int maxY{ maxYs[columnIdx] - sectionY };
+
+				for (int y{ std::min(maxY, ChunkSection::Size - 1) }; y >= 0; --y)
 				{
-				case BlockMesh::CUBE:
-					CreateVerticesCube(chunk, x, y, z, predicateChunks, pBlock, vertices, cubeVertices);
-					break;
-				case BlockMesh::CROSS:
-					CreateVerticesCross(chunk, x, y, z, pBlock, vertices, crossVertices);
+					// Blocks underneath the mesh range are hidden, only the bottom of the world stays visible
+					if (y < minY)
+					{
+						if (sectionIdx > 0) break;
+						y = 0;
+					}
+
+					// Skip to the bottom of the section for columns inside the section
+					if (onlyBorder && !isBorderColumn && y != 0 && y != ChunkSection::Size - 1) y = 0;
+
+					// Cubes that are hidden on every side don't have faces, so their block doesn't have to be looked up
+					uint8_t visibleFaces{ scratch.faceMasks.GetVisibleFaces(x, sectionY + y, z) };
+					if (hasSkirts && isBorderColumn && scratch.faceMasks.IsCube(x, sectionY + y, z)) visibleFaces |= getSkirtFaces(x, sectionY + y, z);
+					if (!visibleFaces && scratch.faceMasks.IsCube(x, sectionY + y, z)) continue;
+
+					const BlockType block{ section.GetBlock(x, y, z) };
+
+					// Air and block types that aren't registered don't have a mesh
+					if (block == BlockType::AIR || !pBlockManager->GetBlock(block)) continue;
+
+					const MeshLayer layer{ pBlockManager->GetMeshLayer(block) };
+					std::vector<ChunkVertex>& vertices{ *pLayerVertices[static_cast<int>(layer)] };
+
+					switch (pBlockManager->GetMesh(block))
+					{
+					case BlockMesh::CUBE:
+						// The masks of the block layer hide faces behind opaque cubes, water in the block layer is hidden by every cube
+						//	a face that is hidden behind an opaque cube is hidden for water as well, so only the visible faces are checked again
+						if (!isFluidLayer && block == BlockType::WATER)
+						{
+							for (int i{}; i <= static_cast<int>(FaceDirection::BOTTOM); ++i)
+							{
+								if (((visibleFaces >> i) & 1U) && !IsFaceVisible(chunk, x, sectionY + y, z, block, i)) visibleFaces &= static_cast<uint8_t>(~(1U << i));
+							}
+						}
+
+						// Solid faces are merged after all blocks are visited, cutout and translucent faces aren't merged
+						if (useGreedyMesh && layer == MeshLayer::SOLID) AddGreedyFaces(x, sectionY + y, z, block, visibleFaces, scratch);
+						else CreateVerticesCube(chunk, x, sectionY + y, z, block, visibleFaces, vertices);
+						break;
+					case BlockMesh::CROSS:
+						CreateVerticesCross(chunk, x, sectionY + y, z, block, vertices);
+					}
 				}
 			}
 		}
-	}
 
-	// Store the vertices in the chunk
-	chunk.vertices = std::move(vertices);
+		// Merge the collected opaque faces of this section into as few quads as possible
+		//	quads don't cross the border of the section, so the section can be remeshed on its own
+		if (useGreedyMesh) CreateGreedyVertices(chunk, *pLayerVertices[static_cast<int>(MeshLayer::SOLID)], scratch);
+	}
 }
 
-void WorldGenerator::CreateVerticesCube(Chunk& chunk, int x, int y, int z, const std::vector<std::vector<Chunk>*>& predicateChunks, Block* pBlock, std::vector<VertexPosNormTexTransparency>& vertices, const std::vector<VertexPosNormTexTransparency>& cubeVertices)
+bool WorldGenerator::IsFaceVisible(const Chunk& chunk, int x, int y, int z, BlockType block, int faceIdx) const
 {
-	// Calculate the world position
-	const XMINT3 position{ chunk.position.x * m_ChunkSize + x, y, chunk.position.y * m_ChunkSize + z };
-	const XMVECTOR positionVector = XMLoadSInt3(&position);
+	const bool isWater{ block == BlockType::WATER };
 
-	// For each side of the cube
-	for (unsigned int i{}; i <= static_cast<unsigned int>(FaceDirection::BOTTOM); ++i)
+	// Calculate the neighbour position
+	const XMINT3& neighbourDirection{ m_NeighbouringBlocks[faceIdx] };
+	const XMINT3 neighbourPosition{ x + neighbourDirection.x, y + neighbourDirection.y, z + neighbourDirection.z };
+
+	// Get the neighbouring block and fluid
+	//	Neighbours inside this chunk are read directly, other neighbours are looked up in the neighbouring chunk
+	BlockType neighbourBlock{ BlockType::AIR };
+	BlockType neighbourFluid{ BlockType::AIR };
+	if (neighbourPosition.y >= 0 && neighbourPosition.y < m_WorldHeight)
+	{
+		if (neighbourPosition.x >= 0 && neighbourPosition.x < m_ChunkSize && neighbourPosition.z >= 0 && neighbourPosition.z < m_ChunkSize)
+		{
+			neighbourBlock = chunk.GetBlock(neighbourPosition.x, neighbourPosition.y, neighbourPosition.z);
+			if (isWater) neighbourFluid = chunk.GetFluid(neighbourPosition.x, neighbourPosition.y, neighbourPosition.z);
+		}
+		else
+		{
+			const int worldX{ chunk.position.x * m_ChunkSize + neighbourPosition.x };
+			const int worldZ{ chunk.position.y * m_ChunkSize + neighbourPosition.z };
+
+			neighbourBlock = GetBlockInChunk(worldX, neighbourPosition.y, worldZ);
+			if (isWater) neighbourFluid = GetFluidInChunk(worldX, neighbourPosition.y, worldZ);
+		}
+	}
+
+	// Water faces are hidden by blocks and by other water, other faces only by blocks
+	bool canRender{ m_CanRenderPredicate(neighbourBlock, block) };
+	if (canRender && isWater) canRender = m_CanRenderPredicate(neighbourFluid, block);
+
+	return canRender;
+}
+
+WorldGenerator::SkirtBottoms WorldGenerator::GetSkirtBottoms(const Chunk& chunk, const std::array<const Chunk*, 4>& pNeighbours) const
+{
+	SkirtBottoms skirtBottoms{};
+	for (int dirIdx{}; dirIdx < static_cast<int>(pNeighbours.size()); ++dirIdx)
 	{
-		// Get the neighbour direction
-		const XMINT3& neightbourDirection{ m_NeighbouringBlocks[i] };
+		std::array<int, ChunkSection::Size>& bottoms{ skirtBottoms[dirIdx] };
 
-		// Calculate the neighbour position
-		const XMVECTOR neighbourDirection{ XMLoadSInt3(&neightbourDirection) };
-		const XMVECTOR neighbourPosVector{ XMVectorAdd(positionVector, neighbourDirection) };
-		XMINT3 neighbourPosition;
-		XMStoreSInt3(&neighbourPosition, neighbourPosVector);
+		// Only a border with a chunk of another level of detail has a skirt
+		const Chunk* pNeighbour{ pNeighbours[dirIdx] };
+		if (!pNeighbour || pNeighbour->lodLevel == chunk.lodLevel)
+		{
+			bottoms.fill(INT_MAX);
+			continue;
+		}
 
-		// Check all the chunks if the current face can be rendered
-		bool canRender{ true };
-		for (const auto& chunks : predicateChunks)
+		// The skirt reaches from the surface to one cell of the coarsest level below the lowest surface on either side of the border
+		const int cellSize{ 1 << std::max(chunk.lodLevel, pNeighbour->lodLevel) };
+		const XMINT3& direction{ m_NeighbouringBlocks[dirIdx] };
+		for (int a{}; a < m_ChunkSize; ++a)
 		{
-			if (!m_CanRenderPredicate(*chunks, neighbourPosition, pBlock->type))
+			// The column on the border of this chunk and the column next to it in the neighbour
+			const int x{ direction.x == 0 ? a : (direction.x > 0 ? m_ChunkSize - 1 : 0) };
+			const int z{ direction.z == 0 ? a : (direction.z > 0 ? m_ChunkSize - 1 : 0) };
+			const int neighbourX{ (x + direction.x + m_ChunkSize) % m_ChunkSize };
+			const int neighbourZ{ (z + direction.z + m_ChunkSize) % m_ChunkSize };
+
+			bottoms[a] = std::min(chunk.GetHeight(x, z), pNeighbour->GetHeight(neighbourX, neighbourZ)) - cellSize;
+		}
+	}
+
+	return skirtBottoms;
+}
+
+BlockType WorldGenerator::SampleLodCell(const Chunk& chunk, int cellX, int cellY, int cellZ, int cellSize) const
+{
+	const BlockManager* pBlockManager{ BlockManager::Get() };
+
+	// A cell never crosses the border of a section
+	const int minY{ cellY * cellSize };
+	if (!chunk.HasBlocksInSection(minY / ChunkSection::Size)) return BlockType::AIR;
+
+	// Count the cubes from the top down, so the first cube is the surface of the cell
+	int nrCubes{};
+	BlockType topBlock{ BlockType::AIR };
+	for (int y{ minY + cellSize - 1 }; y >= minY; --y)
+	{
+		for (int z{ cellZ * cellSize }; z < (cellZ + 1) * cellSize; ++z)
+		{
+			for (int x{ cellX * cellSize }; x < (cellX + 1) * cellSize; ++x)
 			{
-				canRender = false;
-				break;
+				const BlockType block{ chunk.GetBlock(x, y, z) };
+				if (block == BlockType::WATER || !pBlockManager->IsCube(block)) continue;
+
+				if (topBlock == BlockType::AIR) topBlock = block;
+				++nrCubes;
 			}
 		}
+	}
 
-		// If this face cannot be rendered, continue to the next face
-		if (!canRender) continue;
+	// A cell that is at least half cubes looks like its surface block
+	return nrCubes * 2 >= cellSize * cellSize * cellSize ? topBlock : BlockType::AIR;
+}
+
+void WorldGenerator::CreateLodSectionVertices(const Chunk& chunk, int sectionIdx, const std::array<const Chunk*, 4>& pNeighbours, const SkirtBottoms& skirtBottoms, std::vector<ChunkVertex>& vertices) const
+{
+	// Every block that isn't air hides the faces next to it, this one marks the cells that only hide faces
+	constexpr BlockType occluder{ BlockType::BEDROCK };
+	constexpr int maxPaddedSize{ ChunkSection::Size / 2 + 2 };
 
-		constexpr int faceIndices[6]{ 0,1,2,3,2,1 };
+	const ChunkVertex::FaceData& faceData{ ChunkVertex::GetFaceData() };
+
+	const int cellSize{ 1 << chunk.lodLevel };
+	const int nrCells{ ChunkSection::Size / cellSize };
+	const int nrCellRows{ m_WorldHeight / cellSize };
+	const int sectionCellY{ sectionIdx * nrCells };
+
+	// The cells of this section with one cell of padding on every side, the padding holds the cells that can hide the faces on the border
+	std::array<BlockType, maxPaddedSize * maxPaddedSize * maxPaddedSize> cells{};
+	const int paddedSize{ nrCells + 2 };
+	const auto getCellIdx{ [paddedSize](int x, int y, int z) { return ((y + 1) * paddedSize + z + 1) * paddedSize + x + 1; } };
+
+	// The cells of this section and the layers of cells above and below it
+	for (int y{ -1 }; y <= nrCells; ++y)
+	{
+		// Nothing is seen underneath the world, the top of the world stays open
+		const int cellY{ sectionCellY + y };
+		if (cellY >= nrCellRows) continue;
 
-		// For each vertex
-		VertexPosNormTexTransparency v{};
-		for (int vIdx : faceIndices)
+		for (int z{}; z < nrCells; ++z)
 		{
-			// Get the current vertex
-			v = cubeVertices[i * 4 + vIdx];
+			for (int x{}; x < nrCells; ++x) cells[getCellIdx(x, y, z)] = cellY < 0 ? occluder : SampleLodCell(chunk, x, cellY, z, cellSize);
+		}
+	}
+
+	// The cells of the neighbouring chunks next to the border
+	for (int dirIdx{}; dirIdx < static_cast<int>(pNeighbours.size()); ++dirIdx)
+	{
+		// Faces next to a chunk that isn't loaded are always visible
+		const Chunk* pNeighbour{ pNeighbours[dirIdx] };
+		if (!pNeighbour) continue;
 
-			// If the current block is water and there is no block on top, add a small offset to the top face of the water
-			if (pBlock->type == BlockType::WATER && !m_IsBlockPredicate(m_WaterChunks, { x,y + 1,z }))
+		const XMINT3& direction{ m_NeighbouringBlocks[dirIdx] };
+		for (int y{}; y < nrCells; ++y)
+		{
+			for (int a{}; a < nrCells; ++a)
 			{
-				constexpr float waterOffset{ 0.125 };
-				if (v.Position.y > 0.0f) v.Position.y -= waterOffset;
+				// The cell on the border of this chunk and the padding cell next to it
+				const int x{ direction.x == 0 ? a : (direction.x > 0 ? nrCells - 1 : 0) };
+				const int z{ direction.z == 0 ? a : (direction.z > 0 ? nrCells - 1 : 0) };
+				BlockType& paddingCell{ cells[getCellIdx(x + direction.x, y, z + direction.z)] };
+
+				// A neighbour of the same level hides faces like the cells of this chunk
+				if (pNeighbour->lodLevel == chunk.lodLevel)
+				{
+					paddingCell = SampleLodCell(*pNeighbour, (x + direction.x + nrCells) % nrCells, sectionCellY + y, (z + direction.z + nrCells) % nrCells, cellSize);
+					continue;
+				}
+
+				// On the border with another level only the faces of the skirt are visible
+				int skirtBottom{ INT_MAX };
+				for (int blockA{ a * cellSize }; blockA < (a + 1) * cellSize; ++blockA) skirtBottom = std::min(skirtBottom, skirtBottoms[dirIdx][blockA]);
+
+				const int cellTop{ (sectionCellY + y + 1) * cellSize - 1 };
+				if (cellTop < skirtBottom) paddingCell = occluder;
 			}
+		}
+	}
 
-			// Calculate the world position of the vertex
-			XMVECTOR pos{ XMLoadFloat3(&v.Position) };
-			pos += XMVECTOR{ static_cast<float>(x),static_cast<float>(y),static_cast<float>(z) }
-				+ XMVECTOR{ static_cast<float>(chunk.position.x * m_ChunkSize), 0.0f, static_cast<float>(chunk.position.y * m_ChunkSize) };
-			XMStoreFloat3(&v.Position, pos);
+	// Add the visible faces of every cell
+	for (int y{}; y < nrCells; ++y)
+	{
+		for (int z{}; z < nrCells; ++z)
+		{
+			for (int x{}; x < nrCells; ++x)
+			{
+				const BlockType block{ cells[getCellIdx(x, y, z)] };
+				if (block == BlockType::AIR) continue;
+
+				for (int i{}; i <= static_cast<int>(FaceDirection::BOTTOM); ++i)
+				{
+					const XMINT3& direction{ m_NeighbouringBlocks[i] };
+					if (cells[getCellIdx(x + direction.x, y + direction.y, z + direction.z)] != BlockType::AIR) continue;
+
+					const FaceType faceType{ TileAtlas::GetFaceType(block, static_cast<FaceDirection>(i)) };
 
-			// Calculate the UV coordinate of the vertex
-			v.TexCoord = m_TileMap.GetUV(m_TileMap.GetFaceType(pBlock->type, static_cast<FaceDirection>(i)), v.TexCoord);
+					// For each corner
+					ChunkVertex corners[QuadMesh::NrVerticesPerQuad]{};
+					for (int vIdx{}; vIdx < QuadMesh::NrVerticesPerQuad; ++vIdx)
+					{
+						const int cornerIdx{ i * ChunkVertex::NrCorners + vIdx };
 
-			// Set the transparency of this vertex
-			v.Transparent = pBlock->transparent;
+						// Stretch the face of a block over the whole cell
+						const XMINT3& cornerCell{ faceData.cornerCells[cornerIdx] };
+						const XMINT3 cell{ (x + cornerCell.x) * cellSize, (sectionCellY + y + cornerCell.y) * cellSize, (z + cornerCell.z) * cellSize };
 
-			// Add the vertex to the list
-			vertices.emplace_back(v);
+						// Repeat the texture once for every block along the cell
+						const XMINT2 faceUV{ faceData.cornerUVs[cornerIdx].x * cellSize, faceData.cornerUVs[cornerIdx].y * cellSize };
+
+						corners[vIdx] = ChunkVertex{ cell, i, vIdx, faceType, faceUV, false };
+					}
+
+					QuadMesh::AddQuad(vertices, corners);
+				}
+			}
 		}
 	}
 }
 
-void WorldGenerator::CreateVerticesCross(Chunk& chunk, int x, int y, int z, Block* pBlock, std::vector<VertexPosNormTexTransparency>& vertices, const std::vector<VertexPosNormTexTransparency>& crossVertices)
+void WorldGenerator::AddGreedyFaces(int x, int y, int z, BlockType block, uint8_t visibleFaces, MeshScratch& scratch) const
 {
-	// Calculate the world position
-	const XMINT3 position{ chunk.position.x * m_ChunkSize + x, y, chunk.position.y * m_ChunkSize + z };
+	if (!visibleFaces) return;
 
-	// For each face
-	for (int faceIdx{}; faceIdx < static_cast<int>(crossVertices.size()) / 4; ++faceIdx)
+	// Store the tile of every visible face, zero means that there is no face
+	for (int i{}; i <= static_cast<int>(FaceDirection::BOTTOM); ++i)
 	{
-		// Add all the vertices to the list
-		constexpr int faceIndices[6]{ 0,1,2,3,2,1 };
-		VertexPosNormTexTransparency v{};
-		for (int vIdx : faceIndices)
+		if (!((visibleFaces >> i) & 1U)) continue;
+
+		const FaceType faceType{ TileAtlas::GetFaceType(block, static_cast<FaceDirection>(i)) };
+		scratch.greedyFaces[GetGreedyFaceIdx(i, XMINT3{ x, y, z })] = static_cast<uint16_t>(static_cast<int>(faceType) + 1);
+	}
+
+	// Only the heights with faces have to be merged
+	scratch.greedyMinY = std::min(scratch.greedyMinY, y);
+	scratch.greedyMaxY = std::max(scratch.greedyMaxY, y);
+}
+
+void WorldGenerator::CreateGreedyVertices(const Chunk& chunk, std::vector<ChunkVertex>& vertices, MeshScratch& scratch) const
+{
+	if (scratch.greedyMinY > scratch.greedyMaxY) return;
+
+	const ChunkVertex::FaceData& faceData{ ChunkVertex::GetFaceData() };
+
+	const auto getComponent{ [](XMINT3& vector, int axis) -> int&
 		{
-			// Get the current vertex
-			v = crossVertices[faceIdx * 4 + vIdx];
+			switch (axis)
+			{
+			case 0: return vector.x;
+			case 1: return vector.y;
+			default: return vector.z;
+			}
+		} };
+
+	// For each face direction
+	for (int i{}; i <= static_cast<int>(FaceDirection::BOTTOM); ++i)
+	{
+		const FaceDirection direction{ static_cast<FaceDirection>(i) };
 
-			// Calculate the world position
-			XMVECTOR pos{ XMLoadFloat3(&v.Position) };
-			pos += XMVECTOR{ static_cast<float>(position.x),static_cast<float>(position.y),static_cast<float>(position.z) };
-			XMStoreFloat3(&v.Position, pos);
+		// Faces are merged inside slices along the normal of the face
+		//	up and bottom faces are merged along x (axis a) and z (axis b) in every height
+		//	forward and back faces are merged along x and y in every z, right and left faces along z and y in every x
+		const bool isHorizontal{ direction == FaceDirection::UP || direction == FaceDirection::BOTTOM };
+		const bool isAlongX{ isHorizontal || direction == FaceDirection::FORWARD || direction == FaceDirection::BACK };
+		const int axisA{ isAlongX ? 0 : 2 };
+		const int axisB{ isHorizontal ? 2 : 1 };
 
-			// Calculate the UV coordinates
-			v.TexCoord = m_TileMap.GetUV(m_TileMap.GetFaceType(pBlock->type, FaceDirection::FORWARD), v.TexCoord);
+		const int nrSlices{ isHorizontal ? scratch.greedyMaxY - scratch.greedyMinY + 1 : m_ChunkSize };
+		const int minB{ isHorizontal ? 0 : scratch.greedyMinY };
+		const int maxB{ isHorizontal ? m_ChunkSize - 1 : scratch.greedyMaxY };
 
-			// Set the transparency
-			v.Transparent = pBlock->transparent;
+		const auto getFace{ [&](int slice, int a, int b) -> uint16_t&
+			{
+				if (isHorizontal) return scratch.greedyFaces[GetGreedyFaceIdx(i, XMINT3{ a, scratch.greedyMinY + slice, b })];
+				if (isAlongX) return scratch.greedyFaces[GetGreedyFaceIdx(i, XMINT3{ a, b, slice })];
+				return scratch.greedyFaces[GetGreedyFaceIdx(i, XMINT3{ slice, b, a })];
+			} };
+
+		// Find out which axis the horizontal texture coordinate follows
+		//	two corners with a different horizontal but the same vertical texture coordinate only differ along that axis
+		bool isUVAlongA{};
+		for (int cornerIdx{ 1 }; cornerIdx < ChunkVertex::NrCorners; ++cornerIdx)
+		{
+			const XMINT2& firstUV{ faceData.cornerUVs[i * ChunkVertex::NrCorners] };
+			const XMINT2& otherUV{ faceData.cornerUVs[i * ChunkVertex::NrCorners + cornerIdx] };
+			if (firstUV.x == otherUV.x || firstUV.y != otherUV.y) continue;
 
-			// Add the vertices to the list
-			vertices.emplace_back(v);
+			XMINT3 firstCell{ faceData.cornerCells[i * ChunkVertex::NrCorners] };
+			XMINT3 otherCell{ faceData.cornerCells[i * ChunkVertex::NrCorners + cornerIdx] };
+			isUVAlongA = getComponent(firstCell, axisA) != getComponent(otherCell, axisA);
+			break;
+		}
+
+		for (int slice{}; slice < nrSlices; ++slice)
+		{
+			for (int b{ minB }; b <= maxB; ++b)
+			{
+				for (int a{}; a < m_ChunkSize; ++a)
+				{
+					const uint16_t face{ getFace(slice, a, b) };
+					if (!face) continue;
+
+					// Grow the quad along axis a while the faces have the same tile
+					int width{ 1 };
+					while (a + width < m_ChunkSize && getFace(slice, a + width, b) == face) ++width;
+
+					// Grow the quad along axis b while the whole next row has the same tile
+					int height{ 1 };
+					for (; b + height <= maxB; ++height)
+					{
+						bool isRowEqual{ true };
+						for (int rowA{ a }; rowA < a + width && isRowEqual; ++rowA) isRowEqual = getFace(slice, rowA, b + height) == face;
+
+						if (!isRowEqual) break;
+					}
+
+					// Clear the merged faces so they aren't used again
+					for (int quadB{ b }; quadB < b + height; ++quadB)
+					{
+						for (int quadA{ a }; quadA < a + width; ++quadA) getFace(slice, quadA, quadB) = 0;
+					}
+
+					// Get the block position of the first face of the quad
+					XMINT3 quadPosition{};
+					if (isHorizontal) quadPosition = XMINT3{ a, scratch.greedyMinY + slice, b };
+					else if (isAlongX) quadPosition = XMINT3{ a, b, slice };
+					else quadPosition = XMINT3{ slice, b, a };
+
+					// For each corner
+					ChunkVertex corners[QuadMesh::NrVerticesPerQuad]{};
+					for (int vIdx{}; vIdx < QuadMesh::NrVerticesPerQuad; ++vIdx)
+					{
+						const int cornerIdx{ i * ChunkVertex::NrCorners + vIdx };
+						XMINT3 cell{ faceData.cornerCells[cornerIdx] };
+
+						// Stretch the corners on the far side of the face over all the merged blocks
+						if (getComponent(cell, axisA) > 0) getComponent(cell, axisA) += width - 1;
+						if (getComponent(cell, axisB) > 0) getComponent(cell, axisB) += height - 1;
+
+						cell.x += quadPosition.x;
+						cell.y += quadPosition.y;
+						cell.z += quadPosition.z;
+
+						// Repeat the texture once for every merged block
+						const XMINT2 faceUV
+						{
+							faceData.cornerUVs[cornerIdx].x * (isUVAlongA ? width : height),
+							faceData.cornerUVs[cornerIdx].y * (isUVAlongA ? height : width)
+						};
+
+						corners[vIdx] = ChunkVertex{ cell, i, vIdx, static_cast<FaceType>(face - 1), faceUV, false };
+					}
+
+					QuadMesh::AddQuad(vertices, corners);
+				}
+			}
 		}
 	}
+
+	scratch.greedyMinY = INT_MAX;
+	scratch.greedyMaxY = -1;
 }
 
-Block* WorldGenerator::GetBlockAt(int x, int y, int z) const
+void WorldGenerator::CreateVerticesCube(const Chunk& chunk, int x, int y, int z, BlockType block, uint8_t visibleFaces, std::vector<ChunkVertex>& vertices) const
 {
-	BlockType const* pBlock{ GetBlockInChunk(x,y,z,m_Chunks) };
+	const ChunkVertex::FaceData& faceData{ ChunkVertex::GetFaceData() };
+
+	// If the current block is water and there is no water on top, the top face of the water is lowered
+	const bool isWaterSurface{ block == BlockType::WATER && (y + 1 >= m_WorldHeight || chunk.GetFluid(x, y + 1, z) == BlockType::AIR) };
+
+	// For each side of the cube
+	for (unsigned int i{}; i <= static_cast<unsigned int>(FaceDirection::BOTTOM); ++i)
+	{
+		// If this face cannot be rendered, continue to the next face
+		if (!((visibleFaces >> i) & 1U)) continue;
+
+		const FaceType faceType{ TileAtlas::GetFaceType(block, static_cast<FaceDirection>(i)) };
 
-	if (!pBlock) return nullptr;
+		// For each corner
+		ChunkVertex corners[QuadMesh::NrVerticesPerQuad]{};
+		for (int vIdx{}; vIdx < QuadMesh::NrVerticesPerQuad; ++vIdx)
+		{
+			const int cornerIdx{ static_cast<int>(i) * ChunkVertex::NrCorners + vIdx };
+
+			// Calculate the position of the vertex in the chunk
+			XMINT3 cell{ faceData.cornerCells[cornerIdx] };
+			const bool isLoweredTop{ isWaterSurface && cell.y > 0 };
+			cell.x += x;
+			cell.y += y;
+			cell.z += z;
+
+			corners[vIdx] = ChunkVertex{ cell, static_cast<int>(i), vIdx, faceType, faceData.cornerUVs[cornerIdx], isLoweredTop };
+		}
 
-	return BlockManager::Get()->GetBlock(*pBlock);
+		// Add the face to the list
+		QuadMesh::AddQuad(vertices, corners);
+	}
+}
+
+void WorldGenerator::CreateVerticesCross(const Chunk&, int x, int y, int z, BlockType block, std::vector<ChunkVertex>& vertices) const
+{
+	const ChunkVertex::FaceData& faceData{ ChunkVertex::GetFaceData() };
+	const FaceType faceType{ TileAtlas::GetFaceType(block, FaceDirection::FORWARD) };
+
+	// For each face, the packed vertices have room for the faces that come after the cube faces
+	for (int faceIdx{ ChunkVertex::NrCubeFaces }; faceIdx < ChunkVertex::NrCubeFaces + faceData.nrCrossFaces; ++faceIdx)
+	{
+		ChunkVertex corners[QuadMesh::NrVerticesPerQuad]{};
+		for (int vIdx{}; vIdx < QuadMesh::NrVerticesPerQuad; ++vIdx)
+		{
+			const int cornerIdx{ faceIdx * ChunkVertex::NrCorners + vIdx };
+
+			// Calculate the position in the chunk, the offset inside the block comes from the face and corner
+			XMINT3 cell{ faceData.cornerCells[cornerIdx] };
+			cell.x += x;
+			cell.y += y;
+			cell.z += z;
+
+			corners[vIdx] = ChunkVertex{ cell, faceIdx, vIdx, faceType, faceData.cornerUVs[cornerIdx], false };
+		}
+
+		// Add the face to the list
+		QuadMesh::AddQuad(vertices, corners);
+	}
+}
+
+Block* WorldGenerator::GetBlockAt(int x, int y, int z) const
+{
+	return BlockManager::Get()->GetBlock(GetBlockInChunk(x, y, z));
 }
 
 std::vector<XMFLOAT3> WorldGenerator::GetPositions(const Chunk& chunk) const
 {
+	const std::vector<ChunkVertex>& solidVertices{ chunk.vertices[static_cast<int>(MeshLayer::SOLID)] };
+	const std::vector<ChunkVertex>& cutoutVertices{ chunk.vertices[static_cast<int>(MeshLayer::CUTOUT)] };
+
 	std::vector<XMFLOAT3> vertices{};
-	vertices.reserve(chunk.vertices.size());
+	vertices.reserve(solidVertices.size() + cutoutVertices.size());
 
-	for (const VertexPosNormTexTransparency& v : chunk.vertices)
-	{
-		if (v.Transparent) continue;
+	const XMFLOAT3 origin{ chunk.GetOrigin() };
+	const auto addPosition{ [&](const ChunkVertex& v)
+		{
+			const XMFLOAT3 localPosition{ v.GetLocalPosition() };
+			vertices.emplace_back(origin.x + localPosition.x, origin.y + localPosition.y, origin.z + localPosition.z);
+		} };
 
-		vertices.emplace_back(v.Position);
+	// Solid blocks and cutout cubes can be walked on, the faces of cross blocks can be walked through
+	for (const ChunkVertex& v : solidVertices) addPosition(v);
+	for (const ChunkVertex& v : cutoutVertices)
+	{
+		if (v.GetFaceIdx() < ChunkVertex::NrCubeFaces) addPosition(v);
 	}
 
 	return vertices;
@@ -533,21 +1079,29 @@ bool WorldGenerator::LoadChunk(const XMINT2& chunkCenter, const SceneContext& sc
 	const int renderRadius{ m_RenderDistance - 1 };
 
 	m_WorldWidth = m_ChunkSize * (renderRadius * 2 + 1);
+	m_LoadCenter = chunkCenter;
 
 	// Delete chunks that are not longer in render distance
-	m_Chunks.erase(std::remove_if(begin(m_Chunks), end(m_Chunks), [&](const Chunk& chunk)
-		{
-			return (chunk.position.x < chunkCenter.x - renderRadius || chunk.position.x > chunkCenter.x + renderRadius ||
-				chunk.position.y < chunkCenter.y - renderRadius || chunk.position.y > chunkCenter.y + renderRadius);
-		}), end(m_Chunks));
-	m_WaterChunks.erase(std::remove_if(begin(m_WaterChunks), end(m_WaterChunks), [&](const Chunk& chunk)
+	//	chunks that have been changed are saved first, so the changes are still there when the chunk gets loaded again
+	//	every chunk is kept in the cache, so turning around doesn't generate the same chunks again
+	//	unless structures were still waiting to spawn in it, then the chunk is generated again together with its structures
+	const auto isOutOfRange{ [&](Chunk& chunk)
 		{
-			return (chunk.position.x < chunkCenter.x - renderRadius || chunk.position.x > chunkCenter.x + renderRadius ||
-				chunk.position.y < chunkCenter.y - renderRadius || chunk.position.y > chunkCenter.y + renderRadius);
-		}), end(m_WaterChunks));
+			if (IsInLoadRange(chunk.position.x, chunk.position.y)) return false;
+
+			if (chunk.isModified) m_RegionStorage.SaveChunk(chunk);
+			if (!DropStructures(chunk.position)) m_ChunkCache.Add(chunk);
+			m_DirtyChunks.erase(&chunk);
 
+			return true;
+		} };
+	m_Chunks.EraseIf(isOutOfRange);
 
-	bool changedWorld{};
+	// Switch the level of detail of the chunks that the center moved away from or towards
+	UpdateLodLevels();
+
+	// Add the chunks that the job system has generated since the last call
+	bool changedWorld{ AddGeneratedChunks() };
 
 	// Try spawning structures
 	for (int x{ chunkCenter.x - renderRadius }; x <= chunkCenter.x + renderRadius; ++x)
@@ -555,8 +1109,7 @@ bool WorldGenerator::LoadChunk(const XMINT2& chunkCenter, const SceneContext& sc
 		for (int y{ chunkCenter.y - renderRadius }; y <= chunkCenter.y + renderRadius; ++y)
 		{
 			// If the current chunk is not surrounded by chunks on all fours sides, continue to the next chunk
-			if (!(GetChunkAt((x - 1) * m_ChunkSize, y * m_ChunkSize, m_Chunks) && GetChunkAt((x + 1) * m_ChunkSize, y * m_ChunkSize, m_Chunks)
-				&& GetChunkAt(x * m_ChunkSize, (y - 1) * m_ChunkSize, m_Chunks) && GetChunkAt(x * m_ChunkSize, (y + 1) * m_ChunkSize, m_Chunks))) continue;
+			if (!(m_Chunks.Find(x - 1, y) && m_Chunks.Find(x + 1, y) && m_Chunks.Find(x, y - 1) && m_Chunks.Find(x, y + 1))) continue;
 
 			bool spawnedStructureInChunk{};
 
@@ -585,103 +1138,263 @@ bool WorldGenerator::LoadChunk(const XMINT2& chunkCenter, const SceneContext& sc
 				}
 			}
 
-			// If one or more structures have been spawned in this chunk, reload this chunks and neighbouring chunks
+			// If one or more structures have been spawned in this chunk, remesh the chunks that the structures changed
 			if (spawnedStructureInChunk)
 			{
-				ReloadChunks(x, y);
-
-				pRenderer->SetBuffers(m_Chunks, sceneContext);
-				pRenderer->SetBuffers(m_WaterChunks, sceneContext);
+				MeshDirtyChunks(true, sceneContext, pRenderer);
 
 				return true;
 			}
 		}
 	}
 
-	// For each chunk in render distance
-	for (int x{ chunkCenter.x - renderRadius }; x <= chunkCenter.x + renderRadius; ++x)
+	// Start loading every chunk in render distance that doesn't exist yet
+	//	only a few chunks per worker are generated at the same time, so walking around doesn't queue chunks that are out of range again
+	const int maxNrGenerating{ m_LoadAll ? INT_MAX : m_JobSystem.GetNrWorkers() * 2 };
+	const auto canStartGenerating{ [&]() { return static_cast<int>(m_pGeneratingChunks.size()) < maxNrGenerating; } };
+	for (int x{ chunkCenter.x - renderRadius }; x <= chunkCenter.x + renderRadius && canStartGenerating(); ++x)
 	{
-		for (int y{ chunkCenter.y - renderRadius }; y <= chunkCenter.y + renderRadius; ++y)
+		for (int y{ chunkCenter.y - renderRadius }; y <= chunkCenter.y + renderRadius && canStartGenerating(); ++y)
 		{
-			// If this chunk already exists, continue to the next chunk
-			if (std::find_if(begin(m_Chunks), end(m_Chunks), [&](const Chunk& chunk){ return chunk.position.x == x && chunk.position.y == y; }) != end(m_Chunks))
-				continue;
-
-			// Load this chunk
-			LoadChunk(x, y);
+			// If this chunk already exists or is being generated, continue to the next chunk
+			if (m_Chunks.Find(x, y) || IsGenerating(x, y)) continue;
 
-			changedWorld = true;
-
-			// If not all chunks are being spawned at the same time
-			//	Reload this chunk and neighbouring chunks
-			if (!m_LoadAll)
+			// Chunks from the cache or the region files are added right away, other chunks when their job is done
+			if (StartLoadingChunk(x, y))
 			{
 				ReloadChunks(x, y);
-
-				pRenderer->SetBuffers(m_Chunks, sceneContext);
-				pRenderer->SetBuffers(m_WaterChunks, sceneContext);
-
-				return true;
+				changedWorld = true;
 			}
 		}
 	}
 
-	// If all chunks are being loaded at the same time and the world has changed
-	// Create the vertices for each chunk and create vertex buffers
-	if (changedWorld && m_LoadAll)
+	// If all chunks are being loaded at the same time, wait until every chunk is generated
+	//	this thread helps generating meanwhile
+	if (m_LoadAll && !m_pGeneratingChunks.empty())
+	{
+		m_JobSystem.Wait(m_GenerationBatch);
+		changedWorld |= AddGeneratedChunks();
+	}
+
+	// Mesh every chunk that has all its neighbours and create the vertex buffers
+	const bool meshedChunks{ MeshDirtyChunks(true, sceneContext, pRenderer) };
+
+	return changedWorld || meshedChunks;
+}
+
+void WorldGenerator::LoadChunkMainThread(int x, int y, const SceneContext& sceneContext, WorldRenderer* pRenderer)
+{
+	LoadChunk(x, y);
+
+	ReloadChunks(x, y);
+
+	Commit(sceneContext, pRenderer);
+}
+
+std::unique_ptr<Chunk> WorldGenerator::CreateChunk(int chunkX, int chunkY)
+{
+	// Get an empty chunk from the pool
+	// Initialize it with empty sections over the whole world height
+	//		and set the chunk position
+	std::unique_ptr<Chunk> pChunk{ m_ChunkPool.Acquire() };
+	Chunk& chunk{ *pChunk };
+	chunk.sections.resize(m_WorldHeight / ChunkSection::Size);
+	chunk.sectionMeshes.resize(chunk.sections.size());
+	chunk.sectionVisibility.resize(chunk.sections.size());
+	chunk.position.x = chunkX;
+	chunk.position.y = chunkY;
+	chunk.useGreedyMesh = m_UseGreedyMeshing;
+	chunk.lodLevel = CalculateLodLevel(std::max(abs(chunkX - m_LoadCenter.x), abs(chunkY - m_LoadCenter.y)));
+
+	return pChunk;
+}
+
+void WorldGenerator::LoadChunk(int chunkX, int chunkY)
+{
+	std::unique_ptr<Chunk> pChunk{ CreateChunk(chunkX, chunkY) };
+	Chunk& chunk{ *pChunk };
+
+	// Recently unloaded chunks are loaded from the cache, older chunks that have been saved from their region file
+	//	all other chunks are generated
+	if (!m_ChunkCache.Load(chunk) && !m_RegionStorage.LoadChunk(chunk)) GenerateChunk(chunk, m_StructuresToSpawn);
+
+	UpdateColumnMaps(chunk);
+
+	// Add the chunk to the world
+	m_Chunks.Insert(std::move(pChunk));
+}
+
+bool WorldGenerator::StartLoadingChunk(int chunkX, int chunkY)
+{
+	std::unique_ptr<Chunk> pChunk{ CreateChunk(chunkX, chunkY) };
+	Chunk* pLoadingChunk{ pChunk.get() };
+
+	// Recently unloaded chunks are loaded from the cache, older chunks that have been saved from their region file
+	//	the cache and the region files aren't thread safe, but loading from them is cheap compared to generating
+	if (m_ChunkCache.Load(*pChunk) || m_RegionStorage.LoadChunk(*pChunk))
 	{
-		std::vector<std::vector<Chunk>*> predicateChunks{};
-		predicateChunks.push_back(&m_Chunks);
+		UpdateColumnMaps(*pChunk);
+		m_Chunks.Insert(std::move(pChunk));
 
-		std::vector<std::vector<Chunk>*> predicateWaterChunks{};
-		predicateWaterChunks.push_back(&m_Chunks);
-		predicateWaterChunks.push_back(&m_WaterChunks);
+		return true;
+	}
 
-		for (Chunk& chunk : m_Chunks)
+	// Generate all other chunks on a job, the job only touches its own chunk and the noise, which is never changed
+	m_pGeneratingChunks.emplace_back(std::move(pChunk));
+	m_JobSystem.Submit([this, pLoadingChunk]()
 		{
-			CreateVertices(chunk, predicateChunks);
-		}
-		for (Chunk& chunk : m_WaterChunks)
+			GeneratedChunk generatedChunk{ pLoadingChunk };
+			GenerateChunk(*pLoadingChunk, generatedChunk.structures);
+			UpdateColumnMaps(*pLoadingChunk);
+
+			m_GeneratedChunks.Push(std::move(generatedChunk));
+		}, &m_GenerationBatch);
+
+	return false;
+}
+
+bool WorldGenerator::IsGenerating(int chunkX, int chunkY) const
+{
+	return std::any_of(begin(m_pGeneratingChunks), end(m_pGeneratingChunks), [chunkX, chunkY](const std::unique_ptr<Chunk>& pChunk)
 		{
-			CreateVertices(chunk, predicateWaterChunks);
+			return pChunk->position.x == chunkX && pChunk->position.y == chunkY;
+		});
+}
+
+bool WorldGenerator::AddGeneratedChunks()
+{
+	bool addedChunks{};
+
+	GeneratedChunk generatedChunk{};
+	while (m_GeneratedChunks.Pop(generatedChunk))
+	{
+		// Take the chunk back from the chunks that are being generated
+		const auto it{ std::find_if(begin(m_pGeneratingChunks), end(m_pGeneratingChunks), [&](const std::unique_ptr<Chunk>& pChunk) { return pChunk.get() == generatedChunk.pChunk; }) };
+		std::unique_ptr<Chunk> pChunk{ std::move(*it) };
+		*it = std::move(m_pGeneratingChunks.back());
+		m_pGeneratingChunks.pop_back();
+
+		// A chunk that left the render distance while it was generated is thrown away together with its structures
+		//	it isn't cached, so it is generated again with its structures when it comes back in range
+		if (!IsInLoadRange(pChunk->position.x, pChunk->position.y))
+		{
+			m_ChunkPool.Release(std::move(pChunk));
+			continue;
 		}
 
-		pRenderer->SetBuffers(m_Chunks, sceneContext);
-		pRenderer->SetBuffers(m_WaterChunks, sceneContext);
+		m_StructuresToSpawn.insert(end(m_StructuresToSpawn), begin(generatedChunk.structures), end(generatedChunk.structures));
 
-		return true;
+		// Add the chunk to the world, it and the chunks next to it are meshed once all their neighbours are loaded
+		const XMINT2 position{ pChunk->position };
+		m_Chunks.Insert(std::move(pChunk));
+		ReloadChunks(position.x, position.y);
+
+		addedChunks = true;
 	}
 
-	return false;
+	return addedChunks;
 }
 
-void WorldGenerator::LoadChunkMainThread(int x, int y, const SceneContext& sceneContext, WorldRenderer* pRenderer)
+bool WorldGenerator::DropStructures(const XMINT2& chunkPosition)
 {
-	LoadChunk(x, y);
+	const auto isInChunk{ [&](const StructureSpawn& structure)
+		{
+			const XMINT2 blockInChunk{ structure.second.x - chunkPosition.x * m_ChunkSize, structure.second.z - chunkPosition.y * m_ChunkSize };
+			return blockInChunk.x >= 0 && blockInChunk.y >= 0 && blockInChunk.x < m_ChunkSize && blockInChunk.y < m_ChunkSize;
+		} };
 
-	ReloadChunks(x, y);
+	const size_t prevNrStructures{ m_StructuresToSpawn.size() };
+	m_StructuresToSpawn.erase(std::remove_if(begin(m_StructuresToSpawn), end(m_StructuresToSpawn), isInChunk), end(m_StructuresToSpawn));
 
-	pRenderer->SetBuffers(m_Chunks, sceneContext);
-	pRenderer->SetBuffers(m_WaterChunks, sceneContext);
+	return m_StructuresToSpawn.size() != prevNrStructures;
 }
 
-void WorldGenerator::LoadChunk(int chunkX, int chunkY)
+bool WorldGenerator::IsInLoadRange(int chunkX, int chunkY) const
 {
-	Biome biome{ BlockManager::Get()->GetBiome("forest") };
+	const int renderRadius{ m_RenderDistance - 1 };
 
-	const int m_ChunkSizeSqr{ m_ChunkSize * m_ChunkSize };
+	return chunkX >= m_LoadCenter.x - renderRadius && chunkX <= m_LoadCenter.x + renderRadius &&
+		chunkY >= m_LoadCenter.y - renderRadius && chunkY <= m_LoadCenter.y + renderRadius;
+}
 
-	// Create a new chunk and water chunk
-	// Initialize them with a block vector that has the right side
-	//		and set the chunk position
-	Chunk chunk{};
-	chunk.blocks.resize(m_WorldHeight * m_ChunkSize * m_ChunkSize);
-	chunk.position.x = chunkX;
-	chunk.position.y = chunkY;
-	Chunk waterChunk{};
-	waterChunk.blocks.resize(m_WorldHeight * m_ChunkSize * m_ChunkSize);
-	waterChunk.position.x = chunkX;
-	waterChunk.position.y = chunkY;
+bool WorldGenerator::HasNeighbours(const Chunk& chunk) const
+{
+	// Neighbours outside render distance are never loaded, so the chunk doesn't have to wait for them
+	for (unsigned int i{}; i < static_cast<unsigned int>(FaceDirection::UP); ++i)
+	{
+		const int neighbourX{ chunk.position.x + m_NeighbouringBlocks[i].x };
+		const int neighbourY{ chunk.position.y + m_NeighbouringBlocks[i].z };
+
+		if (IsInLoadRange(neighbourX, neighbourY) && !m_Chunks.Find(neighbourX, neighbourY)) return false;
+	}
+
+	return true;
+}
+
+int WorldGenerator::CalculateLodLevel(int distance) const
+{
+	const int lodDistance{ GetLodDistance() };
+	if (lodDistance <= 0) return 0;
+
+	// Every level starts at twice the distance of the level before it
+	int lodLevel{};
+	for (int levelDistance{ lodDistance }; lodLevel < MaxLodLevel && distance > levelDistance; levelDistance *= 2) ++lodLevel;
+
+	return lodLevel;
+}
+
+int WorldGenerator::GetLodLevel(const XMINT2& chunkPosition, int curLodLevel) const
+{
+	const int distance{ std::max(abs(chunkPosition.x - m_LoadCenter.x), abs(chunkPosition.y - m_LoadCenter.y)) };
+
+	// A chunk only gets coarser once it is past the border of the level and only finer once it is back inside the border
+	//	so walking along the border of a level doesn't keep remeshing the chunks on it
+	const int coarserLevel{ CalculateLodLevel(distance - LodHysteresis) };
+	if (coarserLevel > curLodLevel) return coarserLevel;
+
+	const int finerLevel{ CalculateLodLevel(distance + LodHysteresis) };
+	if (finerLevel < curLodLevel) return finerLevel;
+
+	return curLodLevel;
+}
+
+void WorldGenerator::UpdateLodLevels()
+{
+	for (Chunk& chunk : m_Chunks)
+	{
+		const int lodLevel{ GetLodLevel(chunk.position, chunk.lodLevel) };
+		if (lodLevel == chunk.lodLevel) continue;
+
+		// Remesh the chunk and the chunks next to it, their skirts depend on the level of this chunk
+		chunk.lodLevel = lodLevel;
+		ReloadChunks(chunk.position.x, chunk.position.y);
+	}
+}
+
+void WorldGenerator::UpdateColumnMaps(Chunk& chunk) const
+{
+	// Build the height and exposure maps of every column
+	for (int x{}; x < m_ChunkSize; ++x)
+	{
+		for (int z{}; z < m_ChunkSize; ++z)
+		{
+			UpdateColumnMaps(chunk, x, z);
+		}
+	}
+}
+
+void WorldGenerator::GenerateTerrain(Chunk& chunk) const
+{
+	std::vector<StructureSpawn> structures{};
+	GenerateChunk(chunk, structures);
+}
+
+void WorldGenerator::GenerateChunk(Chunk& chunk, std::vector<StructureSpawn>& structures) const
+{
+	Biome biome{ BlockManager::Get()->GetBiome("forest") };
+
+	const int chunkX{ chunk.position.x };
+	const int chunkY{ chunk.position.y };
 
 	// For each x-z position
 	for (int x{}; x < m_ChunkSize; ++x)
@@ -692,51 +1405,26 @@ void WorldGenerator::LoadChunk(int chunkX, int chunkY)
 			const int worldPosX{ chunkX * m_ChunkSize + x };
 			const int worldPosZ{ chunkY * m_ChunkSize + z };
 
-			// Calculate the sea perlin
-			const float underseaNoise{ m_UnderSeaPerlin.GetNoise(static_cast<float>(worldPosX) / m_ChunkSize, static_cast<float>(worldPosZ) / m_ChunkSize) };
-			const float seaWorldHeight{ underseaNoise * m_TerrainHeight };
-
-			// Calculate the heightmap perlin
-			const float heightNoise{ m_HeightPerlin.GetNoise(static_cast<float>(worldPosX) / m_ChunkSize, static_cast<float>(worldPosZ) / m_ChunkSize) };
-			float worldHeight{};
+			// Calculate the height of the terrain
+			const float worldHeight{ GetTerrainHeight(worldPosX, worldPosZ) };
+			const int surfaceY{ GetSurfaceY(worldHeight) };
 
-			// If the sea is under sealevel
-			if (seaWorldHeight < m_SeaLevel)
-			{
-				// Set the worldheight to an amplified version of the sea perlin
-				worldHeight = seaWorldHeight * 2 - m_SeaLevel;
-			}
-			else
-			{
-				// Calculate the percentage of the perlin above sealevel
-				const float amountAboveSealevel{ seaWorldHeight - m_SeaLevel };
-				const float percentageAboveSealevel{ amountAboveSealevel / (m_TerrainHeight - m_SeaLevel) };
-
-				// Calculate worldheight
-				worldHeight = m_SeaLevel + heightNoise * m_TerrainHeight * percentageAboveSealevel;
-			}
-
-			// Clamp the world height
-			const int worldY = std::min(std::max(static_cast<int>(worldHeight), m_SeaLevel + 1), m_WorldHeight - 1);
-			
 			// Calculate the beach size for this x-z position
-			const float beachMultiplier{ m_BeachPerlin.GetNoise(static_cast<float>(worldPosX) / m_ChunkSize, static_cast<float>(worldPosZ) / m_ChunkSize) };
-			const float beachSize{ (beachMultiplier * biome.beach.size) };
+			const float beachSize{ GetBeachSize(worldPosX, worldPosZ, biome) };
 
 			bool hasDirt{ false };
 
 			// Loop over the whole y buffer
-			const int surfaceY{ worldY - 1 };
 			for (int y{ surfaceY }; y >= 0; --y)
 			{
 				// Get the block for this position
 				const XMINT3 blockPosition{ XMINT3{x,y,z} };
 				Block* pBlock{ GetBlock(blockPosition, worldHeight, surfaceY, beachSize, biome) };
 
-				// If the current block is water, add it to the water chunk and continue to the next block
+				// If the current block is water, add it to the fluid layer and continue to the next block
 				if (pBlock->type == BlockType::WATER)
 				{
-					waterChunk.blocks[x + z * m_ChunkSize + y * m_ChunkSizeSqr] = pBlock->type;
+					chunk.SetFluid(x, y, z, pBlock->type);
 					continue;
 				}
 
@@ -745,7 +1433,7 @@ void WorldGenerator::LoadChunk(int chunkX, int chunkY)
 				if (pBlock->type == BlockType::SAND && hasDirt) pBlock = BlockManager::Get()->GetBlock(BlockType::DIRT);
 
 				// Store the block in the chunk
-				chunk.blocks[x + z * m_ChunkSize + y * m_ChunkSizeSqr] = pBlock->type;
+				chunk.SetBlock(x, y, z, pBlock->type);
 			}
 
 			// Calculate the vegitation perlin
@@ -756,24 +1444,72 @@ void WorldGenerator::LoadChunk(int chunkX, int chunkY)
 			constexpr float smallVegitationSpawnChance{ 0.5f };
 			if (vegitationNoise > bigVegitationSpawnChance)
 			{
-				if (biome.bigVegitation != nullptr && chunk.blocks[x + z * m_ChunkSize + surfaceY * m_ChunkSizeSqr] == biome.bigVegitation->pSpawnOnBlock->type)
+				if (biome.bigVegitation != nullptr && chunk.GetBlock(x, surfaceY, z) == biome.bigVegitation->pSpawnOnBlock->type)
 				{
-					m_StructuresToSpawn.emplace_back(std::make_pair(biome.bigVegitation, XMINT3{ worldPosX,surfaceY + 1,worldPosZ }));
+					structures.emplace_back(std::make_pair(biome.bigVegitation, XMINT3{ worldPosX,surfaceY + 1,worldPosZ }));
 				}
 			}
 			else if (vegitationNoise < smallVegitationSpawnChance)
 			{
-				if (biome.smallVegitation != nullptr && chunk.blocks[x + z * m_ChunkSize + surfaceY * m_ChunkSizeSqr] == biome.bigVegitation->pSpawnOnBlock->type)
+				if (biome.smallVegitation != nullptr && chunk.GetBlock(x, surfaceY, z) == biome.bigVegitation->pSpawnOnBlock->type)
 				{
-					m_StructuresToSpawn.emplace_back(std::make_pair(biome.smallVegitation, XMINT3{ worldPosX,surfaceY + 1,worldPosZ }));
+					structures.emplace_back(std::make_pair(biome.smallVegitation, XMINT3{ worldPosX,surfaceY + 1,worldPosZ }));
 				}
 			}
 		}
 	}
 
-	// Add the chunk to the world
-	m_Chunks.push_back(chunk);
-	m_WaterChunks.push_back(waterChunk);
+	// Drop unused palette entries and release the indices of sections that only contain one block type
+	chunk.Compact();
+}
+
+BlockType WorldGenerator::GetSurfaceBlock(int worldX, int worldZ, int& surfaceY) const
+{
+	const Biome& biome{ BlockManager::Get()->GetBiome("forest") };
+
+	const float worldHeight{ GetTerrainHeight(worldX, worldZ) };
+	surfaceY = GetSurfaceY(worldHeight);
+
+	// The top block is chosen the same way as when the chunk is generated
+	return GetBlock(XMINT3{ 0, surfaceY, 0 }, worldHeight, surfaceY, GetBeachSize(worldX, worldZ, biome), biome)->type;
+}
+
+float WorldGenerator::GetTerrainHeight(int worldX, int worldZ) const
+{
+	// Calculate the sea perlin
+	const float underseaNoise{ m_UnderSeaPerlin.GetNoise(static_cast<float>(worldX) / m_ChunkSize, static_cast<float>(worldZ) / m_ChunkSize) };
+	const float seaWorldHeight{ underseaNoise * m_TerrainHeight };
+
+	// If the sea is under sealevel
+	if (seaWorldHeight < m_SeaLevel)
+	{
+		// Set the worldheight to an amplified version of the sea perlin
+		return seaWorldHeight * 2 - m_SeaLevel;
+	}
+
+	// Calculate the heightmap perlin
+	const float heightNoise{ m_HeightPerlin.GetNoise(static_cast<float>(worldX) / m_ChunkSize, static_cast<float>(worldZ) / m_ChunkSize) };
+
+	// Calculate the percentage of the perlin above sealevel
+	const float amountAboveSealevel{ seaWorldHeight - m_SeaLevel };
+	const float percentageAboveSealevel{ amountAboveSealevel / (m_TerrainHeight - m_SeaLevel) };
+
+	// Calculate worldheight
+	return m_SeaLevel + heightNoise * m_TerrainHeight * percentageAboveSealevel;
+}
+
+int WorldGenerator::GetSurfaceY(float worldHeight) const
+{
+	// Clamp the world height, the sea fills every column up to sea level
+	const int worldY = std::min(std::max(static_cast<int>(worldHeight), m_SeaLevel + 1), m_WorldHeight - 1);
+
+	return worldY - 1;
+}
+
+float WorldGenerator::GetBeachSize(int worldX, int worldZ, const Biome& biome) const
+{
+	const float beachMultiplier{ m_BeachPerlin.GetNoise(static_cast<float>(worldX) / m_ChunkSize, static_cast<float>(worldZ) / m_ChunkSize) };
+	return beachMultiplier * biome.beach.size;
 }
 
 Block* WorldGenerator::GetBlock(const XMINT3& position, float worldHeight, int surfaceY, float beachSize, const Biome& biome) const
@@ -823,23 +1559,15 @@ void WorldGenerator::SpawnStructure(const Structure* structure, const XMINT3& po
 			position.z + b.position.z
 		};
 
-		// Get the block in the world
-		BlockType* pBlock{ GetBlockInChunk(bPos.x, bPos.y, bPos.z, m_Chunks) };
-
-		if (!pBlock) return;
-
-		// Set the block to the right block
-		*pBlock = b.pBlock->type;
+		// Set the block in the world to the right block
+		if (!SetBlockInChunk(bPos.x, bPos.y, bPos.z, b.pBlock->type)) return;
 
 		// If this block is a cube mesh
 		if (b.pBlock->mesh == BlockMesh::CUBE)
 		{
 			// If this block is spawned above a grass block, change it to a dirt block
-			Chunk* pChunk{ GetChunkAt(static_cast<int>(position.x), static_cast<int>(position.z), m_Chunks) };
-			const XMINT3 lookUpPos{ static_cast<int>(position.x) - pChunk->position.x * m_ChunkSize, static_cast<int>(position.y), static_cast<int>(position.z) - pChunk->position.y * m_ChunkSize };
-
-			const int blockUnderIdx{ lookUpPos.x + lookUpPos.z * m_ChunkSize + (lookUpPos.y - 1) * m_ChunkSize * m_ChunkSize };
-			if (pChunk->blocks[blockUnderIdx] == BlockType::GRASS_BLOCK) pChunk->blocks[blockUnderIdx] = BlockType::DIRT;
+			//	setting the block also updates the column maps of the changed block
+			if (GetBlockInChunk(bPos.x, bPos.y - 1, bPos.z) == BlockType::GRASS_BLOCK) SetBlockInChunk(bPos.x, bPos.y - 1, bPos.z, BlockType::DIRT);
 		}
 	}
 }
@@ -853,38 +1581,77 @@ bool WorldGenerator::IsSheepChunk(const XMINT2& chunkPos)
 	return sheepNoise < sheepSpawnChance;
 }
 
-BlockType* WorldGenerator::GetBlockInChunk(int x, int y, int z, std::vector<Chunk>& chunks) const
+BlockType WorldGenerator::GetBlockInChunk(int x, int y, int z) const
 {
-	// Calculate the chunk position for this position
-	const XMINT2 chunkPos
-	{
-		x < 0 ? (static_cast<int>(x) + 1) / m_ChunkSize - 1 : static_cast<int>(x) / m_ChunkSize,
-		z < 0 ? (static_cast<int>(z) + 1) / m_ChunkSize - 1 : static_cast<int>(z) / m_ChunkSize
-	};
+	// Find the chunk for this block
+	const Chunk* pChunk{ GetChunkAt(x, z) };
+	if (!pChunk) return BlockType::AIR;
+
+	// If the position is outside the world height, return air
+	if (y < 0 || y >= m_WorldHeight) return BlockType::AIR;
+
+	// Return the block at the relative position in the chunk
+	return pChunk->GetBlock(x - pChunk->position.x * m_ChunkSize, y, z - pChunk->position.y * m_ChunkSize);
+}
+
+BlockType WorldGenerator::GetFluidInChunk(int x, int y, int z) const
+{
+	// Find the chunk for this fluid
+	const Chunk* pChunk{ GetChunkAt(x, z) };
+	if (!pChunk) return BlockType::AIR;
+
+	// If the position is outside the world height, return air
+	if (y < 0 || y >= m_WorldHeight) return BlockType::AIR;
 
+	// Return the fluid at the relative position in the chunk
+	return pChunk->GetFluid(x - pChunk->position.x * m_ChunkSize, y, z - pChunk->position.y * m_ChunkSize);
+}
+
+bool WorldGenerator::SetBlockInChunk(int x, int y, int z, BlockType block)
+{
 	// Find the chunk for this block
-	auto it{ std::find_if(begin(chunks), end(chunks), [&](const Chunk& chunk)
-		{
-			return chunk.position.x == chunkPos.x && chunk.position.y == chunkPos.y;
-		}) };
-	if (it == chunks.end()) return nullptr;
+	Chunk* pChunk{ GetChunkAt(x, z) };
+	if (!pChunk) return false;
+
+	// If the position is outside the world height, the block can't be set
+	if (y < 0 || y >= m_WorldHeight) return false;
+
+	// Set the block at the relative position in the chunk
+	const int localX{ x - pChunk->position.x * m_ChunkSize };
+	const int localZ{ z - pChunk->position.y * m_ChunkSize };
+	pChunk->SetBlock(localX, y, localZ, block);
+
+	// Keep the maps of this column up to date
+	UpdateColumnMaps(*pChunk, localX, y, localZ);
+
+	// Remesh the sections around this block on the next commit
+	MarkDirty(*pChunk, localX, y, localZ);
+
+	return true;
+}
+
+bool WorldGenerator::SetFluidInChunk(int x, int y, int z, BlockType fluid)
+{
+	// Find the chunk for this fluid
+	Chunk* pChunk{ GetChunkAt(x, z) };
+	if (!pChunk) return false;
 
-	// Calculate the relative position
-	const XMINT3 lookUpPos{ static_cast<int>(x) - chunkPos.x * m_ChunkSize, static_cast<int>(y), static_cast<int>(z) - chunkPos.y * m_ChunkSize };
+	// If the position is outside the world height, the fluid can't be set
+	if (y < 0 || y >= m_WorldHeight) return false;
 
-	// If the position is outside the chunk, return nullptr
-	if (lookUpPos.x < 0 || lookUpPos.x >= m_ChunkSize
-		|| lookUpPos.z < 0 || lookUpPos.z >= m_ChunkSize
-		|| lookUpPos.y < 0 || lookUpPos.y >= m_WorldHeight) return nullptr;
+	// Set the fluid at the relative position in the chunk
+	pChunk->SetFluid(x - pChunk->position.x * m_ChunkSize, y, z - pChunk->position.y * m_ChunkSize, fluid);
 
-	// Calculate the blockidx
-	const int blockIdx{ lookUpPos.x + lookUpPos.z * m_ChunkSize + lookUpPos.y * m_ChunkSize * m_ChunkSize };
+	// Remesh the water of this section and of the section it touches, the water underneath can lose its lowered top
+	const int sectionIdx{ y / ChunkSection::Size };
+	pChunk->dirtyFluidSectionBits |= 1U << sectionIdx;
+	if (y % ChunkSection::Size == 0 && sectionIdx > 0) pChunk->dirtyFluidSectionBits |= 1U << (sectionIdx - 1);
+	else if (y % ChunkSection::Size == ChunkSection::Size - 1 && y + 1 < m_WorldHeight) pChunk->dirtyFluidSectionBits |= 1U << (sectionIdx + 1);
 
-	// Return the correct block
-	return it->blocks.data() + blockIdx;
+	return true;
 }
 
-BlockType const* WorldGenerator::GetBlockInChunk(int x, int y, int z, const std::vector<Chunk>& chunks) const
+Chunk* WorldGenerator::GetChunkAt(int x, int z) const
 {
 	// Calculate the chunk position
 	const XMINT2 chunkPos
@@ -893,44 +1660,156 @@ BlockType const* WorldGenerator::GetBlockInChunk(int x, int y, int z, const std:
 		z < 0 ? (static_cast<int>(z) + 1) / m_ChunkSize - 1 : static_cast<int>(z) / m_ChunkSize
 	};
 
-	// Find the correct chunk
-	auto it{ std::find_if(begin(chunks), end(chunks), [&](const Chunk& chunk)
+	// Find the chunk with this chunk position
+	return m_Chunks.Find(chunkPos);
+}
+
+void WorldGenerator::MarkDirty(Chunk& chunk, int localX, int y, int localZ)
+{
+	// A block on the top or bottom of a section can hide or reveal faces of the section above or underneath it
+	const int sectionIdx{ y / ChunkSection::Size };
+	uint32_t sectionBits{ 1U << sectionIdx };
+	if (y % ChunkSection::Size == 0 && sectionIdx > 0) sectionBits |= 1U << (sectionIdx - 1);
+	else if (y % ChunkSection::Size == ChunkSection::Size - 1 && y + 1 < m_WorldHeight) sectionBits |= 1U << (sectionIdx + 1);
+
+	MarkDirty(chunk, sectionBits);
+
+	// A block on the border of the chunk can hide or reveal faces of the neighbouring chunk, only in the section of the block
+	const uint32_t neighbourBits{ 1U << sectionIdx };
+	if (localX == 0) MarkDirty(chunk.position.x - 1, chunk.position.y, neighbourBits);
+	else if (localX == m_ChunkSize - 1) MarkDirty(chunk.position.x + 1, chunk.position.y, neighbourBits);
+
+	if (localZ == 0) MarkDirty(chunk.position.x, chunk.position.y - 1, neighbourBits);
+	else if (localZ == m_ChunkSize - 1) MarkDirty(chunk.position.x, chunk.position.y + 1, neighbourBits);
+}
+
+void WorldGenerator::MarkDirty(int chunkX, int chunkY, uint32_t sectionBits)
+{
+	if (Chunk* pChunk{ m_Chunks.Find(chunkX, chunkY) }) MarkDirty(*pChunk, sectionBits);
+}
+
+void WorldGenerator::MarkDirty(Chunk& chunk, uint32_t sectionBits)
+{
+	// Blocks can hide or reveal water faces, so the water of these sections is remeshed as well
+	chunk.dirtySectionBits |= sectionBits;
+	chunk.dirtyFluidSectionBits |= sectionBits;
+
+	m_DirtyChunks.insert(&chunk);
+}
+
+bool WorldGenerator::IsOpaqueBlock(BlockType block) const
+{
+	// Only cube blocks that can't be seen through hide the faces of their neighbours
+	return BlockManager::Get()->IsOpaqueCube(block);
+}
+
+void WorldGenerator::UpdateColumnMaps(Chunk& chunk, int x, int z) const
+{
+	// Find the highest block, sections without blocks are skipped at once
+	int height{ m_WorldHeight - 1 };
+	while (height >= 0)
+	{
+		if (!chunk.HasBlocksInSection(height / ChunkSection::Size))
 		{
-			return chunk.position.x == chunkPos.x && chunk.position.y == chunkPos.y;
-		}) };
-	if (it == chunks.end()) return nullptr;
+			height -= height % ChunkSection::Size + 1;
+			continue;
+		}
 
-	// Calculate the relative position
-	const XMINT3 lookUpPos{ static_cast<int>(x) - chunkPos.x * m_ChunkSize, static_cast<int>(y), static_cast<int>(z) - chunkPos.y * m_ChunkSize };
+		if (chunk.GetBlock(x, height, z) != BlockType::AIR) break;
 
-	// If the chunk position is outside the chunk, return nullptr
-	if (lookUpPos.x < 0 || lookUpPos.x >= m_ChunkSize
-		|| lookUpPos.z < 0 || lookUpPos.z >= m_ChunkSize
-		|| lookUpPos.y < 0 || lookUpPos.y >= m_WorldHeight) return nullptr;
+		--height;
+	}
 
-	// Calculate the block index
-	const int blockIdx{ lookUpPos.x + lookUpPos.z * m_ChunkSize + lookUpPos.y * m_ChunkSize * m_ChunkSize };
+	// Find the lowest block that isn't opaque
+	int lowestExposed{};
+	while (lowestExposed <= height && IsOpaqueBlock(chunk.GetBlock(x, lowestExposed, z))) ++lowestExposed;
 
-	// Return the correct block
-	return it->blocks.data() + blockIdx;
+	const int columnIdx{ Chunk::GetColumnIdx(x, z) };
+	chunk.heightMap[columnIdx] = static_cast<int16_t>(height);
+	chunk.lowestExposedMap[columnIdx] = static_cast<int16_t>(lowestExposed);
 }
 
-Chunk* WorldGenerator::GetChunkAt(int x, int z, std::vector<Chunk>& chunks) const
+void WorldGenerator::UpdateColumnMaps(Chunk& chunk, int x, int y, int z) const
 {
-	// Calculate the chunk position
-	const XMINT2 chunkPos
+	const int columnIdx{ Chunk::GetColumnIdx(x, z) };
+	const BlockType block{ chunk.GetBlock(x, y, z) };
+
+	// Update the height of the column
+	int height{ chunk.heightMap[columnIdx] };
+	if (block != BlockType::AIR)
 	{
-		x < 0 ? (static_cast<int>(x) + 1) / m_ChunkSize - 1 : static_cast<int>(x) / m_ChunkSize,
-		z < 0 ? (static_cast<int>(z) + 1) / m_ChunkSize - 1 : static_cast<int>(z) / m_ChunkSize
-	};
+		height = std::max(height, y);
+	}
+	else if (y == height)
+	{
+		// The highest block has been removed, search the next block underneath it
+		while (height >= 0 && chunk.GetBlock(x, height, z) == BlockType::AIR) --height;
+	}
 
-	// Find the chunk with this chunk position
-	auto it{ std::find_if(begin(chunks), end(chunks), [&](const Chunk& chunk)
+	// Update the lowest exposed block of the column
+	int lowestExposed{ chunk.lowestExposedMap[columnIdx] };
+	if (!IsOpaqueBlock(block))
+	{
+		lowestExposed = std::min(lowestExposed, y);
+	}
+	else if (y == lowestExposed)
+	{
+		// The lowest exposed block has been covered, search the next exposed block above it
+		while (lowestExposed <= height && IsOpaqueBlock(chunk.GetBlock(x, lowestExposed, z))) ++lowestExposed;
+	}
+
+	chunk.heightMap[columnIdx] = static_cast<int16_t>(height);
+	chunk.lowestExposedMap[columnIdx] = static_cast<int16_t>(lowestExposed);
+}
+
+void WorldGenerator::GetMeshRange(const Chunk& chunk, int x, int z, int& minY, int& maxY) const
+{
+	// Nothing above the highest block has to be meshed
+	maxY = chunk.GetHeight(x, z);
+
+	// A block can only have a visible face if the block above it or one of the blocks next to it is exposed
+	minY = chunk.GetLowestExposed(x, z) - 1;
+	for (unsigned int i{}; i < static_cast<unsigned int>(FaceDirection::UP); ++i)
+	{
+		const XMINT3& neighbourDirection{ m_NeighbouringBlocks[i] };
+		const int neighbourX{ x + neighbourDirection.x };
+		const int neighbourZ{ z + neighbourDirection.z };
+
+		// Neighbours inside this chunk are read directly
+		if (neighbourX >= 0 && neighbourX < m_ChunkSize && neighbourZ >= 0 && neighbourZ < m_ChunkSize)
 		{
-			return chunk.position.x == chunkPos.x && chunk.position.y == chunkPos.y;
-		}) };
-	if (it == chunks.end()) return nullptr;
+			minY = std::min(minY, chunk.GetLowestExposed(neighbourX, neighbourZ));
+			continue;
+		}
+
+		// Faces next to a chunk that isn't loaded are always visible
+		const Chunk* pNeighbourChunk{ m_Chunks.Find(chunk.position.x + neighbourDirection.x, chunk.position.y + neighbourDirection.z) };
+		if (!pNeighbourChunk)
+		{
+			minY = 0;
+			break;
+		}
+
+		minY = std::min(minY, pNeighbourChunk->GetLowestExposed((neighbourX + m_ChunkSize) % m_ChunkSize, (neighbourZ + m_ChunkSize) % m_ChunkSize));
+	}
 
-	// Return the pointer of this iterator
-	return it._Unwrapped();
+	minY = std::max(minY, 0);
+}
+
+unsigned int WorldGenerator::LoadSeed() const
+{
+	unsigned int seed{};
+
+	std::ifstream seedFile{ m_SaveDirectory / "Seed.txt" };
+	if (!(seedFile >> seed)) seed = static_cast<unsigned int>(rand());
+
+	srand(seed);
+	return seed;
+}
+
+void WorldGenerator::SaveSeed() const
+{
+	// The region storage already created the directory of this world
+	std::ofstream seedFile{ m_SaveDirectory / "Seed.txt" };
+	seedFile << m_Seed << '\n';
 }
\ No newline at end of file
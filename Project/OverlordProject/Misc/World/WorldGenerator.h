@@ -1,9 +1,16 @@
 #pragma once
 
 #include "Utils/Perlin.h"
+#include "Utils/CompletionQueue.h"
+#include "Utils/JobSystem.h"
 #include "TileAtlas.h"
-#include "Chunk.h"
+#include "ChunkMap.h"
+#include "RegionStorage.h"
+#include "ChunkCache.h"
+#include "FaceMasks.h"
 
+#include <atomic>
+#include <unordered_set>
 #include <vector>
 
 struct Block;
@@ -13,7 +20,16 @@ class WorldRenderer;
 class WorldGenerator final
 {
 public:
-	WorldGenerator();
+	// Totals of every chunk that has been meshed with one mesher
+	struct MeshStats
+	{
+		int nrChunks{};
+		int64_t nrVertices{};
+		double totalTime{}; // in milliseconds
+	};
+
+	// The seed and the changed chunks of the world are kept in the save directory, a world with a save is loaded again
+	explicit WorldGenerator(const std::filesystem::path& saveDirectory);
 	~WorldGenerator();
 
 	WorldGenerator(const WorldGenerator& other) = delete;
@@ -21,14 +37,28 @@ public:
 	WorldGenerator& operator=(const WorldGenerator& other) = delete;
 	WorldGenerator& operator=(WorldGenerator&& other) noexcept = delete;
 
+	// Whether a face of the current block is visible next to the neighbouring block, the face masks give the same result for every cube
+	static bool CanRenderFace(BlockType neighbourBlock, BlockType curBlock);
+
+	// Starts generating the missing chunks in render distance on the job system and adds the chunks that are done
+	//	a chunk is meshed once its neighbours in render distance are loaded
 	bool LoadChunk(const XMINT2& chunkCenter, const SceneContext& sceneContext, WorldRenderer* pRenderer);
 	void LoadChunkMainThread(int x, int y, const SceneContext& sceneContext, WorldRenderer* pRenderer);
-	void RemoveBlock(const XMFLOAT3& position, const SceneContext& sceneContext, WorldRenderer* pRenderer);
-	void PlaceBlock(const XMFLOAT3& position, BlockType block, const SceneContext& sceneContext, WorldRenderer* pRenderer);
+	// Block edits between BeginEdit and Commit are remeshed together
+	//	every changed chunk and every neighbour that borders a changed block is remeshed and uploaded once on commit
+	//	edits can be nested, only the outermost commit remeshes
+	void BeginEdit() { ++m_EditDepth; }
+	bool SetBlock(const XMINT3& position, BlockType block) { return SetBlockInChunk(position.x, position.y, position.z, block); }
+	void Commit(const SceneContext& sceneContext, WorldRenderer* pRenderer);
+
+	// Returns false if the position isn't in a loaded chunk
+	bool RemoveBlock(const XMFLOAT3& position, const SceneContext& sceneContext, WorldRenderer* pRenderer);
+	bool PlaceBlock(const XMFLOAT3& position, BlockType block, const SceneContext& sceneContext, WorldRenderer* pRenderer);
 	Block* GetBlockAt(int x, int y, int z) const;
 	bool ChangeEnvironment(const XMINT2& chunkCenter, const SceneContext& sceneContext, WorldRenderer* pRenderer);
 
-	void SetRenderDistance(int renderDistance) { m_RenderDistance = renderDistance; }
+	void SetRenderDistance(int renderDistance);
+	int GetRenderDistance() const { return m_RenderDistance; }
 	void SetWorldHeight(int worldHeight) { m_WorldHeight = worldHeight; }
 	void SetTerrainHeight(int terrainHeight) { m_TerrainHeight = terrainHeight; }
 
@@ -36,42 +66,163 @@ public:
 	int GetChunkSize() const { return m_ChunkSize; }
 	int GetWorldHeight() const { return m_WorldHeight; }
 
-	std::vector<Chunk>& GetChunks() { return m_Chunks; }
-	std::vector<Chunk>& GetWater() { return m_WaterChunks; }
+	ChunkMap& GetChunks() { return m_Chunks; }
+	const ChunkPool::Stats& GetChunkPoolStats() const { return m_ChunkPool.GetStats(); }
+	const RegionStorage& GetRegionStorage() const { return m_RegionStorage; }
+	unsigned int GetSeed() const { return m_Seed; }
+	const ChunkCache::Stats& GetChunkCacheStats() const { return m_ChunkCache.GetStats(); }
+	size_t GetChunkCacheBudget() const { return m_ChunkCache.GetByteBudget(); }
 
 	void ShouldLoadAllAtOnce(bool loadAll) { m_LoadAll = loadAll; }
 
+	// Chunks that are loaded after this call use the greedy mesher, chunks that are already loaded keep their mesher
+	void SetGreedyMeshing(bool useGreedyMeshing) { m_UseGreedyMeshing = useGreedyMeshing; }
+	bool IsGreedyMeshing() const { return m_UseGreedyMeshing; }
+	const MeshStats& GetMeshStats(bool greedy) const { return m_MeshStats[greedy]; }
+
+	// Chunks further than this many chunks from the center are meshed at a lower level of detail, 0 meshes every chunk at full resolution
+	//	every level starts at twice the distance of the level before it
+	void SetLodDistance(int lodDistance) { m_LodDistance = lodDistance > 0 ? std::max(lodDistance, m_PhysicsDistance + 1) : 0; }
+	// Until a distance is set, chunks past half of the load radius are meshed at a lower level of detail
+	int GetLodDistance() const;
+
 	bool IsSheepChunk(const XMINT2& chunk);
 
+	// The highest block of a column and its height, only from the noise so no chunk has to exist
+	//	blocks that are placed later, like trees and edits, aren't part of it. Can be called from any thread
+	BlockType GetSurfaceBlock(int worldX, int worldZ, int& surfaceY) const;
+
+	// Other systems can run their jobs next to the chunk jobs
+	JobSystem& GetJobSystem() { return m_JobSystem; }
+
+	// Fills a chunk that isn't part of the world with the terrain at its position, the structures on it aren't spawned
+	//	the sections of the chunk should already be sized for the world height
+	void GenerateTerrain(Chunk& chunk) const;
+
 private:
-	BlockType* GetBlockInChunk(int x, int y, int z, std::vector<Chunk>& chunks) const;
-	BlockType const* GetBlockInChunk(int x, int y, int z, const std::vector<Chunk>& chunks) const;
-	Chunk* GetChunkAt(int x, int z, std::vector<Chunk>& chunks) const;
+	using StructureSpawn = std::pair<const Structure*, XMINT3>;
+	// The lowest height of the skirt of every column on each border of a chunk, in the order of FaceDirection (forward, back, right, left)
+	using SkirtBottoms = std::array<std::array<int, ChunkSection::Size>, 4>;
+
+	static constexpr int MaxLodLevel{ 3 };
+	// The number of chunks that a chunk has to be past the border of a level before it switches
+	static constexpr int LodHysteresis{ 1 };
+
+	// Everything one thread needs to mesh a chunk, every thread that runs mesh jobs has its own
+	struct MeshScratch
+	{
+		// The visible faces of the layer that is being meshed
+		FaceMasks faceMasks{};
+
+		// The tile + 1 of every visible opaque face of the section that is being meshed, per face direction
+		//	the greedy mesher clears every face it merges, so the buffer is empty again after every section
+		std::vector<uint16_t> greedyFaces{};
+		int greedyMinY{ INT_MAX };
+		int greedyMaxY{ -1 };
+	};
+
+	// A chunk that a job has generated, the structures are spawned once the chunk is in the world
+	struct GeneratedChunk
+	{
+		Chunk* pChunk{};
+		std::vector<StructureSpawn> structures{};
+	};
+
+	// A chunk that a job has meshed, its buffers are created on the thread that committed
+	struct MeshedChunk
+	{
+		Chunk* pChunk{};
+		MeshStats stats{};
+	};
+
+	BlockType GetBlockInChunk(int x, int y, int z) const;
+	BlockType GetFluidInChunk(int x, int y, int z) const;
+	bool SetBlockInChunk(int x, int y, int z, BlockType block);
+	bool SetFluidInChunk(int x, int y, int z, BlockType fluid);
+	Chunk* GetChunkAt(int x, int z) const;
+	void MarkDirty(Chunk& chunk, int localX, int y, int localZ);
+	void MarkDirty(int chunkX, int chunkY, uint32_t sectionBits = ~0U);
+	void MarkDirty(Chunk& chunk, uint32_t sectionBits);
 
+	bool IsOpaqueBlock(BlockType block) const;
+	void UpdateColumnMaps(Chunk& chunk, int x, int z) const;
+	void UpdateColumnMaps(Chunk& chunk, int x, int y, int z) const;
+	void GetMeshRange(const Chunk& chunk, int x, int z, int& minY, int& maxY) const;
+
+	std::unique_ptr<Chunk> CreateChunk(int chunkX, int chunkY);
 	void LoadChunk(int x, int y);
-	void ReloadChunks(int changedX, int changedY, int changedZ);
+	// Returns false if the chunk has to be generated, it is added to the world once its job is done
+	bool StartLoadingChunk(int chunkX, int chunkY);
+	bool IsGenerating(int chunkX, int chunkY) const;
+	bool AddGeneratedChunks();
+	void UpdateColumnMaps(Chunk& chunk) const;
+	void GenerateChunk(Chunk& chunk, std::vector<StructureSpawn>& structures) const;
+
+	// Removes the structures that still had to spawn in the chunk, returns whether there were any
+	bool DropStructures(const XMINT2& chunkPosition);
+	bool IsInLoadRange(int chunkX, int chunkY) const;
+	int CalculateLodLevel(int distance) const;
+	int GetLodLevel(const XMINT2& chunkPosition, int curLodLevel) const;
+	void UpdateLodLevels();
+	bool HasNeighbours(const Chunk& chunk) const;
+	// Meshes the dirty chunks in parallel and uploads their vertices
+	//	chunks that still miss a neighbour in render distance can wait, they are meshed again when the neighbour arrives
+	bool MeshDirtyChunks(bool waitForNeighbours, const SceneContext& sceneContext, WorldRenderer* pRenderer);
+	MeshScratch& GetMeshScratch() const;
+
 	void ReloadChunks(int chunkX, int chunkY);
 	void SpawnStructure(const Structure* structure, const XMINT3& position);
-	void CreateVertices(Chunk& chunk, const std::vector<std::vector<Chunk>*>& predicateChunks);
+	// Can run on any thread, as long as no chunk is changed at the same time
+	MeshStats CreateVertices(Chunk& chunk, MeshScratch& scratch) const;
+	void CreateWaterVertices(Chunk& chunk, MeshScratch& scratch) const;
+	// Writes the vertices of every block of the dirty sections into the list of its MeshLayer in the mesh of its section
+	void CreateSectionVertices(Chunk& chunk, bool isFluidLayer, uint32_t dirtyBits, MeshScratch& scratch) const;
+
+	// Checks the neighbour of one face, the mesher finds the visible faces of all blocks at once with m_FaceMasks
+	bool IsFaceVisible(const Chunk& chunk, int x, int y, int z, BlockType block, int faceIdx) const;
 
-	void CreateVerticesCube(Chunk& chunk, int x, int y, int z, const std::vector<std::vector<Chunk>*>& predicateChunks, Block* pBlock, std::vector<VertexPosNormTexTransparency>& vertices, const std::vector<VertexPosNormTexTransparency>& cubeVertices);
-	void CreateVerticesCross(Chunk& chunk, int x, int y, int z, Block* pBlock, std::vector<VertexPosNormTexTransparency>& vertices, const std::vector<VertexPosNormTexTransparency>& crossVertices);
+	// Faces on the border with a chunk of another level of detail hang down as a skirt, so the different surfaces don't leave gaps between them
+	//	INT_MAX on borders without a skirt
+	SkirtBottoms GetSkirtBottoms(const Chunk& chunk, const std::array<const Chunk*, 4>& pNeighbours) const;
+	// The block of a cell of a lower level of detail, the highest cube if most of the cell is cubes and air otherwise
+	BlockType SampleLodCell(const Chunk& chunk, int cellX, int cellY, int cellZ, int cellSize) const;
+	void CreateLodSectionVertices(const Chunk& chunk, int sectionIdx, const std::array<const Chunk*, 4>& pNeighbours, const SkirtBottoms& skirtBottoms, std::vector<ChunkVertex>& vertices) const;
+	void AddGreedyFaces(int x, int y, int z, BlockType block, uint8_t visibleFaces, MeshScratch& scratch) const;
+	void CreateGreedyVertices(const Chunk& chunk, std::vector<ChunkVertex>& vertices, MeshScratch& scratch) const;
+	int GetGreedyFaceIdx(int faceIdx, const XMINT3& position) const { return ((faceIdx * m_WorldHeight + position.y) * m_ChunkSize + position.z) * m_ChunkSize + position.x; }
 
+	void CreateVerticesCube(const Chunk& chunk, int x, int y, int z, BlockType block, uint8_t visibleFaces, std::vector<ChunkVertex>& vertices) const;
+	void CreateVerticesCross(const Chunk& chunk, int x, int y, int z, BlockType block, std::vector<ChunkVertex>& vertices) const;
+
+	// The height of the terrain noise, before the sea fills the columns that are under sea level
+	float GetTerrainHeight(int worldX, int worldZ) const;
+	int GetSurfaceY(float worldHeight) const;
+	float GetBeachSize(int worldX, int worldZ, const Biome& biome) const;
 	Block* GetBlock(const XMINT3& position, float worldHeight, int surfaceY, float beachHeight, const Biome& biome) const;
 
-	std::function<bool(const std::vector<Chunk>& chunks, const XMINT3& position)> m_IsBlockPredicate{};
-	std::function<bool(const std::vector<Chunk>& chunks, const XMINT3& position, BlockType curBlock)> m_CanRenderPredicate{};
+	// Reads the seed of the saved world, or draws a new one from rand when the world has no save yet
+	//	rand is seeded with it, so the noise of the world only depends on its seed
+	unsigned int LoadSeed() const;
+	void SaveSeed() const;
+
+	std::function<bool(BlockType neighbourBlock, BlockType curBlock)> m_CanRenderPredicate{};
 	XMINT3 m_NeighbouringBlocks[6]{};
 
+	std::filesystem::path m_SaveDirectory{};
+	// Declared before the noise, the noise draws its octave seeds from rand
+	unsigned int m_Seed{ LoadSeed() };
+
 	Perlin m_UnderSeaPerlin{};
 	Perlin m_HeightPerlin{};
 	Perlin m_BeachPerlin{};
 	Perlin m_VegitationPerlin{};
 	Perlin m_SheepPerlin{};
-	TileAtlas m_TileMap{};
 
-	std::vector<Chunk> m_Chunks{};
-	std::vector<Chunk> m_WaterChunks{};
+	ChunkPool m_ChunkPool{};
+	ChunkMap m_Chunks{};
+
+	RegionStorage m_RegionStorage{ m_SaveDirectory / "Regions" };
+	ChunkCache m_ChunkCache{ 8 * 1024 * 1024 }; // in bytes
 
 #ifdef _DEBUG
 	int m_RenderDistance{ 2 };
@@ -86,8 +237,30 @@ private:
 
 	bool m_LoadAll{};
 
+	std::atomic<bool> m_UseGreedyMeshing{};
+	std::atomic<int> m_LodDistance{ -1 }; // -1 follows the render distance
+	MeshStats m_MeshStats[2]{};
+
+	// One scratch for every worker of the job system, threads outside the pool have a scratch of their own
+	std::vector<std::unique_ptr<MeshScratch>> m_pMeshScratches{};
+
+	// Chunks that have to be remeshed on the next commit
+	std::unordered_set<Chunk*> m_DirtyChunks{};
+	int m_EditDepth{};
+
 	std::unique_ptr<Block> m_pWaterBlock{};
-	std::vector<std::pair<const Structure*, XMINT3>> m_StructuresToSpawn{};
+	std::vector<StructureSpawn> m_StructuresToSpawn{};
 	int m_WorldWidth{};
+	XMINT2 m_LoadCenter{};
+
+	// Chunks that are being generated by a job, they are only added to the world when the job is done
+	std::vector<std::unique_ptr<Chunk>> m_pGeneratingChunks{};
+	JobSystem::Batch m_GenerationBatch{};
+	JobSystem::Batch m_MeshBatch{};
+	CompletionQueue<GeneratedChunk> m_GeneratedChunks{};
+	CompletionQueue<MeshedChunk> m_MeshedChunks{};
+
+	// Declared last, so the workers are stopped before anything their jobs use is destroyed
+	JobSystem m_JobSystem{};
 };
 
@@ -1,60 +1,77 @@
 #include "stdafx.h"
 #include "WorldRenderer.h"
+#include "QuadMesh.h"
+#include "ChunkVertex.h"
 
-void WorldRenderer::SetBuffers(std::vector<Chunk>& chunks, const SceneContext& sceneContext)
+void WorldRenderer::QueueUpload(Chunk& chunk)
 {
-	for (Chunk& chunk : chunks)
+	// The main thread writes the vertices into the buffer pool when it takes the chunk over, the immediate context can't be used on this thread
+	if (chunk.waterVerticesChanged)
 	{
-		if(chunk.verticesChanged) SetBuffer(chunk, sceneContext);
+		chunk.waterVerticesChanged = false;
+		chunk.hasNewWaterVertices = true;
 	}
-}
-
-void WorldRenderer::SetBuffer(Chunk& chunk, const SceneContext& sceneContext)
-{
-	chunk.verticesChanged = false;
 
-	auto& vertices{ chunk.vertices };
+	if (!chunk.verticesChanged) return;
 
-	if (vertices.size() == 0) return;
-
-	std::stable_partition(begin(vertices), end(vertices), [](const VertexPosNormTexTransparency& v) { return !v.Transparent; });
-	const int nrTransparent{ static_cast<int>(std::count_if(begin(vertices), end(vertices), [](const VertexPosNormTexTransparency& v) {return v.Transparent; })) };
-
-	//*************
-	//VERTEX BUFFER
-	D3D11_BUFFER_DESC vertexBuffDesc{};
-	vertexBuffDesc.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_VERTEX_BUFFER;
-	vertexBuffDesc.ByteWidth = static_cast<UINT>(sizeof(VertexPosNormTexTransparency) * (vertices.size() - nrTransparent));
-	vertexBuffDesc.CPUAccessFlags = D3D11_CPU_ACCESS_FLAG::D3D11_CPU_ACCESS_WRITE;
-	vertexBuffDesc.Usage = D3D11_USAGE::D3D11_USAGE_DYNAMIC;
-	vertexBuffDesc.MiscFlags = 0;
-
-	D3D11_SUBRESOURCE_DATA initData{};
-	initData.pSysMem = vertices.data();
+	chunk.verticesChanged = false;
+	chunk.hasNewVertices = true;
+}
 
-	chunk.vertexBufferSize = static_cast<int>(chunk.vertices.size()) - nrTransparent;
-	if (chunk.vertexBufferSize > 0) sceneContext.d3dContext.pDevice->CreateBuffer(&vertexBuffDesc, &initData, &chunk.pVertexBuffer);
+void WorldRenderer::UploadVertices(const std::vector<ChunkVertex>& vertices, int& meshHandle, const SceneContext& sceneContext)
+{
+	m_BufferPool.Upload(vertices, meshHandle, sceneContext);
 
-	vertexBuffDesc.ByteWidth = static_cast<UINT>(sizeof(VertexPosNormTexTransparency) * nrTransparent);
+	// Make sure the shared index buffer will cover these quads
+	m_MaxNrChunkQuads = std::max(m_MaxNrChunkQuads, QuadMesh::GetNrQuads(vertices.size()));
+}
 
-	std::stable_partition(begin(vertices), end(vertices), [](const VertexPosNormTexTransparency& v) { return v.Transparent; });
+void WorldRenderer::FreeMeshes(Chunk& chunk)
+{
+	for (int& meshHandle : chunk.meshHandles) m_BufferPool.Free(meshHandle);
+	m_BufferPool.Free(chunk.waterMeshHandle);
+}
 
-	chunk.vertexTransparentBufferSize = nrTransparent;
-	if(chunk.vertexTransparentBufferSize > 0) sceneContext.d3dContext.pDevice->CreateBuffer(&vertexBuffDesc, &initData, &chunk.pVertexTransparentBuffer);
+void WorldRenderer::DefragmentBuffers(const SceneContext& sceneContext)
+{
+	// A few meshes per frame, so emptying a page doesn't cost one frame a lot of copies
+	constexpr int maxNrMovesPerFrame{ 8 };
+	m_BufferPool.Defragment(maxNrMovesPerFrame, sceneContext);
 }
 
 WorldRenderer::~WorldRenderer()
 {
 	SafeRelease(m_pInputLayout);
+	SafeRelease(m_pQuadIndexBuffer);
+	SafeRelease(m_pFarTerrainInputLayout);
+	SafeRelease(m_pFarTerrainIndexBuffer);
 }
 
 void WorldRenderer::LoadEffect(const SceneContext& sceneContext)
 {
 	m_pEffect = ContentManager::Load<ID3DX11Effect>(L"Effects\\World.fx");
-	m_pDefaultTechnique = m_pEffect->GetTechniqueByIndex(0);
-	m_pTransparentTechnique = m_pEffect->GetTechniqueByIndex(1);
+	// Chunk meshes use packed vertices, see ChunkVertex
+	m_pDefaultTechnique = m_pEffect->GetTechniqueByName("Tiled");
+	m_pCutoutTechnique = m_pEffect->GetTechniqueByName("TiledCutout");
+	m_pTransparentTechnique = m_pEffect->GetTechniqueByName("TiledTransparent");
+	m_pShadowTechnique = m_pEffect->GetTechniqueByName("TiledShadow");
+	m_pCutoutShadowTechnique = m_pEffect->GetTechniqueByName("TiledCutoutShadow");
 	EffectHelper::BuildInputLayout(sceneContext.d3dContext.pDevice, m_pDefaultTechnique, &m_pInputLayout);
 
+	// The packed vertices get their normal and offset inside the block from these tables
+	const ChunkVertex::FaceData& faceData{ ChunkVertex::GetFaceData() };
+	m_pEffect->GetVariableByName("gFaceNormals")->AsVector()->SetFloatVectorArray(reinterpret_cast<const float*>(faceData.normals), 0, ChunkVertex::NrFaces);
+	m_pEffect->GetVariableByName("gCornerOffsets")->AsVector()->SetFloatVectorArray(reinterpret_cast<const float*>(faceData.cornerOffsets), 0, ChunkVertex::NrFaces * ChunkVertex::NrCorners);
+	m_pEffect->GetVariableByName("gLoweredTopOffset")->AsScalar()->SetFloat(ChunkVertex::LoweredTopOffset);
+
+	m_pChunkOriginVar = m_pEffect->GetVariableByName("gChunkOrigin")->AsVector();
+
+	// The far terrain uses float vertices and draws every tile with the same grid indices
+	m_pFarTerrainTechnique = m_pEffect->GetTechniqueByName("FarTerrain");
+	EffectHelper::BuildInputLayout(sceneContext.d3dContext.pDevice, m_pFarTerrainTechnique, &m_pFarTerrainInputLayout);
+	m_pFarFadeVar = m_pEffect->GetVariableByName("gFarFade")->AsVector();
+	CreateFarTerrainIndexBuffer(sceneContext);
+
 	m_pWorldVar = m_pEffect->GetVariableBySemantic("World")->AsMatrix();
 
 	m_pWvpVar = m_pEffect->GetVariableBySemantic("WorldViewProjection")->AsMatrix();
@@ -68,62 +85,226 @@ void WorldRenderer::LoadEffect(const SceneContext& sceneContext)
 	m_pLightDirVar = m_pEffect->GetVariableByName("gLightDirection")->AsVector();
 }
 
-void WorldRenderer::Draw(std::vector<Chunk>& chunks, const SceneContext& sceneContext)
+void WorldRenderer::Draw(const ChunkMap& chunks, const SceneContext& sceneContext)
 {
-	const D3D11Context& deviceContext{ sceneContext.d3dContext };
+	UpdateEffectVariables(sceneContext);
+	m_CameraCuller.Begin(sceneContext.pCamera->GetViewProjection());
+	CullChunks(chunks, false, m_CameraCuller);
+	FindVisibleSections(chunks, sceneContext);
+	m_DrawList.Build(chunks, GetCameraChunk(sceneContext));
+
+	// Solid blocks first, then the clipped blocks and the blended blocks last so they blend over the rest
+	//	only the camera passes count as the draw calls of the frame, the shadow pass keeps its own stats
+	const auto addDrawCalls{ [](const DrawStats& stats) { GameStats::AddDrawCalls(stats.nrDrawCalls, stats.nrCulledDrawCalls); } };
+	addDrawCalls(DrawLayer(MeshLayer::SOLID, m_pDefaultTechnique, &m_CameraCuller, true, sceneContext));
+	addDrawCalls(DrawLayer(MeshLayer::CUTOUT, m_pCutoutTechnique, &m_CameraCuller, true, sceneContext));
+	addDrawCalls(DrawLayer(MeshLayer::TRANSLUCENT, m_pTransparentTechnique, &m_CameraCuller, true, sceneContext));
+}
 
-	constexpr XMFLOAT4X4 worldMatrix{ 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
-	XMMATRIX world = XMLoadFloat4x4(&worldMatrix);
-	const auto viewProjection = XMLoadFloat4x4(&sceneContext.pCamera->GetViewProjection());
+void WorldRenderer::DrawWater(const ChunkMap& chunks, const SceneContext& sceneContext)
+{
+	UpdateEffectVariables(sceneContext);
+	m_CameraCuller.Begin(sceneContext.pCamera->GetViewProjection());
+	CullChunks(chunks, true, m_CameraCuller);
+	m_DrawList.Build(chunks, GetCameraChunk(sceneContext));
 
-	m_pWorldVar->SetMatrix(reinterpret_cast<float*>(&world));
-	m_pWvpVar->SetMatrix(reinterpret_cast<const float*>(&viewProjection));
-	m_pLightWvpVar->SetMatrix(reinterpret_cast<const float*>(&ShadowMapRenderer::Get()->GetLightVP()));
+	// The water blends, so the farthest chunks are drawn first
+	const std::vector<ChunkDrawList::Entry>& entries{ m_DrawList.GetEntries() };
 
-	// Update the ShadowMap texture
-	m_pShadowMapVariable->SetResource(ShadowMapRenderer::Get()->GetShadowMap());
+	int nrDrawCalls{};
+	int nrCulledDrawCalls{};
+	for (auto it{ entries.rbegin() }; it != entries.rend(); ++it)
+	{
+		const Chunk& chunk{ *it->pChunk };
+		const bool isVisible{ m_CameraCuller.IsVisible(it->chunkIdx) };
+		if (chunk.waterMeshHandle < 0 || !chunk.waterVertexBufferSize) continue;
 
-	// Update the Light Direction (retrieve the direction from the LightManager > sceneContext)
-	m_pLightDirVar->SetFloatVector(reinterpret_cast<const float*>(&sceneContext.pLights->GetDirectionalLight().direction));
+		// The water isn't split in sections, so it is drawn when any section of its chunk can be seen
+		if (!isVisible || !chunk.visibleSectionBits)
+		{
+			++nrCulledDrawCalls;
+			continue;
+		}
 
-	deviceContext.pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	deviceContext.pDeviceContext->IASetInputLayout(m_pInputLayout);
+		DrawBuffer(chunk, chunk.waterMeshHandle, 0, chunk.waterVertexBufferSize, m_pTransparentTechnique, sceneContext);
+		++nrDrawCalls;
+	}
 
-	constexpr UINT offset = 0;
-	constexpr UINT stride = sizeof(VertexPosNormTexTransparency);
+	GameStats::AddDrawCalls(nrDrawCalls, nrCulledDrawCalls);
+}
 
-	D3DX11_TECHNIQUE_DESC techDesc{};
-	m_pDefaultTechnique->GetDesc(&techDesc);
+void WorldRenderer::CullChunks(const ChunkMap& chunks, bool isWater, FrustumCuller& culler)
+{
 	for (const Chunk& chunk : chunks)
 	{
-		if (!chunk.vertexBufferSize) continue;
-		if (!chunk.pVertexBuffer) continue;
+		// The bounds are relative to the chunk
+		BoundingBox box{ isWater ? chunk.waterBounds : chunk.bounds };
+		const XMFLOAT3 origin{ chunk.GetOrigin() };
+		box.Center.x += origin.x;
+		box.Center.y += origin.y;
+		box.Center.z += origin.z;
+
+		culler.AddBox(box);
+	}
 
-		deviceContext.pDeviceContext->IASetVertexBuffers(0, 1, &chunk.pVertexBuffer, &stride, &offset);
+	culler.Cull();
+}
 
-		for (UINT p = 0; p < techDesc.Passes; ++p)
+XMINT2 WorldRenderer::GetCameraChunk(const SceneContext& sceneContext)
+{
+	// Chunks are as wide as a section
+	const XMFLOAT3& cameraPosition{ sceneContext.pCamera->GetTransform()->GetWorldPosition() };
+	return XMINT2{ static_cast<int>(floorf(cameraPosition.x / ChunkSection::Size)), static_cast<int>(floorf(cameraPosition.z / ChunkSection::Size)) };
+}
+
+void WorldRenderer::FindVisibleSections(const ChunkMap& chunks, const SceneContext& sceneContext)
+{
+	constexpr int sectionSize{ ChunkSection::Size };
+	// The step to the next section through every face, in the order of FaceDirection
+	constexpr XMINT3 faceSteps[SectionVisibility::NrFaces]{ { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 } };
+
+	m_CaveStats = CaveStats{};
+
+	// Find the section that the camera is in
+	const XMINT2 cameraChunk{ GetCameraChunk(sceneContext) };
+	const XMINT3 cameraSection{ cameraChunk.x, static_cast<int>(floorf(sceneContext.pCamera->GetTransform()->GetWorldPosition().y / sectionSize)), cameraChunk.y };
+	Chunk* pCameraChunk{ m_IsCaveCulling ? chunks.Find(cameraChunk) : nullptr };
+
+	// Every section stays visible when the walk can't start in a loaded section, like above the world
+	const bool canWalk{ pCameraChunk && cameraSection.y >= 0 && cameraSection.y < static_cast<int>(pCameraChunk->sectionVisibility.size()) };
+	for (Chunk& chunk : chunks) chunk.visibleSectionBits = canWalk ? 0U : ~0U;
+	if (!canWalk) return;
+
+	// Walk breadth first from the section of the camera, the bits of the chunks mark the sections that have been reached
+	//	a section is left through the faces that see the face it was entered through
+	//	the walk never goes against a direction it has gone in before, so it only spreads away from the camera
+	m_SectionSteps.clear();
+	m_SectionSteps.emplace_back(SectionStep{ pCameraChunk, cameraSection, -1, 0 });
+	pCameraChunk->visibleSectionBits |= 1U << cameraSection.y;
+
+	for (size_t stepIdx{}; stepIdx < m_SectionSteps.size(); ++stepIdx)
+	{
+		// Copied, the steps that are added can move the list
+		const SectionStep step{ m_SectionSteps[stepIdx] };
+		const SectionVisibility& visibility{ step.pChunk->sectionVisibility[step.position.y] };
+
+		for (int faceIdx{}; faceIdx < SectionVisibility::NrFaces; ++faceIdx)
 		{
-			m_pDefaultTechnique->GetPassByIndex(p)->Apply(0, deviceContext.pDeviceContext);
-			deviceContext.pDeviceContext->Draw(static_cast<UINT>(chunk.vertexBufferSize), 0);
+			// The opposite face of every FaceDirection is the next or previous one
+			const int oppositeFaceIdx{ faceIdx ^ 1 };
+			if ((step.directions >> oppositeFaceIdx) & 1U) continue;
+			if (step.entryFace >= 0 && !visibility.IsConnected(step.entryFace, faceIdx)) continue;
+
+			const XMINT3 position{ step.position.x + faceSteps[faceIdx].x, step.position.y + faceSteps[faceIdx].y, step.position.z + faceSteps[faceIdx].z };
+			Chunk* pChunk{ faceSteps[faceIdx].y ? step.pChunk : chunks.Find(position.x, position.z) };
+			if (!pChunk || position.y < 0 || position.y >= static_cast<int>(pChunk->sectionVisibility.size())) continue;
+			if ((pChunk->visibleSectionBits >> position.y) & 1U) continue;
+
+			// Sections outside the view can't be seen, so the walk doesn't go through them either
+			const BoundingBox sectionBox
+			{
+				XMFLOAT3{ (position.x + 0.5f) * sectionSize, (position.y + 0.5f) * sectionSize, (position.z + 0.5f) * sectionSize },
+				XMFLOAT3{ 0.5f * sectionSize, 0.5f * sectionSize, 0.5f * sectionSize }
+			};
+			if (!m_CameraCuller.IsBoxVisible(sectionBox)) continue;
+
+			pChunk->visibleSectionBits |= 1U << position.y;
+			m_SectionSteps.emplace_back(SectionStep{ pChunk, position, oppositeFaceIdx, static_cast<uint8_t>(step.directions | (1U << faceIdx)) });
 		}
 	}
-;
-	m_pTransparentTechnique->GetDesc(&techDesc);
-	for (const Chunk& chunk : chunks)
+
+	for (const Chunk& chunk : chunks) m_CaveStats.nrHiddenSections += static_cast<int>(chunk.sectionVisibility.size());
+	m_CaveStats.nrVisibleSections = static_cast<int>(m_SectionSteps.size());
+	m_CaveStats.nrHiddenSections -= m_CaveStats.nrVisibleSections;
+}
+
+WorldRenderer::DrawStats WorldRenderer::DrawLayer(MeshLayer layer, ID3DX11EffectTechnique* pTechnique, const FrustumCuller* pCuller, bool onlyVisibleSections, const SceneContext& sceneContext)
+{
+	const int layerIdx{ static_cast<int>(layer) };
+
+	// Opaque and clipped blocks are drawn nearest first, blended blocks farthest first so they blend over what is behind them
+	const std::vector<ChunkDrawList::Entry>& entries{ m_DrawList.GetEntries() };
+	const bool isBackToFront{ layer == MeshLayer::TRANSLUCENT };
+
+	int nrDrawCalls{};
+	int nrCulledDrawCalls{};
+	for (size_t entryIdx{}; entryIdx < entries.size(); ++entryIdx)
 	{
-		if (!chunk.pVertexTransparentBuffer) continue;
+		const ChunkDrawList::Entry& entry{ entries[isBackToFront ? entries.size() - 1 - entryIdx : entryIdx] };
+		const Chunk& chunk{ *entry.pChunk };
 
-		deviceContext.pDeviceContext->IASetVertexBuffers(0, 1, &chunk.pVertexTransparentBuffer, &stride, &offset);
+		// The culler has a box for every chunk, also for the chunks without vertices in this layer
+		const bool isVisible{ !pCuller || pCuller->IsVisible(entry.chunkIdx) };
 
-		for (UINT p = 0; p < techDesc.Passes; ++p)
+		if (chunk.meshHandles[layerIdx] < 0 || !chunk.vertexBufferSizes[layerIdx]) continue;
+
+		if (!isVisible)
+		{
+			++nrCulledDrawCalls;
+			continue;
+		}
+
+		// Every section is visible, or the buffer doesn't belong to the section starts
+		const std::vector<int>& sectionStarts{ chunk.sectionVertexStarts[layerIdx] };
+		const uint32_t visibleSectionBits{ onlyVisibleSections ? chunk.visibleSectionBits : ~0U };
+		const int nrSections{ static_cast<int>(sectionStarts.size()) - 1 };
+		if (visibleSectionBits == ~0U || nrSections <= 0 || sectionStarts.back() != chunk.vertexBufferSizes[layerIdx])
+		{
+			DrawBuffer(chunk, chunk.meshHandles[layerIdx], 0, chunk.vertexBufferSizes[layerIdx], pTechnique, sceneContext);
+			++nrDrawCalls;
+			continue;
+		}
+
+		// The vertices of the sections follow each other, so every run of visible sections is one draw
+		bool hasDrawn{};
+		for (int sectionIdx{}; sectionIdx < nrSections;)
 		{
-			m_pTransparentTechnique->GetPassByIndex(p)->Apply(0, deviceContext.pDeviceContext);
-			deviceContext.pDeviceContext->Draw(static_cast<UINT>(chunk.vertexTransparentBufferSize), 0);
+			if (!((visibleSectionBits >> sectionIdx) & 1U))
+			{
+				++sectionIdx;
+				continue;
+			}
+
+			const int firstVertex{ sectionStarts[sectionIdx] };
+			while (sectionIdx < nrSections && ((visibleSectionBits >> sectionIdx) & 1U)) ++sectionIdx;
+			const int nrVertices{ sectionStarts[sectionIdx] - firstVertex };
+			if (!nrVertices) continue;
+
+			DrawBuffer(chunk, chunk.meshHandles[layerIdx], firstVertex, nrVertices, pTechnique, sceneContext);
+			++nrDrawCalls;
+			hasDrawn = true;
 		}
+
+		if (!hasDrawn) ++nrCulledDrawCalls;
 	}
+
+	return DrawStats{ nrDrawCalls, nrCulledDrawCalls };
 }
 
-void WorldRenderer::Draw(Chunk& chunk, const SceneContext& sceneContext)
+void WorldRenderer::DrawBuffer(const Chunk& chunk, int meshHandle, int firstVertex, int nrVertices, ID3DX11EffectTechnique* pTechnique, const SceneContext& sceneContext)
+{
+	const ChunkBufferPool::Mesh mesh{ m_BufferPool.GetMesh(meshHandle) };
+	if (!mesh.pBuffer || !nrVertices) return;
+
+	const D3D11Context& deviceContext{ sceneContext.d3dContext };
+
+	// The mesh is a range of a page of the pool, so its first vertex is added to the base vertex of the draw
+	constexpr UINT offset = 0;
+	constexpr UINT stride = sizeof(ChunkVertex);
+	deviceContext.pDeviceContext->IASetVertexBuffers(0, 1, &mesh.pBuffer, &stride, &offset);
+	SetChunkOrigin(chunk);
+
+	D3DX11_TECHNIQUE_DESC techDesc{};
+	pTechnique->GetDesc(&techDesc);
+	for (UINT p = 0; p < techDesc.Passes; ++p)
+	{
+		pTechnique->GetPassByIndex(p)->Apply(0, deviceContext.pDeviceContext);
+		// Every quad uses the same indices, so a run of quads starts with the base vertex
+		deviceContext.pDeviceContext->DrawIndexed(static_cast<UINT>(QuadMesh::GetNrIndices(nrVertices)), 0, mesh.firstVertex + firstVertex);
+	}
+}
+
+void WorldRenderer::UpdateEffectVariables(const SceneContext& sceneContext)
 {
 	const D3D11Context& deviceContext{ sceneContext.d3dContext };
 
@@ -144,39 +325,163 @@ void WorldRenderer::Draw(Chunk& chunk, const SceneContext& sceneContext)
 	deviceContext.pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	deviceContext.pDeviceContext->IASetInputLayout(m_pInputLayout);
 
-	constexpr UINT offset = 0;
-	constexpr UINT stride = sizeof(VertexPosNormTexTransparency);
+	UpdateIndexBuffer(sceneContext);
+	deviceContext.pDeviceContext->IASetIndexBuffer(m_pQuadIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+}
 
-	D3DX11_TECHNIQUE_DESC techDesc{};
-	if (chunk.pVertexBuffer && chunk.vertexBufferSize)
-	{
-		deviceContext.pDeviceContext->IASetVertexBuffers(0, 1, &chunk.pVertexBuffer, &stride, &offset);
+void WorldRenderer::UpdateIndexBuffer(const SceneContext& sceneContext)
+{
+	// The uploads report the most quads a draw can need, the buffer only grows when that doesn't fit anymore
+	const int nrQuads{ QuadMesh::GetNrIndexBufferQuads(m_MaxNrChunkQuads, m_NrIndexBufferQuads) };
+	if (nrQuads == m_NrIndexBufferQuads) return;
+
+	std::vector<uint32_t> indices{};
+	QuadMesh::CreateIndices(nrQuads, indices);
+
+	//************
+	//INDEX BUFFER
+	D3D11_BUFFER_DESC indexBuffDesc{};
+	indexBuffDesc.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_INDEX_BUFFER;
+	indexBuffDesc.ByteWidth = static_cast<UINT>(sizeof(uint32_t) * indices.size());
+	indexBuffDesc.CPUAccessFlags = 0;
+	indexBuffDesc.Usage = D3D11_USAGE::D3D11_USAGE_IMMUTABLE;
+	indexBuffDesc.MiscFlags = 0;
 
-		m_pDefaultTechnique->GetDesc(&techDesc);
-		for (UINT p = 0; p < techDesc.Passes; ++p)
+	D3D11_SUBRESOURCE_DATA initData{};
+	initData.pSysMem = indices.data();
+
+	SafeRelease(m_pQuadIndexBuffer);
+	sceneContext.d3dContext.pDevice->CreateBuffer(&indexBuffDesc, &initData, &m_pQuadIndexBuffer);
+
+	m_NrIndexBufferQuads = nrQuads;
+}
+
+void WorldRenderer::Draw(Chunk& chunk, const SceneContext& sceneContext)
+{
+	UpdateEffectVariables(sceneContext);
+
+	DrawBuffer(chunk, chunk.meshHandles[static_cast<int>(MeshLayer::SOLID)], 0, chunk.vertexBufferSizes[static_cast<int>(MeshLayer::SOLID)], m_pDefaultTechnique, sceneContext);
+	DrawBuffer(chunk, chunk.meshHandles[static_cast<int>(MeshLayer::CUTOUT)], 0, chunk.vertexBufferSizes[static_cast<int>(MeshLayer::CUTOUT)], m_pCutoutTechnique, sceneContext);
+	DrawBuffer(chunk, chunk.meshHandles[static_cast<int>(MeshLayer::TRANSLUCENT)], 0, chunk.vertexBufferSizes[static_cast<int>(MeshLayer::TRANSLUCENT)], m_pTransparentTechnique, sceneContext);
+}
+
+void WorldRenderer::DrawShadowMap(const ChunkMap& chunks, const SceneContext& sceneContext)
+{
+	const D3D11Context& deviceContext{ sceneContext.d3dContext };
+
+	// The engine's shadow generator reads float positions, so the packed chunk vertices have their own shadow technique
+	//	the shadow map is the depth target now, so it must not be bound as a texture
+	const XMFLOAT4X4& lightViewProjection{ ShadowMapRenderer::Get()->GetLightVP() };
+	m_pLightWvpVar->SetMatrix(reinterpret_cast<const float*>(&lightViewProjection));
+
+	// A chunk only casts a shadow that is seen when it is inside the light's frustum, and when the light carries its shadow into the view of the camera
+	//	the camera planes that the light points away from can't be crossed by a shadow, so chunks behind them are skipped
+	const XMFLOAT4& lightDirection{ sceneContext.pLights->GetDirectionalLight().direction };
+	m_ShadowCuller.Begin(lightViewProjection);
+	m_ShadowCuller.AddSweptFrustum(sceneContext.pCamera->GetViewProjection(), XMFLOAT3{ lightDirection.x, lightDirection.y, lightDirection.z });
+	CullChunks(chunks, false, m_ShadowCuller);
+	m_DrawList.Build(chunks, GetCameraChunk(sceneContext));
+
+	deviceContext.pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	deviceContext.pDeviceContext->IASetInputLayout(m_pInputLayout);
+
+	UpdateIndexBuffer(sceneContext);
+	deviceContext.pDeviceContext->IASetIndexBuffer(m_pQuadIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+
+	// Cutout blocks cast the shadow of their texture, blended blocks don't cast shadows
+	const DrawStats solidStats{ DrawLayer(MeshLayer::SOLID, m_pShadowTechnique, &m_ShadowCuller, false, sceneContext) };
+	const DrawStats cutoutStats{ DrawLayer(MeshLayer::CUTOUT, m_pCutoutShadowTechnique, &m_ShadowCuller, false, sceneContext) };
+	m_ShadowStats = DrawStats{ solidStats.nrDrawCalls + cutoutStats.nrDrawCalls, solidStats.nrCulledDrawCalls + cutoutStats.nrCulledDrawCalls };
+}
+
+void WorldRenderer::DrawFarTerrain(const FarTerrain& farTerrain, const XMINT2& chunkCenter, int renderDistance, int chunkSize, const SceneContext& sceneContext)
+{
+	if (farTerrain.GetDistance() == 0) return;
+
+	const D3D11Context& deviceContext{ sceneContext.d3dContext };
+
+	UpdateEffectVariables(sceneContext);
+
+	// The center chunk goes from half a block before its first block to half a block after its last block
+	//	the far terrain is gone one chunk before the edge of the chunks and fully drawn on the edge
+	const float chunkWidth{ static_cast<float>(chunkSize) };
+	const XMFLOAT4 fade
+	{
+		(chunkCenter.x + 0.5f) * chunkWidth - 0.5f,
+		(chunkCenter.y + 0.5f) * chunkWidth - 0.5f,
+		(renderDistance - 0.5f) * chunkWidth,
+		(renderDistance + 0.5f) * chunkWidth
+	};
+	m_pFarFadeVar->SetFloatVector(reinterpret_cast<const float*>(&fade));
+
+	deviceContext.pDeviceContext->IASetInputLayout(m_pFarTerrainInputLayout);
+	deviceContext.pDeviceContext->IASetIndexBuffer(m_pFarTerrainIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+
+	// The tiles are in the same order in the culler as in the map
+	const auto& tiles{ farTerrain.GetTiles() };
+	m_CameraCuller.Begin(sceneContext.pCamera->GetViewProjection());
+	for (const auto& [key, tile] : tiles) m_CameraCuller.AddBox(tile.bounds);
+	m_CameraCuller.Cull();
+
+	int nrDrawCalls{};
+	int nrCulledDrawCalls{};
+	int tileIdx{};
+	const float tileWidth{ static_cast<float>(FarTerrain::TileSize) * chunkWidth };
+	for (const auto& [key, tile] : tiles)
+	{
+		const bool isVisible{ m_CameraCuller.IsVisible(tileIdx++) };
+		if (!tile.pVertexBuffer) continue;
+
+		// Skip the tiles that are completely hidden by the chunks
+		const float minX{ tile.position.x * tileWidth - fade.x };
+		const float minZ{ tile.position.y * tileWidth - fade.y };
+		const float maxDistance{ std::max(std::max(std::abs(minX), std::abs(minX + tileWidth)), std::max(std::abs(minZ), std::abs(minZ + tileWidth))) };
+		if (!isVisible || maxDistance < fade.z)
 		{
-			m_pDefaultTechnique->GetPassByIndex(p)->Apply(0, deviceContext.pDeviceContext);
-			deviceContext.pDeviceContext->Draw(static_cast<UINT>(chunk.vertexBufferSize), 0);
+			++nrCulledDrawCalls;
+			continue;
 		}
-	}
 
-	if (chunk.pVertexTransparentBuffer && chunk.vertexTransparentBufferSize)
-	{
-		deviceContext.pDeviceContext->IASetVertexBuffers(0, 1, &chunk.pVertexTransparentBuffer, &stride, &offset);
+		constexpr UINT offset = 0;
+		constexpr UINT stride = sizeof(FarTerrain::Vertex);
+		deviceContext.pDeviceContext->IASetVertexBuffers(0, 1, &tile.pVertexBuffer, &stride, &offset);
 
-		m_pTransparentTechnique->GetDesc(&techDesc);
+		D3DX11_TECHNIQUE_DESC techDesc{};
+		m_pFarTerrainTechnique->GetDesc(&techDesc);
 		for (UINT p = 0; p < techDesc.Passes; ++p)
 		{
-			m_pTransparentTechnique->GetPassByIndex(p)->Apply(0, deviceContext.pDeviceContext);
-			deviceContext.pDeviceContext->Draw(static_cast<UINT>(chunk.vertexTransparentBufferSize), 0);
+			m_pFarTerrainTechnique->GetPassByIndex(p)->Apply(0, deviceContext.pDeviceContext);
+			deviceContext.pDeviceContext->DrawIndexed(static_cast<UINT>(FarTerrain::GetNrIndices()), 0, 0);
 		}
+		++nrDrawCalls;
 	}
+
+	GameStats::AddDrawCalls(nrDrawCalls, nrCulledDrawCalls);
 }
 
-void WorldRenderer::DrawShadowMap(const Chunk& chunk, const SceneContext& sceneContext)
+void WorldRenderer::CreateFarTerrainIndexBuffer(const SceneContext& sceneContext)
 {
-	constexpr UINT stride = sizeof(VertexPosNormTexTransparency);
-	constexpr XMFLOAT4X4 worldMatrix{ 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+	std::vector<uint32_t> indices{};
+	FarTerrain::CreateIndices(indices);
+
+	//************
+	//INDEX BUFFER
+	D3D11_BUFFER_DESC indexBuffDesc{};
+	indexBuffDesc.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_INDEX_BUFFER;
+	indexBuffDesc.ByteWidth = static_cast<UINT>(sizeof(uint32_t) * indices.size());
+	indexBuffDesc.CPUAccessFlags = 0;
+	indexBuffDesc.Usage = D3D11_USAGE::D3D11_USAGE_IMMUTABLE;
+	indexBuffDesc.MiscFlags = 0;
+
+	D3D11_SUBRESOURCE_DATA initData{};
+	initData.pSysMem = indices.data();
 
-	ShadowMapRenderer::Get()->DrawMesh(sceneContext, chunk.pVertexBuffer, chunk.vertexBufferSize, stride, worldMatrix);
+	sceneContext.d3dContext.pDevice->CreateBuffer(&indexBuffDesc, &initData, &m_pFarTerrainIndexBuffer);
+}
+
+void WorldRenderer::SetChunkOrigin(const Chunk& chunk)
+{
+	const XMFLOAT3 chunkOrigin{ chunk.GetOrigin() };
+	const XMFLOAT4 origin{ chunkOrigin.x, chunkOrigin.y, chunkOrigin.z, 0.0f };
+	m_pChunkOriginVar->SetFloatVector(reinterpret_cast<const float*>(&origin));
 }
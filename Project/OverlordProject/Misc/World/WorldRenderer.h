@@ -1,29 +1,116 @@
 #pragma once
-#include "Chunk.h"
+#include "ChunkBufferPool.h"
+#include "ChunkDrawList.h"
+#include "ChunkMap.h"
+#include "FarTerrain.h"
+#include "Utils/FrustumCuller.h"
 
 class WorldRenderer final
 {
 public:
+	struct DrawStats
+	{
+		int nrDrawCalls{};
+		int nrCulledDrawCalls{};
+	};
+
+	struct CaveStats
+	{
+		int nrVisibleSections{};
+		int nrHiddenSections{};
+	};
+
 	~WorldRenderer();
 
 	void LoadEffect(const SceneContext& sceneContext);
-	void SetBuffers(std::vector<Chunk>& chunks, const SceneContext& sceneContext);
-	void SetBuffer(Chunk& chunk, const SceneContext& sceneContext);
+	// Called by the world thread once the vertices of the chunk are done
+	void QueueUpload(Chunk& chunk);
+	// Only call these from the main thread, the meshes are written with the immediate context
+	void UploadVertices(const std::vector<ChunkVertex>& vertices, int& meshHandle, const SceneContext& sceneContext);
+	void FreeMeshes(Chunk& chunk);
+	void DefragmentBuffers(const SceneContext& sceneContext);
+	ChunkBufferPool::Stats GetBufferStats() const { return m_BufferPool.GetStats(); }
+
+	void Draw(const ChunkMap& chunks, const SceneContext& sceneContext);
+	void DrawWater(const ChunkMap& chunks, const SceneContext& sceneContext);
+	// Only the chunks that are in the light's frustum and can cast a shadow into the view of the camera are drawn
+	void DrawShadowMap(const ChunkMap& chunks, const SceneContext& sceneContext);
+	// The far terrain fades out over the outer chunks of the render distance around the center chunk
+	void DrawFarTerrain(const FarTerrain& farTerrain, const XMINT2& chunkCenter, int renderDistance, int chunkSize, const SceneContext& sceneContext);
 
-	void Draw(std::vector<Chunk>& chunks, const SceneContext& sceneContext);
-	void DrawShadowMap(const Chunk& chunk, const SceneContext& sceneContext);
+	// The chunks of the last shadow pass, for profiling
+	const DrawStats& GetShadowStats() const { return m_ShadowStats; }
+
+	// Sections that the camera can't reach through air are not drawn, the shadow pass still draws them
+	void SetCaveCulling(bool isCaveCulling) { m_IsCaveCulling = isCaveCulling; }
+	bool IsCaveCulling() const { return m_IsCaveCulling; }
+	const CaveStats& GetCaveStats() const { return m_CaveStats; }
+	const ChunkDrawList& GetDrawList() const { return m_DrawList; }
 private:
+	// A section that the walk through the caves has reached
+	struct SectionStep
+	{
+		Chunk* pChunk{};
+		XMINT3 position{}; // x and z in chunks, y in sections
+		int entryFace{}; // -1 for the section of the camera
+		uint8_t directions{}; // One bit per FaceDirection that the walk has gone in to get here
+	};
+
+	void UpdateEffectVariables(const SceneContext& sceneContext);
+	void UpdateIndexBuffer(const SceneContext& sceneContext);
+	void CreateFarTerrainIndexBuffer(const SceneContext& sceneContext);
+	void SetChunkOrigin(const Chunk& chunk);
 	void Draw(Chunk& chunk, const SceneContext& sceneContext);
+	// Tests the box of every chunk against the planes of the culler, in the order of the chunk map
+	void CullChunks(const ChunkMap& chunks, bool isWater, FrustumCuller& culler);
+	static XMINT2 GetCameraChunk(const SceneContext& sceneContext);
+	// Walks from the section of the camera through the faces that see each other and marks the sections it reaches in view of the camera culler
+	void FindVisibleSections(const ChunkMap& chunks, const SceneContext& sceneContext);
+	// Without a culler every chunk is drawn, without the visible sections every section of a chunk is drawn
+	//	the chunks are drawn in the order of the draw list
+	DrawStats DrawLayer(MeshLayer layer, ID3DX11EffectTechnique* pTechnique, const FrustumCuller* pCuller, bool onlyVisibleSections, const SceneContext& sceneContext);
+	void DrawBuffer(const Chunk& chunk, int meshHandle, int firstVertex, int nrVertices, ID3DX11EffectTechnique* pTechnique, const SceneContext& sceneContext);
 	ID3DX11EffectMatrixVariable* m_pWorldVar{};
 	ID3DX11EffectMatrixVariable* m_pWvpVar{};
 	ID3DX11EffectMatrixVariable* m_pLightWvpVar{};
 	ID3DX11EffectShaderResourceVariable* m_pDiffuseMapVariable{};
 	ID3DX11EffectShaderResourceVariable* m_pShadowMapVariable{};
 	ID3DX11EffectVectorVariable* m_pLightDirVar{};
+	ID3DX11EffectVectorVariable* m_pChunkOriginVar{};
+	ID3DX11EffectVectorVariable* m_pFarFadeVar{};
 
 	ID3DX11Effect* m_pEffect;
 	ID3DX11EffectTechnique* m_pDefaultTechnique;
+	ID3DX11EffectTechnique* m_pCutoutTechnique;
 	ID3DX11EffectTechnique* m_pTransparentTechnique;
+	ID3DX11EffectTechnique* m_pShadowTechnique;
+	ID3DX11EffectTechnique* m_pCutoutShadowTechnique;
+	ID3DX11EffectTechnique* m_pFarTerrainTechnique;
 	ID3D11InputLayout* m_pInputLayout;
+	ID3D11InputLayout* m_pFarTerrainInputLayout{};
+
+	// All chunks are drawn with the same quad indices, the buffer grows when a chunk has more quads than it covers
+	ID3D11Buffer* m_pQuadIndexBuffer{};
+	int m_NrIndexBufferQuads{};
+	// The most quads in one chunk mesh
+	int m_MaxNrChunkQuads{};
+
+	// The vertices of all chunk meshes
+	ChunkBufferPool m_BufferPool{};
+
+	// Every tile of the far terrain has the same grid
+	ID3D11Buffer* m_pFarTerrainIndexBuffer{};
+
+	// Reused every frame, so the boxes don't have to be allocated again
+	FrustumCuller m_CameraCuller{};
+	FrustumCuller m_ShadowCuller{};
+	// Built by every pass after its culler, the order is reused while the camera stays in one chunk
+	ChunkDrawList m_DrawList{};
+	DrawStats m_ShadowStats{};
+
+	bool m_IsCaveCulling{ true };
+	CaveStats m_CaveStats{};
+	// Used as the queue of the walk, reused every frame
+	std::vector<SectionStep> m_SectionSteps{};
 };
 
@@ -8,6 +8,25 @@ float gLightIntensity = 1.0f;
 float gShadowMapBias = 0.00005f;
 float gAlphaEpsilon = 0.1f;
 
+// Packed chunk vertices, see ChunkVertex
+//	the normals and corner offsets are set from the block meshes when the effect is loaded
+float3 gChunkOrigin;
+float4 gFaceNormals[8];
+float4 gCornerOffsets[32];
+float gLoweredTopOffset = 0.125f;
+
+// Chunk faces repeat their tile of the atlas once for every block they cover
+float gTileSize = 1.0f / 16.0f;
+float gTileEpsilon = 0.0016f;
+
+// Far terrain, the chunks cover a square around the center and the far terrain fades out over the outer chunks of that square
+//	x and y are the center, z is where the far terrain is gone and w is where it is fully drawn, in blocks from the center
+float4 gFarFade;
+// The far surface is a bit lower, so the chunks win where both are drawn
+float gFarTerrainDrop = 1.0f;
+// A mip level where a tile of the atlas is about one texel, so the surface gets the average color of its tile
+float gFarTileMip = 4.0f;
+
 Texture2D gDiffuseMap;
 Texture2D gShadowMap;
 
@@ -42,12 +61,36 @@ struct VS_INPUT
 	float2 texCoord : TEXCOORD;
 	bool transparent : TRANSPARENT;
 };
+struct VS_PACKED_INPUT
+{
+	uint2 data : PACKED;
+};
 struct VS_OUTPUT
 {
 	float4 pos : SV_POSITION;
 	float3 normal : NORMAL;
 	float2 texCoord : TEXCOORD;
 	float4 lPos : TEXCOORD1;
+	nointerpolation uint tile : TILE;
+};
+struct VS_FAR_INPUT
+{
+	float3 pos : POSITION;
+	float3 normal : NORMAL;
+	uint tile : TILE;
+};
+struct VS_FAR_OUTPUT
+{
+	float4 pos : SV_POSITION;
+	float3 normal : NORMAL;
+	float3 color : COLOR;
+	float2 worldPos : TEXCOORD;
+};
+struct VS_SHADOW_OUTPUT
+{
+	float4 pos : SV_POSITION;
+	float2 texCoord : TEXCOORD;
+	nointerpolation uint tile : TILE;
 };
 
 DepthStencilState EnableDepth
@@ -95,6 +138,78 @@ VS_OUTPUT VS(VS_INPUT input){
 	output.normal = normalize(mul(input.normal, (float3x3)gWorld));
 	output.texCoord = input.texCoord;
 	output.lPos = mul(float4(input.pos, 1.0f), gLightWorldViewProj);
+	output.tile = 0;
+	return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Packed chunk vertices, the bit layout has to match ChunkVertex
+//--------------------------------------------------------------------------------------
+uint UnpackFace(uint2 data)
+{
+	return (data.x >> 20) & 0x7;
+}
+
+float3 UnpackPosition(uint2 data)
+{
+	// The corner of the block cell relative to the chunk
+	float3 position = float3(data.x & 0x1F, (data.x >> 5) & 0x3FF, (data.x >> 15) & 0x1F);
+
+	// Move the vertex from the cell corner to its place in the block mesh
+	uint corner = (data.x >> 23) & 0x3;
+	position += gCornerOffsets[UnpackFace(data) * 4 + corner].xyz;
+
+	// The surface of water is a bit lower than the top of its block
+	if ((data.x >> 25) & 0x1) position.y -= gLoweredTopOffset;
+
+	return gChunkOrigin + position;
+}
+
+float2 UnpackFaceUV(uint2 data)
+{
+	// The texture coordinate is the position inside the face in blocks
+	return float2((data.y >> 8) & 0xFFF, (data.y >> 20) & 0xFFF);
+}
+
+VS_OUTPUT VS_Packed(VS_PACKED_INPUT input)
+{
+	VS_OUTPUT output;
+	float3 pos = UnpackPosition(input.data);
+
+	output.pos = mul(float4(pos, 1.0f), gWorldViewProj);
+	output.normal = normalize(mul(gFaceNormals[UnpackFace(input.data)].xyz, (float3x3)gWorld));
+	output.texCoord = UnpackFaceUV(input.data);
+	output.lPos = mul(float4(pos, 1.0f), gLightWorldViewProj);
+	output.tile = input.data.y & 0xFF;
+	return output;
+}
+
+float4 VS_PackedShadow(VS_PACKED_INPUT input) : SV_POSITION
+{
+	return mul(float4(UnpackPosition(input.data), 1.0f), gLightWorldViewProj);
+}
+
+VS_SHADOW_OUTPUT VS_PackedCutoutShadow(VS_PACKED_INPUT input)
+{
+	VS_SHADOW_OUTPUT output;
+	output.pos = mul(float4(UnpackPosition(input.data), 1.0f), gLightWorldViewProj);
+	output.texCoord = UnpackFaceUV(input.data);
+	output.tile = input.data.y & 0xFF;
+	return output;
+}
+
+VS_FAR_OUTPUT VS_Far(VS_FAR_INPUT input)
+{
+	VS_FAR_OUTPUT output;
+	float3 pos = input.pos - float3(0.0f, gFarTerrainDrop, 0.0f);
+
+	output.pos = mul(float4(pos, 1.0f), gWorldViewProj);
+	output.normal = normalize(mul(input.normal, (float3x3)gWorld));
+	output.worldPos = pos.xz;
+
+	// The middle of the tile at a small mip is the average color of the tile
+	float2 tileUV = (float2(input.tile % 16, input.tile / 16) + 0.5f) * gTileSize;
+	output.color = gDiffuseMap.SampleLevel(samPoint, tileUV, gFarTileMip).rgb;
 	return output;
 }
 
@@ -139,15 +254,25 @@ float EvaluateShadowMap(float4 lpos)
 	return shadowMapDepth * 0.5f + 0.5f;
 }
 
+float4 SampleTiled(uint tileIdx, float2 faceUV)
+{
+	// There are 16x16 tiles in the atlas
+	float2 tile = float2(tileIdx % 16, tileIdx / 16);
+
+	// Repeat the tile for every block of the face and stay inside the tile
+	float2 uv = (tile + clamp(frac(faceUV), gTileEpsilon, 1.0f - gTileEpsilon)) * gTileSize;
+
+	// The gradients of the unwrapped coordinates keep the mip level stable where the tile repeats
+	return gDiffuseMap.SampleGrad(samPoint, uv, ddx(faceUV * gTileSize), ddy(faceUV * gTileSize));
+}
+
 //--------------------------------------------------------------------------------------
 // Pixel Shader
 //--------------------------------------------------------------------------------------
-float4 PS(VS_OUTPUT input) : SV_TARGET
+float4 Shade(VS_OUTPUT input, float4 diffuseColor)
 {
 	float shadowValue = EvaluateShadowMap(input.lPos);
 
-	float4 diffuseColor = gDiffuseMap.Sample( samPoint,input.texCoord );
-
 	float3 color_rgb= diffuseColor.rgb;
 	float color_a = diffuseColor.a;
 	
@@ -163,6 +288,46 @@ float4 PS(VS_OUTPUT input) : SV_TARGET
 	return float4( color_rgb * shadowValue * gLightIntensity, color_a );
 }
 
+float4 PS(VS_OUTPUT input) : SV_TARGET
+{
+	return Shade(input, gDiffuseMap.Sample( samPoint,input.texCoord ));
+}
+
+float4 PS_Tiled(VS_OUTPUT input) : SV_TARGET
+{
+	return Shade(input, SampleTiled(input.tile, input.texCoord));
+}
+
+float4 PS_Far(VS_FAR_OUTPUT input) : SV_TARGET
+{
+	// Dither the fade, so the far terrain doesn't have to be sorted with the blended chunks
+	float2 offset = abs(input.worldPos - gFarFade.xy);
+	float visibility = saturate((max(offset.x, offset.y) - gFarFade.z) / (gFarFade.w - gFarFade.z));
+
+	const float4x4 ditherThresholds =
+	{
+		0.0f / 16.0f, 8.0f / 16.0f, 2.0f / 16.0f, 10.0f / 16.0f,
+		12.0f / 16.0f, 4.0f / 16.0f, 14.0f / 16.0f, 6.0f / 16.0f,
+		3.0f / 16.0f, 11.0f / 16.0f, 1.0f / 16.0f, 9.0f / 16.0f,
+		15.0f / 16.0f, 7.0f / 16.0f, 13.0f / 16.0f, 5.0f / 16.0f
+	};
+	uint2 pixel = uint2(input.pos.xy) % 4;
+	clip(visibility - ditherThresholds[pixel.y][pixel.x] - 0.001f);
+
+	// The same half lambert as the chunks, the far terrain is outside the shadow map
+	float diffuseStrength = saturate(dot(input.normal, -gLightDirection) * 0.5f + 0.5f) * 0.8f + 0.2f;
+
+	return float4(input.color * diffuseStrength * gLightIntensity, 1.0f);
+}
+
+void PS_Shadow(float4 position : SV_POSITION) {}
+
+void PS_CutoutShadow(VS_SHADOW_OUTPUT input)
+{
+	// The holes of cutout blocks let the light through
+	clip(SampleTiled(input.tile, input.texCoord).a - gAlphaEpsilon);
+}
+
 //--------------------------------------------------------------------------------------
 // Technique
 //--------------------------------------------------------------------------------------
@@ -193,3 +358,85 @@ technique11 Transparent
 		SetPixelShader(CompileShader(ps_4_0, PS()));
 	}
 }
+
+technique11 Tiled
+{
+	pass P0
+	{
+		SetRasterizerState(BackCulling);
+		SetDepthStencilState(EnableDepth, 0);
+		SetBlendState(NoBlending, float4(0.0f, 0.0f, 0.0f, 0.0f), 0xFFFFFFFF);
+
+		SetVertexShader(CompileShader(vs_4_0, VS_Packed()));
+		SetGeometryShader(NULL);
+		SetPixelShader(CompileShader(ps_4_0, PS_Tiled()));
+	}
+}
+
+technique11 TiledCutout
+{
+	pass P0
+	{
+		SetRasterizerState(NoCulling);
+		SetDepthStencilState(EnableDepth, 0);
+		SetBlendState(NoBlending, float4(0.0f, 0.0f, 0.0f, 0.0f), 0xFFFFFFFF);
+
+		SetVertexShader(CompileShader(vs_4_0, VS_Packed()));
+		SetGeometryShader(NULL);
+		SetPixelShader(CompileShader(ps_4_0, PS_Tiled()));
+	}
+}
+
+technique11 TiledTransparent
+{
+	pass P0
+	{
+		SetRasterizerState(NoCulling);
+		SetDepthStencilState(EnableDepth, 0);
+		SetBlendState(Blending, float4(0.0f, 0.0f, 0.0f, 0.0f), 0xFFFFFFFF);
+
+		SetVertexShader(CompileShader(vs_4_0, VS_Packed()));
+		SetGeometryShader(NULL);
+		SetPixelShader(CompileShader(ps_4_0, PS_Tiled()));
+	}
+}
+
+technique11 TiledShadow
+{
+	pass P0
+	{
+		SetRasterizerState(NoCulling);
+		SetDepthStencilState(EnableDepth, 0);
+
+		SetVertexShader(CompileShader(vs_4_0, VS_PackedShadow()));
+		SetGeometryShader(NULL);
+		SetPixelShader(CompileShader(ps_4_0, PS_Shadow()));
+	}
+}
+
+technique11 TiledCutoutShadow
+{
+	pass P0
+	{
+		SetRasterizerState(NoCulling);
+		SetDepthStencilState(EnableDepth, 0);
+
+		SetVertexShader(CompileShader(vs_4_0, VS_PackedCutoutShadow()));
+		SetGeometryShader(NULL);
+		SetPixelShader(CompileShader(ps_4_0, PS_CutoutShadow()));
+	}
+}
+
+technique11 FarTerrain
+{
+	pass P0
+	{
+		SetRasterizerState(BackCulling);
+		SetDepthStencilState(EnableDepth, 0);
+		SetBlendState(NoBlending, float4(0.0f, 0.0f, 0.0f, 0.0f), 0xFFFFFFFF);
+
+		SetVertexShader(CompileShader(vs_4_0, VS_Far()));
+		SetGeometryShader(NULL);
+		SetPixelShader(CompileShader(ps_4_0, PS_Far()));
+	}
+}
\ No newline at end of file
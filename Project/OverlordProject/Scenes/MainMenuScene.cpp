@@ -31,7 +31,8 @@ void MainMenuScene::Initialize()
 	m_SceneContext.settings.showInfoOverlay = false;
 	m_SceneContext.settings.drawGrid = false;
 
-	m_pWorld = new WorldComponent{ m_SceneContext };
+	// The menu has a world of its own, so it doesn't show the world of the player
+	m_pWorld = new WorldComponent{ m_SceneContext, "Saves/MainMenu" };
 #ifndef _DEBUG
 	m_pWorld->SetRenderDistance(5);
 #endif
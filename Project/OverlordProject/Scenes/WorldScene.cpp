@@ -29,6 +29,9 @@ void WorldScene::Initialize()
 	m_SceneContext.settings.showInfoOverlay = false;
 	m_SceneContext.settings.drawGrid = false;
 
+	// Show the world stats in the info overlay [F1]
+	m_SceneContext.settings.enableOnGUI = true;
+
 	// Post Processing Stack
 	m_pUnderwater = MaterialManager::Get()->CreateMaterial<PostUnderWater>();
 	AddPostProcessingEffect(m_pUnderwater);
@@ -106,6 +109,7 @@ void WorldScene::Draw()
 
 void WorldScene::OnGUI()
 {
+	if (m_pWorld) m_pWorld->OnGUI();
 }
 
 void WorldScene::OnSceneActivated()
@@ -153,7 +157,8 @@ void WorldScene::CreateWorld()
 {
 	// Create the world
 	GameObject* pWorld{ AddChild(new GameObject{}) };
-	m_pWorld = pWorld->AddComponent(new WorldComponent{ m_SceneContext });
+	// The same world is loaded every time the game is started
+	m_pWorld = pWorld->AddComponent(new WorldComponent{ m_SceneContext, "Saves/World" });
 	// Load the first 3x3 chunks on the main thread
 	m_pWorld->LoadStartChunk(m_SceneContext);
 }
@@ -0,0 +1,133 @@
+#include "stdafx.h"
+#include "ChunkDrawListTests.h"
+
+#include "TestRunner.h"
+#include "Misc/World/ChunkDrawList.h"
+#include "Misc/World/ChunkPool.h"
+
+void ChunkDrawListTests::Run()
+{
+	std::cout << "Chunk draw list\n";
+
+	TestOrder();
+	TestResort();
+	TestPooledChunk();
+}
+
+void ChunkDrawListTests::TestOrder()
+{
+	ChunkMap chunks{};
+	InsertChunks(chunks, 2);
+
+	ChunkDrawList drawList{};
+	drawList.Build(chunks, XMINT2{ 1, 0 });
+	const std::vector<ChunkDrawList::Entry>& entries{ drawList.GetEntries() };
+
+	TestRunner::Check(static_cast<int>(entries.size()) == chunks.Size(), "order: every chunk has an entry");
+	TestRunner::Check(entries.front().pChunk->position.x == 1 && entries.front().pChunk->position.y == 0, "order: the chunk of the camera is first");
+
+	// The chunk index of an entry is the position of its chunk in the map, the same index as its box in a culler
+	bool isNearestFirst{ true };
+	bool isTieInMapOrder{ true };
+	bool hasMapIndices{ true };
+	std::vector<const Chunk*> pMapChunks{};
+	for (const Chunk& chunk : chunks) pMapChunks.emplace_back(&chunk);
+
+	for (size_t entryIdx{}; entryIdx < entries.size(); ++entryIdx)
+	{
+		const ChunkDrawList::Entry& entry{ entries[entryIdx] };
+		const int offsetX{ entry.pChunk->position.x - 1 };
+		const int offsetY{ entry.pChunk->position.y };
+		hasMapIndices &= pMapChunks[entry.chunkIdx] == entry.pChunk && entry.distance == offsetX * offsetX + offsetY * offsetY;
+
+		if (entryIdx == 0) continue;
+
+		const ChunkDrawList::Entry& prevEntry{ entries[entryIdx - 1] };
+		isNearestFirst &= prevEntry.distance <= entry.distance;
+		if (prevEntry.distance == entry.distance) isTieInMapOrder &= prevEntry.chunkIdx < entry.chunkIdx;
+	}
+	TestRunner::Check(hasMapIndices, "order: every entry has the index and squared distance of its chunk");
+	TestRunner::Check(isNearestFirst, "order: the nearest chunks come first");
+	TestRunner::Check(isTieInMapOrder, "order: chunks at the same distance keep the order of the map");
+
+	// The four chunks next to the camera chunk are all 1 chunk away, they follow the camera chunk in the order they were inserted
+	TestRunner::Check(entries[1].distance == 1 && entries[4].distance == 1 && entries[5].distance == 2, "order: the four chunks next to the camera come second");
+	TestRunner::Check(entries[1].pChunk->position.y == -1 && entries[2].pChunk->position.x == 0
+		&& entries[3].pChunk->position.x == 2 && entries[4].pChunk->position.y == 1, "order: the chunks next to the camera are in map order");
+}
+
+void ChunkDrawListTests::TestResort()
+{
+	ChunkMap chunks{};
+	InsertChunks(chunks, 2);
+
+	ChunkDrawList drawList{};
+	drawList.Build(chunks, XMINT2{ 0, 0 });
+	TestRunner::Check(drawList.GetNrSorts() == 1, "resort: the first build sorts");
+
+	// Moving inside a chunk builds with the same camera chunk every frame
+	for (int frameIdx{}; frameIdx < 10; ++frameIdx) drawList.Build(chunks, XMINT2{ 0, 0 });
+	TestRunner::Check(drawList.GetNrSorts() == 1, "resort: staying in one chunk doesn't sort again");
+
+	drawList.Build(chunks, XMINT2{ 1, 0 });
+	TestRunner::Check(drawList.GetNrSorts() == 2, "resort: entering another chunk sorts again");
+	TestRunner::Check(drawList.GetEntries().front().pChunk->position.x == 1, "resort: the new camera chunk is first");
+
+	// Erasing a chunk and loading another changes the map
+	chunks.Erase(XMINT2{ -2, -2 });
+	drawList.Build(chunks, XMINT2{ 1, 0 });
+	TestRunner::Check(drawList.GetNrSorts() == 3 && static_cast<int>(drawList.GetEntries().size()) == chunks.Size(), "resort: an erased chunk sorts again");
+
+	Chunk newChunk{};
+	newChunk.position = XMINT2{ 3, 0 };
+	chunks.Insert(std::move(newChunk));
+	drawList.Build(chunks, XMINT2{ 1, 0 });
+	TestRunner::Check(drawList.GetNrSorts() == 4 && static_cast<int>(drawList.GetEntries().size()) == chunks.Size(), "resort: an inserted chunk sorts again");
+}
+
+void ChunkDrawListTests::TestPooledChunk()
+{
+	ChunkPool pool{};
+	ChunkMap chunks{};
+	chunks.SetPool(&pool);
+	InsertChunks(chunks, 1);
+
+	ChunkDrawList drawList{};
+	drawList.Build(chunks, XMINT2{ 0, 0 });
+
+	// Erase the last chunk of the map, the pool gives that same chunk back and the map puts it in the same place
+	const Chunk* pLastChunk{};
+	for (const Chunk& chunk : chunks) pLastChunk = &chunk;
+	chunks.Erase(pLastChunk->position);
+
+	std::unique_ptr<Chunk> pChunk{ pool.Acquire() };
+	const bool isSameChunk{ pChunk.get() == pLastChunk };
+	TestRunner::Check(isSameChunk, "pooled chunk: the pool gives back the chunk that was erased");
+
+	pChunk->position = XMINT2{ 0, 5 };
+	chunks.Insert(std::move(pChunk));
+
+	const Chunk* pNewLastChunk{};
+	for (const Chunk& chunk : chunks) pNewLastChunk = &chunk;
+	TestRunner::Check(pNewLastChunk == pLastChunk, "pooled chunk: the chunk is in the same place of the map");
+
+	// The same chunks at the same places of the map, only the position of one changed
+	drawList.Build(chunks, XMINT2{ 0, 0 });
+	TestRunner::Check(drawList.GetNrSorts() == 2, "pooled chunk: a chunk at another position sorts again");
+
+	const ChunkDrawList::Entry& farthestEntry{ drawList.GetEntries().back() };
+	TestRunner::Check(farthestEntry.pChunk == pLastChunk && farthestEntry.distance == 25, "pooled chunk: the chunk is sorted at its new position");
+}
+
+void ChunkDrawListTests::InsertChunks(ChunkMap& chunks, int radius)
+{
+	for (int y{ -radius }; y <= radius; ++y)
+	{
+		for (int x{ -radius }; x <= radius; ++x)
+		{
+			Chunk chunk{};
+			chunk.position = XMINT2{ x, y };
+			chunks.Insert(std::move(chunk));
+		}
+	}
+}
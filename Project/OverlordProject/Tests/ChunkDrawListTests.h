@@ -0,0 +1,18 @@
+#pragma once
+
+class ChunkMap;
+
+// Checks the order of the draw list and when it sorts again
+class ChunkDrawListTests final
+{
+public:
+	static void Run();
+
+private:
+	static void TestOrder();
+	static void TestResort();
+	static void TestPooledChunk();
+
+	// Inserts the chunks in a square of chunks around the origin, row by row
+	static void InsertChunks(ChunkMap& chunks, int radius);
+};
@@ -0,0 +1,236 @@
+#include "stdafx.h"
+#include "FaceMaskBenchmark.h"
+
+#include "TestRunner.h"
+#include "Managers/BlockManager.h"
+#include "Misc/World/Chunk.h"
+#include "Misc/World/FaceMasks.h"
+#include "Misc/World/WorldGenerator.h"
+
+#include <chrono>
+
+void FaceMaskBenchmark::Run()
+{
+	std::cout << "Face masks\n";
+
+	const BlockTypes blockTypes{ GetBlockTypes() };
+	if (!TestRunner::Check(!blockTypes.opaqueCubes.empty(), "the blocks are loaded")) return;
+
+	// The same seed every run, so the timings of different builds can be compared
+	std::mt19937 random{ 1234 };
+	std::vector<TestChunk> testChunks(NrChunks);
+	for (int chunkIdx{}; chunkIdx < NrChunks; ++chunkIdx)
+	{
+		TestChunk& testChunk{ testChunks[chunkIdx] };
+		testChunk.pChunk = std::make_unique<Chunk>();
+		FillChunk(*testChunk.pChunk, blockTypes, random);
+
+		// Every fourth chunk misses a neighbour, its faces on that side are always visible
+		for (int dirIdx{}; dirIdx < static_cast<int>(testChunk.pNeighbours.size()); ++dirIdx)
+		{
+			if (chunkIdx % 4 == 3 && dirIdx == chunkIdx / 4 % 4) continue;
+
+			testChunk.pNeighbours[dirIdx] = std::make_unique<Chunk>();
+			FillChunk(*testChunk.pNeighbours[dirIdx], blockTypes, random);
+			testChunk.pNeighbourViews[dirIdx] = testChunk.pNeighbours[dirIdx].get();
+		}
+	}
+
+	const BlockManager* pBlockManager{ BlockManager::Get() };
+	FaceMasks faceMasks{};
+
+	// Both layers of every chunk have to give the same faces for every cube
+	int nrCheckedFaces{};
+	int nrDifferentBlocks{};
+	for (const TestChunk& testChunk : testChunks)
+	{
+		const Chunk& chunk{ *testChunk.pChunk };
+		for (int layerIdx{}; layerIdx < 2; ++layerIdx)
+		{
+			const bool isFluidLayer{ layerIdx == 1 };
+			faceMasks.Build(chunk, testChunk.pNeighbourViews, isFluidLayer, ~0U);
+
+			for (int y{}; y < WorldHeight; ++y)
+			{
+				for (int z{}; z < ChunkSection::Size; ++z)
+				{
+					for (int x{}; x < ChunkSection::Size; ++x)
+					{
+						// Water in the block layer is checked again by the mesher, the masks only hide its faces behind opaque cubes
+						const BlockType block{ isFluidLayer ? chunk.GetFluid(x, y, z) : chunk.GetBlock(x, y, z) };
+						if (!pBlockManager->IsCube(block) || (!isFluidLayer && block == BlockType::WATER)) continue;
+
+						if (faceMasks.GetVisibleFaces(x, y, z) != GetPredicateFaces(testChunk, x, y, z, block)) ++nrDifferentBlocks;
+						nrCheckedFaces += 6;
+					}
+				}
+			}
+		}
+	}
+	std::cout << "    " << nrCheckedFaces << " faces compared, " << nrDifferentBlocks << " cubes with different faces\n";
+	TestRunner::Check(nrDifferentBlocks == 0, "the face masks give the same faces as the predicate");
+
+	// Time finding the faces of every block in the block layer, the way the mesher visits them
+	//	both ways have to find the same number of faces, which also keeps the compiler from skipping the work
+	using Clock = std::chrono::high_resolution_clock;
+	int nrPredicateFaces{};
+	int nrMaskFaces{};
+
+	const auto predicateStart{ Clock::now() };
+	for (int repeatIdx{}; repeatIdx < NrRepeats; ++repeatIdx)
+	{
+		for (const TestChunk& testChunk : testChunks)
+		{
+			const Chunk& chunk{ *testChunk.pChunk };
+			for (int y{}; y < WorldHeight; ++y)
+			{
+				if (!chunk.HasBlocksInSection(y / ChunkSection::Size)) continue;
+
+				for (int z{}; z < ChunkSection::Size; ++z)
+				{
+					for (int x{}; x < ChunkSection::Size; ++x)
+					{
+						const Block* pBlock{ pBlockManager->GetBlock(chunk.GetBlock(x, y, z)) };
+						if (!pBlock || pBlock->mesh != BlockMesh::CUBE) continue;
+
+						const uint8_t faces{ GetPredicateFaces(testChunk, x, y, z, pBlock->type) };
+						for (int faceIdx{}; faceIdx < 6; ++faceIdx) nrPredicateFaces += (faces >> faceIdx) & 1;
+					}
+				}
+			}
+		}
+	}
+	const std::chrono::duration<double, std::milli> predicateTime{ Clock::now() - predicateStart };
+
+	const auto maskStart{ Clock::now() };
+	for (int repeatIdx{}; repeatIdx < NrRepeats; ++repeatIdx)
+	{
+		for (const TestChunk& testChunk : testChunks)
+		{
+			const Chunk& chunk{ *testChunk.pChunk };
+			faceMasks.Build(chunk, testChunk.pNeighbourViews, false, ~0U);
+
+			for (int y{}; y < WorldHeight; ++y)
+			{
+				if (!chunk.HasBlocksInSection(y / ChunkSection::Size)) continue;
+
+				for (int z{}; z < ChunkSection::Size; ++z)
+				{
+					for (int x{}; x < ChunkSection::Size; ++x)
+					{
+						if (!faceMasks.IsCube(x, y, z)) continue;
+
+						const uint8_t faces{ faceMasks.GetVisibleFaces(x, y, z) };
+						for (int faceIdx{}; faceIdx < 6; ++faceIdx) nrMaskFaces += (faces >> faceIdx) & 1;
+					}
+				}
+			}
+		}
+	}
+	const std::chrono::duration<double, std::milli> maskTime{ Clock::now() - maskStart };
+
+	TestRunner::Check(nrPredicateFaces == nrMaskFaces, "both ways find the same number of faces");
+
+	const int nrMeasuredChunks{ NrChunks * NrRepeats };
+	const double speedup{ predicateTime.count() / maskTime.count() };
+	std::cout << "    predicate: " << predicateTime.count() / nrMeasuredChunks << " ms per chunk\n";
+	std::cout << "    face masks: " << maskTime.count() / nrMeasuredChunks << " ms per chunk\n";
+	std::cout << "    " << speedup << "x faster\n";
+	TestRunner::Check(speedup > 1.0, "the face masks are faster than the predicate");
+}
+
+FaceMaskBenchmark::BlockTypes FaceMaskBenchmark::GetBlockTypes()
+{
+	const BlockManager* pBlockManager{ BlockManager::Get() };
+
+	BlockTypes blockTypes{};
+	for (int typeIdx{ 1 }; typeIdx < BlockManager::NrBlockTypes; ++typeIdx)
+	{
+		const BlockType type{ static_cast<BlockType>(typeIdx) };
+		if (type == BlockType::WATER || !pBlockManager->GetBlock(type)) continue;
+
+		if (pBlockManager->IsOpaqueCube(type)) blockTypes.opaqueCubes.emplace_back(type);
+		else if (pBlockManager->IsCube(type)) blockTypes.transparentCubes.emplace_back(type);
+		else blockTypes.crosses.emplace_back(type);
+	}
+
+	return blockTypes;
+}
+
+void FaceMaskBenchmark::FillChunk(Chunk& chunk, const BlockTypes& blockTypes, std::mt19937& random)
+{
+	chunk.sections.resize(WorldHeight / ChunkSection::Size);
+
+	const auto pickBlock{ [&](const std::vector<BlockType>& types)
+		{
+			return types.empty() ? BlockType::AIR : types[random() % types.size()];
+		} };
+
+	for (int z{}; z < ChunkSection::Size; ++z)
+	{
+		for (int x{}; x < ChunkSection::Size; ++x)
+		{
+			const int height{ SeaLevel - 16 + static_cast<int>(random() % 32) };
+			for (int y{}; y < height; ++y)
+			{
+				// Mostly opaque blocks with some caves and see-through blocks in between
+				const unsigned int roll{ static_cast<unsigned int>(random() % 100) };
+				if (roll < 5) continue;
+				chunk.SetBlock(x, y, z, pickBlock(roll < 10 ? blockTypes.transparentCubes : blockTypes.opaqueCubes));
+			}
+
+			// Plants on the surface and water up to sea level
+			if (random() % 4 == 0) chunk.SetBlock(x, height, z, pickBlock(blockTypes.crosses));
+			for (int y{ height }; y < SeaLevel; ++y)
+			{
+				if (chunk.GetBlock(x, y, z) == BlockType::AIR) chunk.SetFluid(x, y, z, BlockType::WATER);
+			}
+		}
+	}
+
+	// Like generated chunks, sections with one block type become uniform
+	chunk.Compact();
+}
+
+uint8_t FaceMaskBenchmark::GetPredicateFaces(const TestChunk& testChunk, int x, int y, int z, BlockType block)
+{
+	// The neighbouring blocks in the order of FaceDirection
+	constexpr int directions[6][3]{ { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 } };
+
+	uint8_t faces{};
+	for (int faceIdx{}; faceIdx < 6; ++faceIdx)
+	{
+		BlockType neighbourBlock{};
+		BlockType neighbourFluid{};
+		GetNeighbour(testChunk, x + directions[faceIdx][0], y + directions[faceIdx][1], z + directions[faceIdx][2], neighbourBlock, neighbourFluid);
+
+		// Water faces are hidden by blocks and by other water, the same as WorldGenerator::IsFaceVisible
+		bool canRender{ WorldGenerator::CanRenderFace(neighbourBlock, block) };
+		if (canRender && block == BlockType::WATER) canRender = WorldGenerator::CanRenderFace(neighbourFluid, block);
+
+		if (canRender) faces |= static_cast<uint8_t>(1U << faceIdx);
+	}
+
+	return faces;
+}
+
+void FaceMaskBenchmark::GetNeighbour(const TestChunk& testChunk, int x, int y, int z, BlockType& block, BlockType& fluid)
+{
+	block = BlockType::AIR;
+	fluid = BlockType::AIR;
+
+	// Outside the world height and next to a missing chunk there are no blocks
+	if (y < 0 || y >= WorldHeight) return;
+
+	const Chunk* pChunk{ testChunk.pChunk.get() };
+	if (z >= ChunkSection::Size) pChunk = testChunk.pNeighbourViews[static_cast<int>(FaceDirection::FORWARD)];
+	else if (z < 0) pChunk = testChunk.pNeighbourViews[static_cast<int>(FaceDirection::BACK)];
+	else if (x >= ChunkSection::Size) pChunk = testChunk.pNeighbourViews[static_cast<int>(FaceDirection::RIGHT)];
+	else if (x < 0) pChunk = testChunk.pNeighbourViews[static_cast<int>(FaceDirection::LEFT)];
+	if (!pChunk) return;
+
+	const int localX{ (x + ChunkSection::Size) % ChunkSection::Size };
+	const int localZ{ (z + ChunkSection::Size) % ChunkSection::Size };
+	block = pChunk->GetBlock(localX, y, localZ);
+	fluid = pChunk->GetFluid(localX, y, localZ);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Misc/World/WorldData.h"
+
+#include <array>
+#include <memory>
+#include <random>
+#include <vector>
+
+struct Chunk;
+
+// Compares the visible faces of the face masks with the per-face predicate of the world generator on random chunks
+//	and times both ways of finding the visible faces of every cube in a chunk
+class FaceMaskBenchmark final
+{
+public:
+	static void Run();
+
+private:
+	static constexpr int NrChunks{ 16 };
+	static constexpr int NrRepeats{ 8 };
+	static constexpr int WorldHeight{ 256 };
+	static constexpr int SeaLevel{ 64 };
+
+	// The block types of the game, split by how they hide faces
+	struct BlockTypes
+	{
+		std::vector<BlockType> opaqueCubes{};
+		std::vector<BlockType> transparentCubes{};
+		std::vector<BlockType> crosses{};
+	};
+
+	// A chunk with its neighbours in the order of FaceDirection, some chunks miss a neighbour
+	struct TestChunk
+	{
+		std::unique_ptr<Chunk> pChunk{};
+		std::array<std::unique_ptr<Chunk>, 4> pNeighbours{};
+		std::array<const Chunk*, 4> pNeighbourViews{};
+	};
+
+	static BlockTypes GetBlockTypes();
+	// Terrain with caves, transparent blocks, plants and water under sea level
+	static void FillChunk(Chunk& chunk, const BlockTypes& blockTypes, std::mt19937& random);
+
+	// The faces the way the mesher found them before the face masks, one predicate call per face
+	static uint8_t GetPredicateFaces(const TestChunk& testChunk, int x, int y, int z, BlockType block);
+	static void GetNeighbour(const TestChunk& testChunk, int x, int y, int z, BlockType& block, BlockType& fluid);
+};
@@ -0,0 +1,140 @@
+#include "stdafx.h"
+#include "FrustumCullerTests.h"
+
+#include "TestRunner.h"
+#include "Utils/FrustumCuller.h"
+
+void FrustumCullerTests::Run()
+{
+	std::cout << "Frustum culler\n";
+
+	TestFrustumPlanes();
+	TestCull();
+	TestSweptFrustum();
+}
+
+void FrustumCullerTests::TestFrustumPlanes()
+{
+	// With a field of view of 90 degrees the side planes are at 45 degrees, the near and far plane are at the depth range
+	XMFLOAT4 planes[FrustumCuller::NrFrustumPlanes]{};
+	FrustumCuller::GetFrustumPlanes(CreateCameraViewProjection(), planes);
+
+	const float halfSqrt2{ sqrtf(0.5f) };
+	TestRunner::Check(IsSamePlane(planes[0], XMFLOAT4{ halfSqrt2, 0.0f, halfSqrt2, 0.0f }), "planes: the left plane points right and forward");
+	TestRunner::Check(IsSamePlane(planes[1], XMFLOAT4{ -halfSqrt2, 0.0f, halfSqrt2, 0.0f }), "planes: the right plane points left and forward");
+	TestRunner::Check(IsSamePlane(planes[2], XMFLOAT4{ 0.0f, halfSqrt2, halfSqrt2, 0.0f }), "planes: the bottom plane points up and forward");
+	TestRunner::Check(IsSamePlane(planes[3], XMFLOAT4{ 0.0f, -halfSqrt2, halfSqrt2, 0.0f }), "planes: the top plane points down and forward");
+	TestRunner::Check(IsSamePlane(planes[4], XMFLOAT4{ 0.0f, 0.0f, 1.0f, -1.0f }), "planes: the near plane is 1 unit in front of the camera");
+	TestRunner::Check(IsSamePlane(planes[5], XMFLOAT4{ 0.0f, 0.0f, -1.0f, 100.0f }), "planes: the far plane is 100 units in front of the camera");
+
+	// Begin starts with only the planes of the view projection
+	FrustumCuller culler{};
+	culler.Begin(CreateCameraViewProjection());
+	TestRunner::Check(culler.GetNrPlanes() == FrustumCuller::NrFrustumPlanes && IsSamePlane(culler.GetPlanes()[5], planes[5]), "planes: begin takes the planes of the view projection");
+}
+
+void FrustumCullerTests::TestCull()
+{
+	// Nine boxes, so the last group of four only has one box and three empty ones
+	const std::pair<BoundingBox, bool> boxes[]
+	{
+		{ BoundingBox{ XMFLOAT3{ 0.0f, 0.0f, 10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } }, true },
+		{ BoundingBox{ XMFLOAT3{ 0.0f, 0.0f, -10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } }, false },
+		{ BoundingBox{ XMFLOAT3{ 30.0f, 0.0f, 10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } }, false },
+		{ BoundingBox{ XMFLOAT3{ 10.5f, 0.0f, 10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } }, true },
+		{ BoundingBox{ XMFLOAT3{ 0.0f, 0.0f, 200.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } }, false },
+		{ BoundingBox{ XMFLOAT3{ 0.0f, 0.0f, 99.5f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } }, true },
+		{ BoundingBox{ XMFLOAT3{ 0.0f, -30.0f, 10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } }, false },
+		{ BoundingBox{ XMFLOAT3{ 4.5f, 4.5f, 3.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } }, true },
+		{ BoundingBox{ XMFLOAT3{ 0.0f, 0.0f, 50.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } }, true }
+	};
+
+	FrustumCuller culler{};
+	culler.Begin(CreateCameraViewProjection());
+	for (int boxIdx{}; boxIdx < static_cast<int>(std::size(boxes)); ++boxIdx)
+	{
+		TestRunner::Check(culler.AddBox(boxes[boxIdx].first) == boxIdx, "cull: the boxes are numbered in the order they are added");
+	}
+	culler.Cull();
+
+	TestRunner::Check(culler.GetNrBoxes() == static_cast<int>(std::size(boxes)), "cull: the empty boxes of the last group aren't counted");
+
+	bool isEveryBoxCorrect{ true };
+	bool isSameAsOneBox{ true };
+	for (int boxIdx{}; boxIdx < static_cast<int>(std::size(boxes)); ++boxIdx)
+	{
+		isEveryBoxCorrect &= culler.IsVisible(boxIdx) == boxes[boxIdx].second;
+		isSameAsOneBox &= culler.IsVisible(boxIdx) == culler.IsBoxVisible(boxes[boxIdx].first);
+	}
+	TestRunner::Check(isEveryBoxCorrect, "cull: every box of the groups of four is culled on its own");
+	TestRunner::Check(culler.IsVisible(8), "cull: the only box of the last group is visible");
+	TestRunner::Check(isSameAsOneBox, "cull: the groups of four give the same results as testing one box");
+
+	// The next test starts without the boxes of this test, the results of fewer boxes don't come from the old boxes
+	const BoundingBox behindBox{ XMFLOAT3{ 0.0f, 0.0f, -10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } };
+	const BoundingBox frontBox{ XMFLOAT3{ 0.0f, 0.0f, 10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } };
+	culler.Begin(CreateCameraViewProjection());
+	culler.AddBox(behindBox);
+	for (int boxIdx{ 1 }; boxIdx < 5; ++boxIdx) culler.AddBox(frontBox);
+	culler.Cull();
+
+	TestRunner::Check(culler.GetNrBoxes() == 5, "cull: begin removes the boxes of the previous test");
+	TestRunner::Check(!culler.IsVisible(0) && culler.IsVisible(1) && culler.IsVisible(4), "cull: a second test doesn't keep the old results");
+}
+
+void FrustumCullerTests::TestSweptFrustum()
+{
+	// A light that shines straight down on 200 by 200 units, from 50 units up to 50 units down
+	constexpr XMFLOAT4X4 lightViewProjection
+	{
+		0.01f, 0.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, -0.01f, 0.0f,
+		0.0f, 0.01f, 0.0f, 0.0f,
+		0.0f, 0.0f, 0.5f, 1.0f
+	};
+	const XMFLOAT3 lightDirection{ 0.0f, -1.0f, 0.0f };
+
+	XMFLOAT4 cameraPlanes[FrustumCuller::NrFrustumPlanes]{};
+	FrustumCuller::GetFrustumPlanes(CreateCameraViewProjection(), cameraPlanes);
+
+	FrustumCuller culler{};
+	culler.Begin(lightViewProjection);
+	culler.AddSweptFrustum(CreateCameraViewProjection(), lightDirection);
+
+	// The light goes down into the top plane, every other plane of the camera is kept in its order
+	TestRunner::Check(culler.GetNrPlanes() == FrustumCuller::NrFrustumPlanes + 5, "swept frustum: only the top plane is left out");
+	const XMFLOAT4* pPlanes{ culler.GetPlanes() + FrustumCuller::NrFrustumPlanes };
+	TestRunner::Check(IsSamePlane(pPlanes[0], cameraPlanes[0]) && IsSamePlane(pPlanes[1], cameraPlanes[1]) && IsSamePlane(pPlanes[2], cameraPlanes[2])
+		&& IsSamePlane(pPlanes[3], cameraPlanes[4]) && IsSamePlane(pPlanes[4], cameraPlanes[5]), "swept frustum: the planes the light moves away from are added");
+
+	// A box above the view casts its shadow into it, a box below or next to the view can't
+	const BoundingBox aboveBox{ XMFLOAT3{ 0.0f, 30.0f, 10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } };
+	const BoundingBox belowBox{ XMFLOAT3{ 0.0f, -30.0f, 10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } };
+	const BoundingBox sideBox{ XMFLOAT3{ 30.0f, 0.0f, 10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } };
+	const BoundingBox frontBox{ XMFLOAT3{ 0.0f, 0.0f, 10.0f }, XMFLOAT3{ 1.0f, 1.0f, 1.0f } };
+	TestRunner::Check(culler.IsBoxVisible(aboveBox), "swept frustum: a box above the view casts a shadow into it");
+	TestRunner::Check(!culler.IsBoxVisible(belowBox), "swept frustum: a box below the view is culled");
+	TestRunner::Check(!culler.IsBoxVisible(sideBox), "swept frustum: a box next to the view is culled");
+	TestRunner::Check(culler.IsBoxVisible(frontBox), "swept frustum: a box in the view is visible");
+
+	// More swept frustums than fit leave out planes instead of writing past the planes
+	culler.AddSweptFrustum(CreateCameraViewProjection(), lightDirection);
+	culler.AddSweptFrustum(CreateCameraViewProjection(), lightDirection);
+	TestRunner::Check(culler.GetNrPlanes() == FrustumCuller::MaxNrPlanes, "swept frustum: the planes stop at the maximum");
+	TestRunner::Check(culler.IsBoxVisible(frontBox) && culler.IsBoxVisible(aboveBox), "swept frustum: the left out planes don't cull more boxes");
+}
+
+XMFLOAT4X4 FrustumCullerTests::CreateCameraViewProjection()
+{
+	XMFLOAT4X4 viewProjection{};
+	XMStoreFloat4x4(&viewProjection, XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 1.0f, 100.0f));
+	return viewProjection;
+}
+
+bool FrustumCullerTests::IsSamePlane(const XMFLOAT4& plane, const XMFLOAT4& expectedPlane)
+{
+	// The distance of the far plane is the difference of two big numbers, so it is only close to its exact value
+	constexpr float epsilon{ 0.001f };
+	return fabsf(plane.x - expectedPlane.x) < epsilon && fabsf(plane.y - expectedPlane.y) < epsilon
+		&& fabsf(plane.z - expectedPlane.z) < epsilon && fabsf(plane.w - expectedPlane.w) < epsilon;
+}
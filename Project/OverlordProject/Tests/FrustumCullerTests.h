@@ -0,0 +1,17 @@
+#pragma once
+
+// Checks the planes that the culler takes from a view projection, the culling of the boxes four at a time and the planes of a swept frustum
+class FrustumCullerTests final
+{
+public:
+	static void Run();
+
+private:
+	static void TestFrustumPlanes();
+	static void TestCull();
+	static void TestSweptFrustum();
+
+	// A camera at the origin that looks along +z with a field of view of 90 degrees, from 1 to 100 units
+	static XMFLOAT4X4 CreateCameraViewProjection();
+	static bool IsSamePlane(const XMFLOAT4& plane, const XMFLOAT4& expectedPlane);
+};
@@ -0,0 +1,77 @@
+#include "stdafx.h"
+#include "QuadMeshTests.h"
+
+#include "TestRunner.h"
+#include "Misc/World/QuadMesh.h"
+
+void QuadMeshTests::Run()
+{
+	std::cout << "Quad mesh\n";
+
+	TestAddQuad();
+	TestIndices();
+	TestIndexBufferGrowth();
+}
+
+void QuadMeshTests::TestAddQuad()
+{
+	// The corners are appended after the vertices that are already in the list, in their own order
+	std::vector<int> vertices{ 7 };
+	QuadMesh::AddQuad(vertices, { 0, 1, 2, 3 });
+	QuadMesh::AddQuad(vertices, { 4, 5, 6, 7 });
+	TestRunner::Check(vertices == std::vector<int>{ 7, 0, 1, 2, 3, 4, 5, 6, 7 }, "quads: the corners are appended in order");
+
+	// A list that isn't made of whole quads only counts its whole quads
+	TestRunner::Check(QuadMesh::GetNrQuads(0) == 0 && QuadMesh::GetNrIndices(0) == 0, "quads: an empty mesh has no quads");
+	TestRunner::Check(QuadMesh::GetNrQuads(8) == 2 && QuadMesh::GetNrIndices(8) == 12, "quads: 8 vertices are 2 quads with 12 indices");
+	TestRunner::Check(QuadMesh::GetNrQuads(11) == 2, "quads: a partial quad isn't counted");
+}
+
+void QuadMeshTests::TestIndices()
+{
+	constexpr int nrQuads{ 3 };
+
+	std::vector<uint32_t> indices{};
+	QuadMesh::CreateIndices(nrQuads, indices);
+	const std::vector<uint32_t> expectedIndices{ 0, 1, 2, 3, 2, 1, 4, 5, 6, 7, 6, 5, 8, 9, 10, 11, 10, 9 };
+	TestRunner::Check(indices == expectedIndices, "indices: every quad is 0,1,2,3,2,1 offset to its own corners");
+
+	// Both triangles of a quad have to face the same way, so they go over their shared edge in opposite directions
+	const uint32_t* pQuad{ indices.data() };
+	const bool isSharedEdgeReversed{ pQuad[1] == pQuad[5] && pQuad[2] == pQuad[4] };
+	TestRunner::Check(isSharedEdgeReversed, "indices: the triangles of a quad have the same winding");
+
+	// More quads are appended after the indices that are already in the list
+	QuadMesh::CreateIndices(1, indices);
+	TestRunner::Check(indices.size() == (nrQuads + 1) * QuadMesh::NrIndicesPerQuad && indices.back() == 1, "indices: the indices are appended");
+
+	// The index buffer of a big mesh only points at its own vertices
+	std::vector<uint32_t> bigIndices{};
+	constexpr int nrBigQuads{ 10000 };
+	QuadMesh::CreateIndices(nrBigQuads, bigIndices);
+	const uint32_t maxIndex{ *std::max_element(bigIndices.begin(), bigIndices.end()) };
+	TestRunner::Check(static_cast<int>(bigIndices.size()) == nrBigQuads * QuadMesh::NrIndicesPerQuad
+		&& maxIndex == nrBigQuads * QuadMesh::NrVerticesPerQuad - 1, "indices: the indices of a big mesh stay inside its vertices");
+}
+
+void QuadMeshTests::TestIndexBufferGrowth()
+{
+	// The renderer starts without an index buffer and grows it for the biggest mesh that has been uploaded
+	TestRunner::Check(QuadMesh::GetNrIndexBufferQuads(0, 0) == 0, "index buffer: no buffer without meshes");
+	TestRunner::Check(QuadMesh::GetNrIndexBufferQuads(100, 0) == 100, "index buffer: the first buffer fits the biggest mesh");
+	TestRunner::Check(QuadMesh::GetNrIndexBufferQuads(100, 100) == 100, "index buffer: a mesh that fits doesn't grow the buffer");
+	TestRunner::Check(QuadMesh::GetNrIndexBufferQuads(50, 200) == 200, "index buffer: the buffer doesn't shrink");
+	TestRunner::Check(QuadMesh::GetNrIndexBufferQuads(120, 100) == 200, "index buffer: a bit bigger mesh doubles the buffer");
+	TestRunner::Check(QuadMesh::GetNrIndexBufferQuads(500, 200) == 500, "index buffer: a much bigger mesh gets a buffer of its size");
+
+	// Growing for a mesh that gets a bit bigger every time only recreates the buffer a few times
+	int nrBufferQuads{};
+	int nrRecreations{};
+	for (int nrQuads{ 1000 }; nrQuads <= 16000; nrQuads += 10)
+	{
+		const int nrNewBufferQuads{ QuadMesh::GetNrIndexBufferQuads(nrQuads, nrBufferQuads) };
+		if (nrNewBufferQuads != nrBufferQuads) ++nrRecreations;
+		nrBufferQuads = nrNewBufferQuads;
+	}
+	TestRunner::Check(nrRecreations == 5, "index buffer: a growing mesh recreates the buffer once per doubling");
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Checks the corners of the quad builder, the index pattern of the shared index buffer and how that buffer grows
+class QuadMeshTests final
+{
+public:
+	static void Run();
+
+private:
+	static void TestAddQuad();
+	static void TestIndices();
+	static void TestIndexBufferGrowth();
+};
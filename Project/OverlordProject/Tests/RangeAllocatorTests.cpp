@@ -0,0 +1,173 @@
+#include "stdafx.h"
+#include "RangeAllocatorTests.h"
+
+#include "TestRunner.h"
+#include "Utils/RangeAllocator.h"
+
+#include <random>
+
+void RangeAllocatorTests::Run()
+{
+	std::cout << "Range allocator\n";
+
+	TestBestFit();
+	TestMerge();
+	TestExhaustion();
+	TestFragmentation();
+	TestStress();
+}
+
+void RangeAllocatorTests::TestBestFit()
+{
+	// [0, 100) [100, 400) [400, 450) [450, 550) [550, 600) [600, 1000)
+	RangeAllocator allocator{ 1000 };
+	allocator.Allocate(100);
+	const int bigHole{ allocator.Allocate(300) };
+	allocator.Allocate(50);
+	const int smallHole{ allocator.Allocate(100) };
+	allocator.Allocate(50);
+	const int biggestHole{ allocator.Allocate(400) };
+	TestRunner::Check(allocator.GetNrFree() == 0, "best fit: the allocations fill the whole range");
+
+	// The smallest hole lies between two bigger ones, so neither the first nor the last fit finds it
+	allocator.Free(bigHole, 300);
+	allocator.Free(smallHole, 100);
+	allocator.Free(biggestHole, 400);
+
+	TestRunner::Check(allocator.Allocate(80) == smallHole, "best fit: a small allocation takes the smallest hole that fits");
+	TestRunner::Check(allocator.Allocate(250) == bigHole, "best fit: an allocation too big for the small hole takes the next smallest hole");
+	TestRunner::Check(allocator.Allocate(20) == smallHole + 80, "best fit: the rest of the small hole is the best fit");
+	TestRunner::Check(allocator.Allocate(50) == bigHole + 250, "best fit: an exact fit takes the rest of the big hole");
+	TestRunner::Check(allocator.Allocate(400) == biggestHole, "best fit: the biggest hole is still whole");
+	TestRunner::Check(allocator.Allocate(1) == RangeAllocator::InvalidOffset, "best fit: every hole is filled");
+	TestRunner::Check(allocator.GetNrFree() == 0 && allocator.GetNrAllocations() == 8, "best fit: the counts add up");
+}
+
+void RangeAllocatorTests::TestMerge()
+{
+	RangeAllocator allocator{ 400 };
+	const int first{ allocator.Allocate(100) };
+	const int second{ allocator.Allocate(100) };
+	const int third{ allocator.Allocate(100) };
+	allocator.Allocate(100);
+
+	// The second range merges with the free third range after it
+	allocator.Free(third, 100);
+	allocator.Free(second, 100);
+	RangeAllocator::Stats stats{ allocator.GetStats() };
+	TestRunner::Check(stats.nrFreeRanges == 1 && stats.largestFreeRange == 200, "merge: a freed range merges with the next free range");
+
+	// The third range merges with the free second range before it
+	allocator.Allocate(200);
+	allocator.Free(second, 100);
+	allocator.Free(third, 100);
+	stats = allocator.GetStats();
+	TestRunner::Check(stats.nrFreeRanges == 1 && stats.largestFreeRange == 200, "merge: a freed range merges with the previous free range");
+
+	// The second range merges with the free ranges on both sides at once
+	allocator.Allocate(200);
+	allocator.Free(first, 100);
+	allocator.Free(third, 100);
+	allocator.Free(second, 100);
+	stats = allocator.GetStats();
+	TestRunner::Check(stats.nrFreeRanges == 1 && stats.largestFreeRange == 300, "merge: a freed range merges with the free ranges on both sides");
+	TestRunner::Check(allocator.Allocate(300) == first, "merge: the merged range can be allocated at once");
+}
+
+void RangeAllocatorTests::TestExhaustion()
+{
+	RangeAllocator allocator{ 256 };
+	TestRunner::Check(allocator.Allocate(257) == RangeAllocator::InvalidOffset, "exhaustion: an allocation bigger than the capacity fails");
+
+	const int offset{ allocator.Allocate(256) };
+	TestRunner::Check(offset == 0, "exhaustion: the whole range can be allocated");
+	TestRunner::Check(allocator.Allocate(1) == RangeAllocator::InvalidOffset, "exhaustion: a full allocator fails");
+	TestRunner::Check(allocator.Allocate(0) == RangeAllocator::InvalidOffset, "exhaustion: an empty allocation fails");
+
+	const RangeAllocator::Stats stats{ allocator.GetStats() };
+	TestRunner::Check(stats.nrUsed == 256 && stats.nrAllocations == 1 && stats.nrFreeRanges == 0, "exhaustion: failed allocations don't change the counts");
+
+	// Freeing makes the space available again
+	allocator.Free(offset, 256);
+	TestRunner::Check(allocator.IsEmpty() && allocator.Allocate(256) == 0, "exhaustion: freed space can be allocated again");
+}
+
+void RangeAllocatorTests::TestFragmentation()
+{
+	RangeAllocator allocator{ 400 };
+	TestRunner::Check(allocator.GetStats().fragmentation == 0.0f, "fragmentation: an empty allocator isn't fragmented");
+
+	int offsets[4]{};
+	for (int& offset : offsets) offset = allocator.Allocate(100);
+	TestRunner::Check(allocator.GetStats().fragmentation == 0.0f, "fragmentation: a full allocator isn't fragmented");
+
+	// Two free ranges of 100, the largest holds half of the free space
+	allocator.Free(offsets[0], 100);
+	allocator.Free(offsets[2], 100);
+	const RangeAllocator::Stats stats{ allocator.GetStats() };
+	TestRunner::Check(stats.nrFreeRanges == 2, "fragmentation: the free ranges with a range in between don't merge");
+	TestRunner::Check(std::abs(stats.fragmentation - 0.5f) < 0.0001f, "fragmentation: two equal free ranges give 0.5");
+
+	allocator.Free(offsets[1], 100);
+	allocator.Free(offsets[3], 100);
+	TestRunner::Check(allocator.GetStats().fragmentation == 0.0f, "fragmentation: freeing everything leaves one free range");
+}
+
+void RangeAllocatorTests::TestStress()
+{
+	// The same seed every run, so a failure can be reproduced
+	std::mt19937 random{ 1234 };
+	std::uniform_int_distribution sizeDistribution{ 1, 256 };
+
+	RangeAllocator allocator{ StressCapacity };
+	std::map<int, int> usedRanges{};
+	int nrUsed{};
+
+	bool isValid{ true };
+	for (int stepIdx{}; stepIdx < NrStressSteps && isValid; ++stepIdx)
+	{
+		// Allocate a bit more often than free, so the allocator runs full from time to time
+		if (usedRanges.empty() || random() % 5 < 3)
+		{
+			const int size{ sizeDistribution(random) };
+			const int offset{ allocator.Allocate(size) };
+			if (offset == RangeAllocator::InvalidOffset)
+			{
+				// Only fails when no free range is big enough
+				isValid = allocator.GetStats().largestFreeRange < size;
+				continue;
+			}
+
+			isValid = offset >= 0 && offset + size <= StressCapacity && !Overlaps(usedRanges, offset, size);
+			usedRanges.emplace(offset, size);
+			nrUsed += size;
+		}
+		else
+		{
+			auto it{ usedRanges.begin() };
+			std::advance(it, random() % usedRanges.size());
+			allocator.Free(it->first, it->second);
+			nrUsed -= it->second;
+			usedRanges.erase(it);
+		}
+
+		isValid = isValid && allocator.GetNrUsed() == nrUsed && allocator.GetNrAllocations() == static_cast<int>(usedRanges.size());
+	}
+	TestRunner::Check(isValid, "stress: the allocations stay inside the capacity, don't overlap and the counts match");
+
+	// Everything freed has to merge back into one range
+	for (const auto& [offset, size] : usedRanges) allocator.Free(offset, size);
+	const RangeAllocator::Stats stats{ allocator.GetStats() };
+	TestRunner::Check(allocator.IsEmpty() && stats.nrFreeRanges == 1 && stats.largestFreeRange == StressCapacity, "stress: freeing everything merges back into one range");
+}
+
+bool RangeAllocatorTests::Overlaps(const std::map<int, int>& usedRanges, int offset, int size)
+{
+	// The first range that starts after the offset, and the one before it
+	const auto nextIt{ usedRanges.upper_bound(offset) };
+	if (nextIt != usedRanges.end() && nextIt->first < offset + size) return true;
+	if (nextIt == usedRanges.begin()) return false;
+
+	const auto prevIt{ std::prev(nextIt) };
+	return prevIt->first + prevIt->second > offset;
+}
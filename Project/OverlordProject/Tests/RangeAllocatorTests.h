@@ -0,0 +1,25 @@
+#pragma once
+#include <map>
+
+class RangeAllocator;
+
+// Checks the best fit, the merging of freed ranges, running out of space and the fragmentation of the range allocator
+class RangeAllocatorTests final
+{
+public:
+	static void Run();
+
+private:
+	static constexpr int StressCapacity{ 4096 };
+	static constexpr int NrStressSteps{ 10000 };
+
+	static void TestBestFit();
+	static void TestMerge();
+	static void TestExhaustion();
+	static void TestFragmentation();
+	// Random allocations and frees, the allocated ranges may never overlap and the counts have to match
+	static void TestStress();
+
+	// The used ranges hold the size of every allocated range by its offset
+	static bool Overlaps(const std::map<int, int>& usedRanges, int offset, int size);
+};
@@ -0,0 +1,109 @@
+#include "stdafx.h"
+#include "RegionStorageBenchmark.h"
+
+#include "TestRunner.h"
+#include "Misc/World/Chunk.h"
+#include "Misc/World/RegionStorage.h"
+#include "Misc/World/WorldGenerator.h"
+
+#include <chrono>
+
+void RegionStorageBenchmark::Run()
+{
+	std::cout << "Region storage\n";
+
+	// Every run starts without saved chunks
+	const std::filesystem::path directory{ std::filesystem::temp_directory_path() / "OverlordRegionStorageBenchmark" };
+	std::error_code error{};
+	std::filesystem::remove_all(directory, error);
+
+	using Clock = std::chrono::high_resolution_clock;
+	const int nrChunks{ NrChunksPerSide * NrChunksPerSide };
+	int nrDifferentChunks{};
+	double generateTime{};
+	double saveTime{};
+	double loadTime{};
+	{
+		const WorldGenerator generator{ directory / "World" };
+		const int worldHeight{ generator.GetWorldHeight() };
+
+		// Generate the terrain the way the world thread does before a chunk is saved for the first time
+		std::vector<std::unique_ptr<Chunk>> pGeneratedChunks{ CreateChunks(worldHeight) };
+		const auto generateStart{ Clock::now() };
+		for (const std::unique_ptr<Chunk>& pChunk : pGeneratedChunks) generator.GenerateTerrain(*pChunk);
+		generateTime = std::chrono::duration<double, std::milli>{ Clock::now() - generateStart }.count();
+
+		// The chunks are saved and loaded with storages of their own, so the loads read freshly mapped region files
+		const auto saveStart{ Clock::now() };
+		{
+			RegionStorage storage{ directory / "Regions" };
+			for (const std::unique_ptr<Chunk>& pChunk : pGeneratedChunks) storage.SaveChunk(*pChunk);
+			TestRunner::Check(storage.GetNrSavedChunks() == nrChunks, "every chunk is saved");
+		}
+		saveTime = std::chrono::duration<double, std::milli>{ Clock::now() - saveStart }.count();
+
+		std::vector<std::unique_ptr<Chunk>> pLoadedChunks{ CreateChunks(worldHeight) };
+		{
+			RegionStorage storage{ directory / "Regions" };
+			const auto loadStart{ Clock::now() };
+			for (const std::unique_ptr<Chunk>& pChunk : pLoadedChunks) storage.LoadChunk(*pChunk);
+			loadTime = std::chrono::duration<double, std::milli>{ Clock::now() - loadStart }.count();
+
+			TestRunner::Check(storage.GetNrLoadedChunks() == nrChunks, "every saved chunk is loaded");
+		}
+
+		for (int chunkIdx{}; chunkIdx < nrChunks; ++chunkIdx)
+		{
+			if (!HasSameBlocks(*pGeneratedChunks[chunkIdx], *pLoadedChunks[chunkIdx], worldHeight)) ++nrDifferentChunks;
+		}
+	}
+	TestRunner::Check(nrDifferentChunks == 0, "the loaded chunks have the same blocks as the generated chunks");
+
+	// The size of the region files on disk
+	uintmax_t nrBytes{};
+	for (const auto& entry : std::filesystem::directory_iterator{ directory / "Regions", error })
+	{
+		if (entry.is_regular_file(error)) nrBytes += entry.file_size(error);
+	}
+
+	std::cout << "    generate: " << generateTime / nrChunks << " ms per chunk\n";
+	std::cout << "    save: " << saveTime / nrChunks << " ms per chunk, " << nrBytes / 1024.0 / nrChunks << " KB per chunk on disk\n";
+	std::cout << "    load: " << loadTime / nrChunks << " ms per chunk\n";
+	std::cout << "    loading is " << generateTime / loadTime << "x faster than generating\n";
+
+	std::filesystem::remove_all(directory, error);
+}
+
+std::vector<std::unique_ptr<Chunk>> RegionStorageBenchmark::CreateChunks(int worldHeight)
+{
+	// Empty chunks in a square around the origin, the square covers the corner of four region files
+	std::vector<std::unique_ptr<Chunk>> pChunks{};
+	for (int y{ -NrChunksPerSide / 2 }; y < NrChunksPerSide / 2; ++y)
+	{
+		for (int x{ -NrChunksPerSide / 2 }; x < NrChunksPerSide / 2; ++x)
+		{
+			std::unique_ptr<Chunk>& pChunk{ pChunks.emplace_back(std::make_unique<Chunk>()) };
+			pChunk->sections.resize(worldHeight / ChunkSection::Size);
+			pChunk->position = XMINT2{ x, y };
+		}
+	}
+
+	return pChunks;
+}
+
+bool RegionStorageBenchmark::HasSameBlocks(const Chunk& chunk, const Chunk& otherChunk, int worldHeight)
+{
+	for (int y{}; y < worldHeight; ++y)
+	{
+		for (int z{}; z < ChunkSection::Size; ++z)
+		{
+			for (int x{}; x < ChunkSection::Size; ++x)
+			{
+				if (chunk.GetBlock(x, y, z) != otherChunk.GetBlock(x, y, z)) return false;
+				if (chunk.GetFluid(x, y, z) != otherChunk.GetFluid(x, y, z)) return false;
+			}
+		}
+	}
+
+	return true;
+}
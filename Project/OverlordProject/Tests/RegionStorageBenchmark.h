@@ -0,0 +1,19 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+struct Chunk;
+
+// Times loading chunks from their region files against generating them from the noise
+//	and checks that every loaded chunk has the same blocks and fluids as the generated chunk
+class RegionStorageBenchmark final
+{
+public:
+	static void Run();
+
+private:
+	static constexpr int NrChunksPerSide{ 8 };
+
+	static std::vector<std::unique_ptr<Chunk>> CreateChunks(int worldHeight);
+	static bool HasSameBlocks(const Chunk& chunk, const Chunk& otherChunk, int worldHeight);
+};
@@ -0,0 +1,55 @@
+#include "stdafx.h"
+#include "TestRunner.h"
+
+#include "ChunkDrawListTests.h"
+#include "FaceMaskBenchmark.h"
+#include "FrustumCullerTests.h"
+#include "QuadMeshTests.h"
+#include "RangeAllocatorTests.h"
+#include "RegionStorageBenchmark.h"
+#include "Managers/BlockManager.h"
+
+int TestRunner::m_NrFailedChecks{};
+
+int TestRunner::Run()
+{
+	// The game has no console of its own, print to the console that started it
+	if (AttachConsole(ATTACH_PARENT_PROCESS) || AllocConsole())
+	{
+		FILE* pCout{};
+		freopen_s(&pCout, "CONOUT$", "w", stdout);
+		std::cout.clear();
+	}
+
+	// The blocks are read the same way as in the game, their sounds need the sound manager
+	Logger::Initialize();
+	SoundManager::Create(GameContext{});
+	BlockManager::Create(GameContext{});
+
+	m_NrFailedChecks = 0;
+	RangeAllocatorTests::Run();
+	QuadMeshTests::Run();
+	FrustumCullerTests::Run();
+	ChunkDrawListTests::Run();
+	FaceMaskBenchmark::Run();
+	RegionStorageBenchmark::Run();
+
+	BlockManager::Destroy();
+	SoundManager::Destroy();
+	Logger::Release();
+
+	if (m_NrFailedChecks == 0) std::cout << "All tests passed\n";
+	else std::cout << m_NrFailedChecks << " checks failed\n";
+
+	return m_NrFailedChecks;
+}
+
+bool TestRunner::Check(bool condition, const char* description)
+{
+	if (condition) return true;
+
+	std::cout << "    FAILED: " << description << '\n';
+	++m_NrFailedChecks;
+
+	return false;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// Runs the self-checking tests and benchmarks of the game without creating a window
+//	the game runs them instead of starting when it is launched with --tests
+class TestRunner final
+{
+public:
+	// Returns the number of failed checks, so the exit code of the game is 0 when every test passed
+	static int Run();
+
+	// Prints a check that failed, returns the condition so a test can stop when the rest depends on it
+	static bool Check(bool condition, const char* description);
+
+private:
+	static int m_NrFailedChecks;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <mutex>
+#include <queue>
+
+// An unbounded queue that any number of threads can push finished work to, one consumer thread collects it
+// The lock is only held to move one item in or out, so a producer never waits for the consumer to handle a result
+template<typename T>
+class CompletionQueue final
+{
+public:
+	CompletionQueue() = default;
+	~CompletionQueue() = default;
+
+	CompletionQueue(const CompletionQueue& other) = delete;
+	CompletionQueue(CompletionQueue&& other) noexcept = delete;
+	CompletionQueue& operator=(const CompletionQueue& other) = delete;
+	CompletionQueue& operator=(CompletionQueue&& other) noexcept = delete;
+
+	// Can be called from any thread
+	void Push(T&& item)
+	{
+		const std::lock_guard lock{ m_Mutex };
+		m_Items.push(std::move(item));
+	}
+
+	// Only call this from the consumer thread, fails when there are no results
+	bool Pop(T& item)
+	{
+		const std::lock_guard lock{ m_Mutex };
+		if (m_Items.empty()) return false;
+
+		item = std::move(m_Items.front());
+		m_Items.pop();
+
+		return true;
+	}
+
+private:
+	std::mutex m_Mutex{};
+	std::queue<T> m_Items{};
+};
@@ -0,0 +1,138 @@
+#include "stdafx.h"
+#include "FrustumCuller.h"
+
+void FrustumCuller::Begin(const XMFLOAT4X4& viewProjection)
+{
+	GetFrustumPlanes(viewProjection, m_Planes.data());
+	m_NrPlanes = NrFrustumPlanes;
+
+	m_NrBoxes = 0;
+	m_CenterX.clear();
+	m_CenterY.clear();
+	m_CenterZ.clear();
+	m_ExtentX.clear();
+	m_ExtentY.clear();
+	m_ExtentZ.clear();
+}
+
+void FrustumCuller::AddSweptFrustum(const XMFLOAT4X4& viewProjection, const XMFLOAT3& direction)
+{
+	XMFLOAT4 planes[NrFrustumPlanes]{};
+	GetFrustumPlanes(viewProjection, planes);
+
+	for (const XMFLOAT4& plane : planes)
+	{
+		// A second swept frustum could fill up the planes, leaving a plane out only keeps more boxes visible
+		if (m_NrPlanes == MaxNrPlanes) break;
+
+		// Moving along the direction goes into the frustum, so a box behind this plane could still end up inside
+		if (plane.x * direction.x + plane.y * direction.y + plane.z * direction.z > 0.0f) continue;
+
+		m_Planes[m_NrPlanes++] = plane;
+	}
+}
+
+void FrustumCuller::GetFrustumPlanes(const XMFLOAT4X4& viewProjection, XMFLOAT4* pPlanes)
+{
+	// A point is inside the clip volume when -w <= x <= w, -w <= y <= w and 0 <= z <= w
+	//	with row vectors every clip coordinate is the dot product of the point with a column of the matrix
+	const auto getColumn{ [&viewProjection](int columnIdx)
+		{
+			return XMVectorSet(viewProjection.m[0][columnIdx], viewProjection.m[1][columnIdx], viewProjection.m[2][columnIdx], viewProjection.m[3][columnIdx]);
+		} };
+	const XMVECTOR x{ getColumn(0) };
+	const XMVECTOR y{ getColumn(1) };
+	const XMVECTOR z{ getColumn(2) };
+	const XMVECTOR w{ getColumn(3) };
+
+	const XMVECTOR planes[NrFrustumPlanes]{ w + x, w - x, w + y, w - y, z, w - z };
+	for (int planeIdx{}; planeIdx < NrFrustumPlanes; ++planeIdx)
+	{
+		// Normalized so the distance to a plane is in world units
+		XMStoreFloat4(&pPlanes[planeIdx], XMPlaneNormalize(planes[planeIdx]));
+	}
+}
+
+int FrustumCuller::AddBox(const BoundingBox& box)
+{
+	m_CenterX.push_back(box.Center.x);
+	m_CenterY.push_back(box.Center.y);
+	m_CenterZ.push_back(box.Center.z);
+	m_ExtentX.push_back(box.Extents.x);
+	m_ExtentY.push_back(box.Extents.y);
+	m_ExtentZ.push_back(box.Extents.z);
+
+	return m_NrBoxes++;
+}
+
+bool FrustumCuller::IsBoxVisible(const BoundingBox& box) const
+{
+	// The same test as Cull, without the batches of four
+	for (int planeIdx{}; planeIdx < m_NrPlanes; ++planeIdx)
+	{
+		const XMFLOAT4& plane{ m_Planes[planeIdx] };
+		const float distance{ plane.x * box.Center.x + plane.y * box.Center.y + plane.z * box.Center.z + plane.w };
+		const float reach{ box.Extents.x * fabsf(plane.x) + box.Extents.y * fabsf(plane.y) + box.Extents.z * fabsf(plane.z) };
+		if (distance + reach < 0.0f) return false;
+	}
+
+	return true;
+}
+
+void FrustumCuller::Cull()
+{
+	// Fill the last group of four with empty boxes, their results are never read
+	const int nrTestedBoxes{ (m_NrBoxes + NrBoxesPerTest - 1) / NrBoxesPerTest * NrBoxesPerTest };
+	for (std::vector<float>* pComponent : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ })
+	{
+		pComponent->resize(nrTestedBoxes);
+	}
+	m_IsVisible.resize(nrTestedBoxes);
+
+	// Every lane of a plane vector holds the same plane, the absolute normal scales the extents to the reach of the box towards the plane
+	XMVECTOR planeX[MaxNrPlanes]{}, planeY[MaxNrPlanes]{}, planeZ[MaxNrPlanes]{}, planeW[MaxNrPlanes]{};
+	XMVECTOR absPlaneX[MaxNrPlanes]{}, absPlaneY[MaxNrPlanes]{}, absPlaneZ[MaxNrPlanes]{};
+	for (int planeIdx{}; planeIdx < m_NrPlanes; ++planeIdx)
+	{
+		const XMFLOAT4& plane{ m_Planes[planeIdx] };
+		planeX[planeIdx] = XMVectorReplicate(plane.x);
+		planeY[planeIdx] = XMVectorReplicate(plane.y);
+		planeZ[planeIdx] = XMVectorReplicate(plane.z);
+		planeW[planeIdx] = XMVectorReplicate(plane.w);
+		absPlaneX[planeIdx] = XMVectorReplicate(fabsf(plane.x));
+		absPlaneY[planeIdx] = XMVectorReplicate(fabsf(plane.y));
+		absPlaneZ[planeIdx] = XMVectorReplicate(fabsf(plane.z));
+	}
+
+	for (int boxIdx{}; boxIdx < nrTestedBoxes; boxIdx += NrBoxesPerTest)
+	{
+		const XMVECTOR centerX{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_CenterX[boxIdx])) };
+		const XMVECTOR centerY{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_CenterY[boxIdx])) };
+		const XMVECTOR centerZ{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_CenterZ[boxIdx])) };
+		const XMVECTOR extentX{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_ExtentX[boxIdx])) };
+		const XMVECTOR extentY{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_ExtentY[boxIdx])) };
+		const XMVECTOR extentZ{ XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_ExtentZ[boxIdx])) };
+
+		// A box is outside when its center is further behind a plane than the box reaches towards it
+		XMVECTOR isOutside{ XMVectorFalseInt() };
+		for (int planeIdx{}; planeIdx < m_NrPlanes; ++planeIdx)
+		{
+			XMVECTOR distance{ XMVectorMultiplyAdd(centerX, planeX[planeIdx], planeW[planeIdx]) };
+			distance = XMVectorMultiplyAdd(centerY, planeY[planeIdx], distance);
+			distance = XMVectorMultiplyAdd(centerZ, planeZ[planeIdx], distance);
+
+			XMVECTOR reach{ XMVectorMultiply(extentX, absPlaneX[planeIdx]) };
+			reach = XMVectorMultiplyAdd(extentY, absPlaneY[planeIdx], reach);
+			reach = XMVectorMultiplyAdd(extentZ, absPlaneZ[planeIdx], reach);
+
+			isOutside = XMVectorOrInt(isOutside, XMVectorLess(XMVectorAdd(distance, reach), XMVectorZero()));
+		}
+
+		XMUINT4 outsideMask{};
+		XMStoreUInt4(&outsideMask, isOutside);
+		m_IsVisible[boxIdx] = outsideMask.x == 0;
+		m_IsVisible[boxIdx + 1] = outsideMask.y == 0;
+		m_IsVisible[boxIdx + 2] = outsideMask.z == 0;
+		m_IsVisible[boxIdx + 3] = outsideMask.w == 0;
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+
+// Tests axis aligned boxes against the planes of a view projection, four boxes at a time
+// Only depends on DirectXMath, so it doesn't need a device or a scene
+class FrustumCuller final
+{
+public:
+	static constexpr int NrFrustumPlanes{ 6 };
+	static constexpr int MaxNrPlanes{ NrFrustumPlanes * 2 };
+	static constexpr int NrBoxesPerTest{ 4 };
+
+	FrustumCuller() = default;
+	~FrustumCuller() = default;
+
+	FrustumCuller(const FrustumCuller& other) = delete;
+	FrustumCuller(FrustumCuller&& other) noexcept = delete;
+	FrustumCuller& operator=(const FrustumCuller& other) = delete;
+	FrustumCuller& operator=(FrustumCuller&& other) noexcept = delete;
+
+	// Takes the planes from a row vector view projection with a depth range of 0 to 1, and removes the boxes of the previous test
+	void Begin(const DirectX::XMFLOAT4X4& viewProjection);
+	// Also culls the boxes that can't reach the frustum of the view projection when they are moved along the direction
+	//	only the planes that the direction moves away from are added, a box behind a plane that the direction moves towards could still reach it
+	//	the planes that don't fit in MaxNrPlanes anymore are left out
+	void AddSweptFrustum(const DirectX::XMFLOAT4X4& viewProjection, const DirectX::XMFLOAT3& direction);
+	// Returns the index of the box, its result is read with IsVisible after Cull
+	int AddBox(const DirectX::BoundingBox& box);
+	void Cull();
+
+	// A box is only culled when it is completely behind one of the planes, so boxes near a corner of the frustum can still be visible
+	bool IsVisible(int boxIdx) const { return m_IsVisible[boxIdx]; }
+	// Tests one box against the planes right away, for the few boxes that aren't known before the test
+	bool IsBoxVisible(const DirectX::BoundingBox& box) const;
+	int GetNrBoxes() const { return m_NrBoxes; }
+
+	// The planes point into the frustum, a point is inside when it is in front of every plane
+	const DirectX::XMFLOAT4* GetPlanes() const { return m_Planes.data(); }
+	int GetNrPlanes() const { return m_NrPlanes; }
+
+	// The normalized planes of a view projection, in the order left, right, bottom, top, near, far
+	static void GetFrustumPlanes(const DirectX::XMFLOAT4X4& viewProjection, DirectX::XMFLOAT4* pPlanes);
+
+private:
+	std::array<DirectX::XMFLOAT4, MaxNrPlanes> m_Planes{};
+	int m_NrPlanes{};
+
+	// The boxes are stored per component, so one vector holds the same component of four boxes
+	std::vector<float> m_CenterX{};
+	std::vector<float> m_CenterY{};
+	std::vector<float> m_CenterZ{};
+	std::vector<float> m_ExtentX{};
+	std::vector<float> m_ExtentY{};
+	std::vector<float> m_ExtentZ{};
+	int m_NrBoxes{};
+
+	std::vector<uint8_t> m_IsVisible{};
+};
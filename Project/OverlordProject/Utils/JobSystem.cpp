@@ -0,0 +1,133 @@
+#include "stdafx.h"
+#include "JobSystem.h"
+
+thread_local int JobSystem::m_WorkerIdx{ -1 };
+
+JobSystem::JobSystem(int nrWorkers)
+{
+	// Keep a core free for the main thread and for the thread that submits the jobs
+	if (nrWorkers <= 0) nrWorkers = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 2, 1);
+
+	// Create all queues before any worker can try to steal from them
+	m_pQueues.reserve(nrWorkers);
+	for (int workerIdx{}; workerIdx < nrWorkers; ++workerIdx) m_pQueues.emplace_back(std::make_unique<WorkerQueue>());
+
+	m_Workers.reserve(nrWorkers);
+	for (int workerIdx{}; workerIdx < nrWorkers; ++workerIdx) m_Workers.emplace_back([this, workerIdx]() { RunWorker(workerIdx); });
+}
+
+JobSystem::~JobSystem()
+{
+	// Wake every worker so it sees that the pool stops, jobs that are still queued are dropped
+	{
+		const std::lock_guard lock{ m_WakeMutex };
+		m_IsRunning = false;
+	}
+	m_WakeCondition.notify_all();
+
+	for (std::thread& worker : m_Workers) worker.join();
+}
+
+void JobSystem::Submit(Job job, Batch* pBatch)
+{
+	if (pBatch) ++pBatch->nrJobs;
+
+	// Workers keep their own jobs close, other threads spread them over every queue
+	const int queueIdx{ m_WorkerIdx >= 0 ? m_WorkerIdx : static_cast<int>(m_NextQueueIdx++ % m_pQueues.size()) };
+	{
+		WorkerQueue& queue{ *m_pQueues[queueIdx] };
+		const std::lock_guard lock{ queue.mutex };
+		queue.jobs.emplace_back(std::move(job), pBatch);
+	}
+
+	{
+		const std::lock_guard lock{ m_WakeMutex };
+		++m_NrQueuedJobs;
+	}
+	m_WakeCondition.notify_one();
+}
+
+void JobSystem::Wait(const Batch& batch)
+{
+	// Help with the queued jobs of the batch instead of sleeping, the jobs of the batch might still be waiting in a queue
+	std::pair<Job, Batch*> job{};
+	while (batch.nrJobs > 0)
+	{
+		if (TryTakeJob(m_WorkerIdx, &batch, job)) RunJob(job);
+		else std::this_thread::yield();
+	}
+}
+
+void JobSystem::RunWorker(int workerIdx)
+{
+	m_WorkerIdx = workerIdx;
+
+	std::pair<Job, Batch*> job{};
+	while (m_IsRunning)
+	{
+		if (TryTakeJob(workerIdx, nullptr, job))
+		{
+			RunJob(job);
+			continue;
+		}
+
+		// Sleep until a new job is queued
+		std::unique_lock lock{ m_WakeMutex };
+		m_WakeCondition.wait(lock, [this]() { return m_NrQueuedJobs > 0 || !m_IsRunning; });
+	}
+}
+
+bool JobSystem::TryTakeJob(int workerIdx, const Batch* pBatch, std::pair<Job, Batch*>& job)
+{
+	const int nrQueues{ static_cast<int>(m_pQueues.size()) };
+
+	const auto isInBatch{ [pBatch](const std::pair<Job, Batch*>& queuedJob) { return !pBatch || queuedJob.second == pBatch; } };
+
+	// The newest job of its own queue still has its data in the cache of this core
+	if (workerIdx >= 0)
+	{
+		WorkerQueue& queue{ *m_pQueues[workerIdx] };
+		const std::lock_guard lock{ queue.mutex };
+
+		const auto jobIt{ std::find_if(queue.jobs.rbegin(), queue.jobs.rend(), isInBatch) };
+		if (jobIt != queue.jobs.rend())
+		{
+			job = std::move(*jobIt);
+			queue.jobs.erase(std::next(jobIt).base());
+			--m_NrQueuedJobs;
+
+			return true;
+		}
+	}
+
+	// Steal the oldest job of another queue, starting at the next worker so not every thief tries the same queue
+	for (int offset{ 1 }; offset <= nrQueues; ++offset)
+	{
+		const int queueIdx{ (std::max(workerIdx, 0) + offset) % nrQueues };
+		if (queueIdx == workerIdx) continue;
+
+		WorkerQueue& queue{ *m_pQueues[queueIdx] };
+		const std::lock_guard lock{ queue.mutex };
+
+		const auto jobIt{ std::find_if(queue.jobs.begin(), queue.jobs.end(), isInBatch) };
+		if (jobIt == queue.jobs.end()) continue;
+
+		job = std::move(*jobIt);
+		queue.jobs.erase(jobIt);
+		--m_NrQueuedJobs;
+
+		return true;
+	}
+
+	return false;
+}
+
+void JobSystem::RunJob(std::pair<Job, Batch*>& job)
+{
+	job.first();
+
+	// Let the waiting thread know once the last job of its batch has finished
+	if (job.second) --job.second->nrJobs;
+
+	job.first = nullptr;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A pool of worker threads that run small jobs
+// Every worker has its own queue, it runs the newest job of its own queue first and steals the oldest job of another queue when its own is empty
+class JobSystem final
+{
+public:
+	using Job = std::function<void()>;
+
+	// Counts the jobs of one batch that haven't finished yet, so a thread can wait for only these jobs
+	struct Batch
+	{
+		std::atomic<int> nrJobs{};
+	};
+
+	// Zero workers uses every core except the ones of the main thread and the thread that submits the jobs
+	explicit JobSystem(int nrWorkers = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem& other) = delete;
+	JobSystem(JobSystem&& other) noexcept = delete;
+	JobSystem& operator=(const JobSystem& other) = delete;
+	JobSystem& operator=(JobSystem&& other) noexcept = delete;
+
+	// Can be called from any thread, a job that is submitted from a worker goes to the queue of that worker
+	void Submit(Job job, Batch* pBatch = nullptr);
+	// Runs queued jobs of the batch on the calling thread until every job of the batch has finished
+	//	jobs of other batches are left to the workers, so the wait never runs longer than the batch itself
+	void Wait(const Batch& batch);
+
+	int GetNrWorkers() const { return static_cast<int>(m_Workers.size()); }
+	// The index of the worker that is running the calling thread, -1 for threads outside the pool
+	static int GetWorkerIdx() { return m_WorkerIdx; }
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex mutex{};
+		std::deque<std::pair<Job, Batch*>> jobs{};
+	};
+
+	void RunWorker(int workerIdx);
+	// Takes the newest job of its own queue, or the oldest job of any other queue
+	//	with a batch, only the jobs of that batch are taken
+	bool TryTakeJob(int workerIdx, const Batch* pBatch, std::pair<Job, Batch*>& job);
+	void RunJob(std::pair<Job, Batch*>& job);
+
+	std::vector<std::unique_ptr<WorkerQueue>> m_pQueues{};
+	std::vector<std::thread> m_Workers{};
+
+	// Sleeping workers are woken when a job is queued, the count is changed under the mutex so no wake up gets lost
+	std::mutex m_WakeMutex{};
+	std::condition_variable m_WakeCondition{};
+	std::atomic<int> m_NrQueuedJobs{};
+	std::atomic<bool> m_IsRunning{ true };
+
+	// Threads outside the pool spread their jobs over the queues
+	std::atomic<unsigned int> m_NextQueueIdx{};
+
+	static thread_local int m_WorkerIdx;
+};
@@ -0,0 +1,77 @@
+#include "stdafx.h"
+#include "RangeAllocator.h"
+
+RangeAllocator::RangeAllocator(int capacity)
+	: m_Capacity{ capacity }
+{
+	if (capacity > 0) m_FreeRanges.emplace(0, capacity);
+}
+
+int RangeAllocator::Allocate(int size)
+{
+	if (size <= 0) return InvalidOffset;
+
+	// Find the smallest free range that fits
+	auto bestIt{ m_FreeRanges.end() };
+	for (auto it{ m_FreeRanges.begin() }; it != m_FreeRanges.end(); ++it)
+	{
+		if (it->second < size) continue;
+		if (bestIt != m_FreeRanges.end() && it->second >= bestIt->second) continue;
+
+		bestIt = it;
+		if (it->second == size) break;
+	}
+
+	if (bestIt == m_FreeRanges.end()) return InvalidOffset;
+
+	// The allocation takes the front of the free range, the rest stays free
+	const int offset{ bestIt->first };
+	const int remainingSize{ bestIt->second - size };
+	m_FreeRanges.erase(bestIt);
+	if (remainingSize > 0) m_FreeRanges.emplace(offset + size, remainingSize);
+
+	m_NrUsed += size;
+	++m_NrAllocations;
+
+	return offset;
+}
+
+void RangeAllocator::Free(int offset, int size)
+{
+	if (offset == InvalidOffset || size <= 0) return;
+
+	m_NrUsed -= size;
+	--m_NrAllocations;
+
+	// Merge with the free range right after it
+	auto nextIt{ m_FreeRanges.lower_bound(offset) };
+	if (nextIt != m_FreeRanges.end() && nextIt->first == offset + size)
+	{
+		size += nextIt->second;
+		nextIt = m_FreeRanges.erase(nextIt);
+	}
+
+	// Merge with the free range right before it
+	if (nextIt != m_FreeRanges.begin())
+	{
+		const auto prevIt{ std::prev(nextIt) };
+		if (prevIt->first + prevIt->second == offset)
+		{
+			prevIt->second += size;
+			return;
+		}
+	}
+
+	m_FreeRanges.emplace_hint(nextIt, offset, size);
+}
+
+RangeAllocator::Stats RangeAllocator::GetStats() const
+{
+	Stats stats{ m_Capacity, m_NrUsed, m_NrAllocations, static_cast<int>(m_FreeRanges.size()) };
+	for (const auto& [offset, size] : m_FreeRanges) stats.largestFreeRange = std::max(stats.largestFreeRange, size);
+
+	const int nrFree{ GetNrFree() };
+	if (nrFree > 0) stats.fragmentation = 1.0f - static_cast<float>(stats.largestFreeRange) / nrFree;
+
+	return stats;
+}
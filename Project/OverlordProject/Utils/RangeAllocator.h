@@ -0,0 +1,50 @@
+#pragma once
+#include <map>
+
+// Hands out ranges of a space with a fixed size, the free ranges are kept in a list sorted by offset
+//	a freed range is merged with the free ranges next to it, so the free list only splits where ranges are in use
+// Doesn't know what the space holds, the owner maps the offsets onto its own storage
+class RangeAllocator final
+{
+public:
+	struct Stats
+	{
+		int capacity{};
+		int nrUsed{};
+		int nrAllocations{};
+		int nrFreeRanges{};
+		int largestFreeRange{};
+		// 0 when all free space is one range, close to 1 when it is split in many small ranges
+		float fragmentation{};
+	};
+
+	static constexpr int InvalidOffset{ -1 };
+
+	explicit RangeAllocator(int capacity);
+	~RangeAllocator() = default;
+
+	RangeAllocator(const RangeAllocator& other) = delete;
+	RangeAllocator(RangeAllocator&& other) noexcept = delete;
+	RangeAllocator& operator=(const RangeAllocator& other) = delete;
+	RangeAllocator& operator=(RangeAllocator&& other) noexcept = delete;
+
+	// Takes the smallest free range that fits, so big free ranges stay available for big requests
+	//	returns InvalidOffset when no free range is big enough
+	int Allocate(int size);
+	// The range has to be the same as it was allocated
+	void Free(int offset, int size);
+
+	int GetCapacity() const { return m_Capacity; }
+	int GetNrUsed() const { return m_NrUsed; }
+	int GetNrFree() const { return m_Capacity - m_NrUsed; }
+	int GetNrAllocations() const { return m_NrAllocations; }
+	bool IsEmpty() const { return m_NrAllocations == 0; }
+	Stats GetStats() const;
+
+private:
+	// The size of every free range by its offset
+	std::map<int, int> m_FreeRanges{};
+	int m_Capacity{};
+	int m_NrUsed{};
+	int m_NrAllocations{};
+};
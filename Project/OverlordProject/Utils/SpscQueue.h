@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+// A bounded queue between one producer thread and one consumer thread that never locks
+// Push fails when the queue is full and Pop fails when it is empty, so neither thread ever waits for the other
+template<typename T>
+class SpscQueue final
+{
+public:
+	explicit SpscQueue(size_t capacity) : m_Items(capacity + 1) {}
+	~SpscQueue() = default;
+
+	SpscQueue(const SpscQueue& other) = delete;
+	SpscQueue(SpscQueue&& other) noexcept = delete;
+	SpscQueue& operator=(const SpscQueue& other) = delete;
+	SpscQueue& operator=(SpscQueue&& other) noexcept = delete;
+
+	// Only call this from the producer thread
+	bool Push(const T& item)
+	{
+		const size_t tail{ m_Tail.load(std::memory_order_relaxed) };
+		const size_t nextTail{ GetNextIdx(tail) };
+
+		// If the next slot is still being read, the queue is full
+		if (nextTail == m_Head.load(std::memory_order_acquire)) return false;
+
+		// Store the item before the consumer is allowed to see it
+		m_Items[tail] = item;
+		m_Tail.store(nextTail, std::memory_order_release);
+
+		return true;
+	}
+
+	// Only call this from the consumer thread
+	bool Pop(T& item)
+	{
+		const size_t head{ m_Head.load(std::memory_order_relaxed) };
+
+		// If the consumer caught up with the producer, the queue is empty
+		if (head == m_Tail.load(std::memory_order_acquire)) return false;
+
+		// Read the item before the producer is allowed to overwrite it
+		item = m_Items[head];
+		m_Head.store(GetNextIdx(head), std::memory_order_release);
+
+		return true;
+	}
+
+private:
+	size_t GetNextIdx(size_t idx) const { return idx + 1 == m_Items.size() ? 0 : idx + 1; }
+
+	// One slot always stays empty to tell a full queue apart from an empty queue
+	std::vector<T> m_Items{};
+
+	// The indices are written by different threads, so they are kept on separate cache lines
+	alignas(64) std::atomic<size_t> m_Head{};
+	alignas(64) std::atomic<size_t> m_Tail{};
+};